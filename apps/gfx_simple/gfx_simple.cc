@@ -108,7 +108,7 @@ int main(void)
     logger::info("INDEX MEM: {}", index_mem.size);
 
     auto buffer_handle = gfx->create_vertex_buffer(&positions_mem, v_layout);
-    gfx->attach_vertex_buffer(buffer_handle);
+    gfx->attach_vertex_buffer(frame, buffer_handle);
 
     logger::info("Creating index buffer");
     auto index_handle = gfx->create_index_buffer(&index_mem);
@@ -132,12 +132,13 @@ int main(void)
     logger::debug("Vert size: {}", vert_code.size());
     logger::debug("Frag size: {}", frag_code.size());
 
-    auto vert_handle = gfx->create_shader(vert_code);
-    auto frag_handle = gfx->create_shader(frag_code);
+    // The file contents are handed over as they are, without another copy
+    auto vert_handle = gfx->create_shader(blade::core::memory::take(std::move(vert_code)));
+    auto frag_handle = gfx->create_shader(blade::core::memory::take(std::move(frag_code)));
 
     auto program = gfx->create_view_program(frame, vert_handle, frag_handle);
 
-    if (program.index != blade::gfx::BLADE_NULL_HANDLE)
+    if (program.id != blade::gfx::BLADE_NULL_HANDLE)
     {
         logger::debug("Valid program handle created");
     }
@@ -151,9 +152,9 @@ int main(void)
     {
         gfx->set_viewport(frame, 0, 0, blade::width{window->get_width()}, blade::height{window->get_height()});
 
-        gfx->set_vertex_buffer(buffer_handle);
+        gfx->set_vertex_buffer(frame, buffer_handle);
 
-        gfx->set_index_buffer(index_handle);
+        gfx->set_index_buffer(frame, index_handle);
 
         gfx->present();
 
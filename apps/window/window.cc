@@ -16,7 +16,7 @@ int main(void)
 
     auto window = std::move(window_opt.value());
 
-    events::subscribe<events::window_resize<blade::window>>([](const events::window_resize<blade::window>& e)
+    const events::subscription on_resize = events::subscribe<events::window_resize<blade::window>>([](const events::window_resize<blade::window>& e)
     {
         logger::trace("Window '{}' resized ({}, {})", e.window.get_title(), e.width, e.height);
         return true;
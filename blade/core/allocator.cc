@@ -0,0 +1,133 @@
+#include "core/allocator.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <new>
+
+namespace blade
+{
+    namespace core
+    {
+        namespace
+        {
+            struct tag_counters
+            {
+                std::atomic<usize> live_bytes { 0 };
+                std::atomic<usize> peak_bytes { 0 };
+                std::atomic<usize> count { 0 };
+                std::atomic<u64> total { 0 };
+            };
+
+            std::array<tag_counters, static_cast<usize>(memory_tag::count)> counters {};
+
+            /// @brief Stored in front of every heap allocation so `deallocate` can find the size, tag and block start
+            struct heap_header
+            {
+                usize size { 0 };
+                u32 alignment { 0 };
+                memory_tag tag { memory_tag::general };
+            };
+            static_assert(sizeof(heap_header) <= alignof(std::max_align_t));
+
+            class heap_allocator final : public allocator
+            {
+                public:
+                    void* allocate(usize size, usize alignment, memory_tag tag) noexcept override
+                    {
+                        // The header sits in a prefix of one alignment unit right before the returned pointer
+                        alignment = std::max(alignment, alignof(std::max_align_t));
+                        auto* base = static_cast<std::byte*>(::operator new(alignment + size, std::align_val_t{ alignment }, std::nothrow));
+                        if (base == nullptr)
+                        {
+                            return nullptr;
+                        }
+
+                        std::byte* memory = base + alignment;
+                        *header_of_(memory) = heap_header{
+                            .size = size,
+                            .alignment = static_cast<u32>(alignment),
+                            .tag = tag,
+                        };
+
+                        track_allocate(tag, size);
+                        return memory;
+                    }
+
+                    void deallocate(void* memory) noexcept override
+                    {
+                        if (memory == nullptr)
+                        {
+                            return;
+                        }
+
+                        const heap_header header = *header_of_(memory);
+                        track_free(header.tag, header.size);
+                        ::operator delete(static_cast<std::byte*>(memory) - header.alignment, std::align_val_t{ header.alignment });
+                    }
+
+                private:
+                    static heap_header* header_of_(void* memory) noexcept
+                    {
+                        return reinterpret_cast<heap_header*>(static_cast<std::byte*>(memory) - sizeof(heap_header));
+                    }
+            };
+        } // anonymous namespace
+
+        const char* memory_tag_name(memory_tag tag) noexcept
+        {
+            switch (tag)
+            {
+                case memory_tag::general:    return "general";
+                case memory_tag::gfx:        return "gfx";
+                case memory_tag::driver:     return "driver";
+                case memory_tag::resources:  return "resources";
+                case memory_tag::events:     return "events";
+                case memory_tag::logger:     return "logger";
+                case memory_tag::containers: return "containers";
+                case memory_tag::frame:      return "frame";
+                case memory_tag::fibers:     return "fibers";
+                case memory_tag::count:      break;
+            }
+
+            return "unknown";
+        }
+
+        memory_stats query_memory(memory_tag tag) noexcept
+        {
+            const auto& tag_counters = counters[static_cast<usize>(tag)];
+            return memory_stats{
+                .live_bytes = tag_counters.live_bytes.load(std::memory_order_relaxed),
+                .peak_bytes = tag_counters.peak_bytes.load(std::memory_order_relaxed),
+                .count = tag_counters.count.load(std::memory_order_relaxed),
+                .total = tag_counters.total.load(std::memory_order_relaxed),
+            };
+        }
+
+        allocator& allocator::heap() noexcept
+        {
+            static heap_allocator instance{};
+            return instance;
+        }
+
+        void allocator::track_allocate(memory_tag tag, usize size) noexcept
+        {
+            auto& tag_counters = counters[static_cast<usize>(tag)];
+            tag_counters.count.fetch_add(1, std::memory_order_relaxed);
+            tag_counters.total.fetch_add(1, std::memory_order_relaxed);
+            const usize live = tag_counters.live_bytes.fetch_add(size, std::memory_order_relaxed) + size;
+
+            usize peak = tag_counters.peak_bytes.load(std::memory_order_relaxed);
+            while (live > peak && !tag_counters.peak_bytes.compare_exchange_weak(peak, live, std::memory_order_relaxed))
+            {
+            }
+        }
+
+        void allocator::track_free(memory_tag tag, usize size) noexcept
+        {
+            auto& tag_counters = counters[static_cast<usize>(tag)];
+            tag_counters.count.fetch_sub(1, std::memory_order_relaxed);
+            tag_counters.live_bytes.fetch_sub(size, std::memory_order_relaxed);
+        }
+    } // core namespace
+} // blade namespace
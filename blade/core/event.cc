@@ -0,0 +1,32 @@
+#include "core/event.h"
+
+namespace blade
+{
+    namespace events
+    {
+        namespace
+        {
+            /// @brief Every queue an event has been posted to, newest first
+            std::atomic<detail::queue_base*> registered_queues { nullptr };
+        } // anonymous namespace
+
+        namespace detail
+        {
+            void queue_base::register_() noexcept
+            {
+                next = registered_queues.load(std::memory_order_relaxed);
+                while (!registered_queues.compare_exchange_weak(next, this, std::memory_order_release, std::memory_order_relaxed))
+                {
+                }
+            }
+        } // detail namespace
+
+        void flush() noexcept
+        {
+            for (detail::queue_base* queue = registered_queues.load(std::memory_order_acquire); queue != nullptr; queue = queue->next)
+            {
+                queue->flush();
+            }
+        }
+    } // events namespace
+} // blade namespace
@@ -0,0 +1,602 @@
+#include "core/fibers.h"
+#include "core/defines.h"
+#include "core/logger.h"
+
+#include <cstdint>
+#include <cstring>
+#include <thread>
+
+#if defined(BLADE_PLATFORM_WINDOWS)
+    #include <windows.h>
+#else
+    #if defined(__SANITIZE_ADDRESS__)
+        #define BLADE_FIBERS_ASAN 1
+    #endif
+    #if defined(__SANITIZE_THREAD__)
+        #define BLADE_FIBERS_TSAN 1
+    #endif
+    #if defined(__has_feature)
+        #if __has_feature(address_sanitizer)
+            #define BLADE_FIBERS_ASAN 1
+        #endif
+        #if __has_feature(thread_sanitizer)
+            #define BLADE_FIBERS_TSAN 1
+        #endif
+    #endif
+
+    #if defined(BLADE_FIBERS_ASAN)
+        #include <sanitizer/common_interface_defs.h>
+    #endif
+    #if defined(BLADE_FIBERS_TSAN)
+        #include <sanitizer/tsan_interface.h>
+    #endif
+
+    #if !defined(__x86_64__) && !defined(__aarch64__)
+        #error "Fibers need an x86-64 or AArch64 context switch for this platform"
+    #endif
+#endif
+
+#if defined(_MSC_VER)
+    #define BLADE_FIBERS_NOINLINE __declspec(noinline)
+#else
+    #define BLADE_FIBERS_NOINLINE __attribute__((noinline))
+#endif
+
+#if !defined(BLADE_PLATFORM_WINDOWS)
+
+#if defined(__APPLE__)
+    #define BLADE_FIBERS_SYMBOL(name) "_" #name
+#else
+    #define BLADE_FIBERS_SYMBOL(name) #name
+#endif
+
+/**
+ * Saves the callee-saved registers on the current stack, stores the stack pointer in `*from` and restores the
+ * registers saved on the stack `to` points at. Everything else is already spilled by the caller per the ABI.
+ */
+extern "C" void blade_fiber_switch(void** from, void* to) noexcept;
+
+/// Where a new fiber first switches to: calls the entry function from its saved registers with the fiber
+extern "C" void blade_fiber_start() noexcept;
+
+#if defined(__x86_64__)
+// System V: rbx, rbp and r12-r15, plus the SSE and x87 control words
+asm(
+    ".text\n"
+    ".globl " BLADE_FIBERS_SYMBOL(blade_fiber_switch) "\n"
+    ".p2align 4\n"
+    BLADE_FIBERS_SYMBOL(blade_fiber_switch) ":\n"
+    "    pushq %rbp\n"
+    "    pushq %rbx\n"
+    "    pushq %r12\n"
+    "    pushq %r13\n"
+    "    pushq %r14\n"
+    "    pushq %r15\n"
+    "    subq $8, %rsp\n"
+    "    stmxcsr (%rsp)\n"
+    "    fnstcw 4(%rsp)\n"
+    "    movq %rsp, (%rdi)\n"
+    "    movq %rsi, %rsp\n"
+    "    ldmxcsr (%rsp)\n"
+    "    fldcw 4(%rsp)\n"
+    "    addq $8, %rsp\n"
+    "    popq %r15\n"
+    "    popq %r14\n"
+    "    popq %r13\n"
+    "    popq %r12\n"
+    "    popq %rbx\n"
+    "    popq %rbp\n"
+    "    ret\n"
+    ".globl " BLADE_FIBERS_SYMBOL(blade_fiber_start) "\n"
+    ".p2align 4\n"
+    BLADE_FIBERS_SYMBOL(blade_fiber_start) ":\n"
+    "    movq %r12, %rdi\n"
+    "    callq *%r13\n"
+    "    ud2\n"
+);
+#elif defined(__aarch64__)
+// AAPCS64: x19-x28, the frame pointer, the link register and the low halves of v8-v15
+asm(
+    ".text\n"
+    ".globl " BLADE_FIBERS_SYMBOL(blade_fiber_switch) "\n"
+    ".p2align 4\n"
+    BLADE_FIBERS_SYMBOL(blade_fiber_switch) ":\n"
+    "    sub sp, sp, #160\n"
+    "    stp x19, x20, [sp, #0]\n"
+    "    stp x21, x22, [sp, #16]\n"
+    "    stp x23, x24, [sp, #32]\n"
+    "    stp x25, x26, [sp, #48]\n"
+    "    stp x27, x28, [sp, #64]\n"
+    "    stp x29, x30, [sp, #80]\n"
+    "    stp d8, d9, [sp, #96]\n"
+    "    stp d10, d11, [sp, #112]\n"
+    "    stp d12, d13, [sp, #128]\n"
+    "    stp d14, d15, [sp, #144]\n"
+    "    mov x9, sp\n"
+    "    str x9, [x0]\n"
+    "    mov sp, x1\n"
+    "    ldp x19, x20, [sp, #0]\n"
+    "    ldp x21, x22, [sp, #16]\n"
+    "    ldp x23, x24, [sp, #32]\n"
+    "    ldp x25, x26, [sp, #48]\n"
+    "    ldp x27, x28, [sp, #64]\n"
+    "    ldp x29, x30, [sp, #80]\n"
+    "    ldp d8, d9, [sp, #96]\n"
+    "    ldp d10, d11, [sp, #112]\n"
+    "    ldp d12, d13, [sp, #128]\n"
+    "    ldp d14, d15, [sp, #144]\n"
+    "    add sp, sp, #160\n"
+    "    ret\n"
+    ".globl " BLADE_FIBERS_SYMBOL(blade_fiber_start) "\n"
+    ".p2align 4\n"
+    BLADE_FIBERS_SYMBOL(blade_fiber_start) ":\n"
+    "    mov x0, x19\n"
+    "    blr x20\n"
+    "    brk #0\n"
+);
+#endif
+
+#endif // !BLADE_PLATFORM_WINDOWS
+
+namespace blade
+{
+    namespace core
+    {
+        namespace detail
+        {
+            struct fiber
+            {
+                enum class action : u8
+                {
+                    none,
+                    /// @brief The task returned and the fiber is free again
+                    finish,
+                    /// @brief Park on `waiting_on`
+                    wait,
+                    /// @brief Queue again behind the other jobs
+                    yield,
+                };
+
+                /// @brief Saved stack pointer while switched out. The fiber handle on Windows
+                void* context { nullptr };
+                void (*entry)(fiber*) noexcept { nullptr };
+                fibers* owner { nullptr };
+
+                std::byte* stack { nullptr };
+                usize stack_size { 0 };
+
+                /// @brief Task to run next. Erased since the type is private to the scheduler
+                void* task { nullptr };
+
+                /// @brief Why the fiber last switched out, for the thread it switched back to
+                action pending { action::none };
+                fiber_counter* waiting_on { nullptr };
+                fiber* next_waiter { nullptr };
+
+#if defined(BLADE_FIBERS_ASAN)
+                void* fake_stack { nullptr };
+#endif
+#if defined(BLADE_FIBERS_TSAN)
+                void* tsan_fiber { nullptr };
+#endif
+            };
+        } // detail namespace
+
+        namespace
+        {
+            /// @brief Ends the waiter list of a counter that is pending, so an empty list is told apart from a done counter
+            detail::fiber open_list{};
+
+            /// @brief What a fiber switches back to, for the thread running it
+            struct thread_state
+            {
+                void* return_context { nullptr };
+                detail::fiber* current { nullptr };
+
+#if defined(BLADE_FIBERS_ASAN)
+                const void* return_stack { nullptr };
+                usize return_stack_size { 0 };
+#endif
+#if defined(BLADE_FIBERS_TSAN)
+                void* return_tsan_fiber { nullptr };
+#endif
+            };
+
+            thread_local thread_state current_state{};
+
+            /**
+             * @brief The calling thread's state
+             *
+             * Fibers resume on other threads, so the compiler must not reuse a thread-local address it computed
+             * before a switch. Keeping this out of line and opaque makes every call look it up again.
+             */
+            BLADE_FIBERS_NOINLINE thread_state& state_() noexcept
+            {
+                thread_state* state = &current_state;
+#if !defined(_MSC_VER)
+                asm volatile("" : "+r"(state));
+#endif
+                return *state;
+            }
+
+            void switch_context_(void** from, void* to) noexcept
+            {
+#if defined(BLADE_PLATFORM_WINDOWS)
+                if (!IsThreadAFiber())
+                {
+                    ConvertThreadToFiber(nullptr);
+                }
+
+                *from = GetCurrentFiber();
+                SwitchToFiber(to);
+#else
+                blade_fiber_switch(from, to);
+#endif
+            }
+
+#if defined(BLADE_PLATFORM_WINDOWS)
+            void WINAPI windows_fiber_start(void* parameter)
+            {
+                auto* self = static_cast<detail::fiber*>(parameter);
+                self->entry(self);
+            }
+#endif
+
+            bool create_context_(detail::fiber& fiber, allocator& source) noexcept
+            {
+#if defined(BLADE_PLATFORM_WINDOWS)
+                (void)source;
+                fiber.context = CreateFiberEx(fiber.stack_size, fiber.stack_size, FIBER_FLAG_FLOAT_SWITCH, &windows_fiber_start, &fiber);
+                return fiber.context != nullptr;
+#else
+                fiber.stack = static_cast<std::byte*>(source.allocate(fiber.stack_size, 16, memory_tag::fibers));
+                if (fiber.stack == nullptr)
+                {
+                    return false;
+                }
+
+                // The first switch onto the fiber restores these registers and returns into blade_fiber_start
+                auto* top = reinterpret_cast<std::uintptr_t*>(fiber.stack + fiber.stack_size);
+    #if defined(__x86_64__)
+                std::uintptr_t* frame = top - 8;
+                const u32 control_words[2] = { 0x1F80, 0x037F };
+                std::memcpy(&frame[0], control_words, sizeof(control_words));
+                frame[1] = 0;                                                        // r15
+                frame[2] = 0;                                                        // r14
+                frame[3] = reinterpret_cast<std::uintptr_t>(fiber.entry);           // r13
+                frame[4] = reinterpret_cast<std::uintptr_t>(&fiber);                // r12
+                frame[5] = 0;                                                        // rbx
+                frame[6] = 0;                                                        // rbp
+                frame[7] = reinterpret_cast<std::uintptr_t>(&blade_fiber_start);    // return address
+    #elif defined(__aarch64__)
+                std::uintptr_t* frame = top - 20;
+                std::memset(frame, 0, 20 * sizeof(std::uintptr_t));
+                frame[0] = reinterpret_cast<std::uintptr_t>(&fiber);                // x19
+                frame[1] = reinterpret_cast<std::uintptr_t>(fiber.entry);           // x20
+                frame[11] = reinterpret_cast<std::uintptr_t>(&blade_fiber_start);   // x30
+    #endif
+                fiber.context = frame;
+
+    #if defined(BLADE_FIBERS_TSAN)
+                fiber.tsan_fiber = __tsan_create_fiber(0);
+    #endif
+                return true;
+#endif
+            }
+
+            void destroy_context_(detail::fiber& fiber, allocator& source) noexcept
+            {
+#if defined(BLADE_PLATFORM_WINDOWS)
+                (void)source;
+                DeleteFiber(fiber.context);
+#else
+    #if defined(BLADE_FIBERS_TSAN)
+                __tsan_destroy_fiber(fiber.tsan_fiber);
+    #endif
+                source.deallocate(fiber.stack);
+#endif
+                fiber.context = nullptr;
+                fiber.stack = nullptr;
+            }
+
+            /// @brief Tell the sanitizers the thread moves onto `fiber`'s stack
+            void enter_fiber_(detail::fiber& fiber, [[maybe_unused]] void** fake_stack) noexcept
+            {
+#if defined(BLADE_FIBERS_ASAN)
+                __sanitizer_start_switch_fiber(fake_stack, fiber.stack, fiber.stack_size);
+#endif
+#if defined(BLADE_FIBERS_TSAN)
+                state_().return_tsan_fiber = __tsan_get_current_fiber();
+                __tsan_switch_to_fiber(fiber.tsan_fiber, 0);
+#endif
+                (void)fiber;
+            }
+
+            /// @brief Tell the sanitizers the fiber goes back to the stack that switched onto it
+            void leave_fiber_([[maybe_unused]] detail::fiber& fiber, [[maybe_unused]] thread_state& state) noexcept
+            {
+#if defined(BLADE_FIBERS_ASAN)
+                __sanitizer_start_switch_fiber(&fiber.fake_stack, state.return_stack, state.return_stack_size);
+#endif
+#if defined(BLADE_FIBERS_TSAN)
+                __tsan_switch_to_fiber(state.return_tsan_fiber, 0);
+#endif
+            }
+
+            /// @brief Called on the fiber once it runs, recording the stack it came from
+            void entered_fiber_([[maybe_unused]] detail::fiber& fiber) noexcept
+            {
+#if defined(BLADE_FIBERS_ASAN)
+                thread_state& state = state_();
+                __sanitizer_finish_switch_fiber(fiber.fake_stack, &state.return_stack, &state.return_stack_size);
+#endif
+            }
+        } // anonymous namespace
+
+        fibers::fibers(jobs& workers, u32 fiber_count, usize stack_size, allocator& source) noexcept
+            : _jobs { &workers }
+            , _source { &source }
+            , _stack_size { (std::max(stack_size, usize{ 16 * 1024 }) + 15) & ~usize{ 15 } }
+            , _task_pool { source }
+        {
+            _fibers.reserve(fiber_count);
+            _free.reserve(fiber_count);
+
+            for (u32 i = 0; i < fiber_count; i++)
+            {
+                auto created = std::make_unique<detail::fiber>();
+                created->owner = this;
+                created->entry = &fibers::fiber_main_;
+                created->stack_size = _stack_size;
+
+                if (!create_context_(*created, *_source))
+                {
+                    logger::error("Failed to create fiber {} of {}", i, fiber_count);
+                    break;
+                }
+
+                _free.push_back(created.get());
+                _fibers.push_back(std::move(created));
+            }
+        }
+
+        fibers::~fibers() noexcept
+        {
+            if (_free.size() != _fibers.size())
+            {
+                logger::warn("Destroying fibers with {} tasks still parked", _fibers.size() - _free.size());
+            }
+
+            for (auto& fiber : _fibers)
+            {
+                destroy_context_(*fiber, *_source);
+            }
+        }
+
+        void fibers::wait(fiber_counter& counter) noexcept
+        {
+            if (counter.is_done())
+            {
+                return;
+            }
+
+            detail::fiber* self = state_().current;
+            if (self == nullptr)
+            {
+                while (!counter.is_done())
+                {
+                    if (!_jobs->run_one())
+                    {
+                        std::this_thread::yield();
+                    }
+                }
+                return;
+            }
+
+            self->pending = detail::fiber::action::wait;
+            self->waiting_on = &counter;
+            suspend_();
+        }
+
+        void fibers::yield() noexcept
+        {
+            detail::fiber* self = state_().current;
+            if (self == nullptr)
+            {
+                return;
+            }
+
+            self->pending = detail::fiber::action::yield;
+            suspend_();
+        }
+
+        bool fibers::in_fiber() noexcept
+        {
+            return state_().current != nullptr;
+        }
+
+        fibers& fibers::shared() noexcept
+        {
+            static fibers instance{ jobs::shared() };
+            return instance;
+        }
+
+        void fibers::open_(fiber_counter& counter) noexcept
+        {
+            // A list still set here belongs to the task that just took the count to zero and has yet to clear it.
+            // Reopening before that lands would let it mark the counter done under the task being spawned
+            detail::fiber* expected = nullptr;
+            while (!counter._waiters.compare_exchange_weak(expected, &open_list, std::memory_order_acq_rel, std::memory_order_acquire))
+            {
+                expected = nullptr;
+                std::this_thread::yield();
+            }
+        }
+
+        void fibers::start_(task* started) noexcept
+        {
+            _jobs->spawn([this, started]() { run_task_(started); });
+        }
+
+        void fibers::run_task_(task* started) noexcept
+        {
+            detail::fiber* target = nullptr;
+            {
+                std::lock_guard lock(_free_mutex);
+                if (!_free.empty())
+                {
+                    target = _free.back();
+                    _free.pop_back();
+                }
+            }
+
+            // Every fiber is running or parked. Behind the queued jobs the running tasks get to finish and free one
+            if (target == nullptr)
+            {
+                _jobs->defer([this, started]() { run_task_(started); });
+                return;
+            }
+
+            target->task = started;
+            switch_to_(target);
+        }
+
+        void fibers::resume_(detail::fiber* resumed) noexcept
+        {
+            switch_to_(resumed);
+        }
+
+        void fibers::switch_to_(detail::fiber* target) noexcept
+        {
+            // A task waiting through `jobs::wait` can run this too, so the outer fiber's state is put back after
+            thread_state& state = state_();
+            const thread_state outer = state;
+
+            state.current = target;
+            target->pending = detail::fiber::action::none;
+
+            [[maybe_unused]] void* fake_stack = nullptr;
+            enter_fiber_(*target, &fake_stack);
+            switch_context_(&state.return_context, target->context);
+#if defined(BLADE_FIBERS_ASAN)
+            __sanitizer_finish_switch_fiber(fake_stack, nullptr, nullptr);
+#endif
+
+            // Only the fiber's stack moves between threads. This one is still on the thread that switched
+            state = outer;
+            after_switch_(target);
+        }
+
+        void fibers::after_switch_(detail::fiber* suspended) noexcept
+        {
+            switch (suspended->pending)
+            {
+                case detail::fiber::action::finish:
+                {
+                    std::lock_guard lock(_free_mutex);
+                    _free.push_back(suspended);
+                    break;
+                }
+                case detail::fiber::action::wait:
+                {
+                    park_(suspended, *suspended->waiting_on);
+                    break;
+                }
+                case detail::fiber::action::yield:
+                {
+                    _jobs->defer([this, suspended]() { resume_(suspended); });
+                    break;
+                }
+                case detail::fiber::action::none:
+                {
+                    logger::error("Fiber switched out without a reason");
+                    break;
+                }
+            }
+        }
+
+        void fibers::suspend_() noexcept
+        {
+            thread_state& state = state_();
+            detail::fiber* self = state.current;
+
+            leave_fiber_(*self, state);
+            switch_context_(&self->context, state.return_context);
+
+            // Resumed, possibly on another thread
+            entered_fiber_(*self);
+        }
+
+        void fibers::park_(detail::fiber* waiter, fiber_counter& counter) noexcept
+        {
+            // Parking only happens once the fiber is off its stack, so a finishing task can resume it right away
+            detail::fiber* head = counter._waiters.load(std::memory_order_acquire);
+            do
+            {
+                if (head == nullptr)
+                {
+                    _jobs->spawn([this, waiter]() { resume_(waiter); });
+                    return;
+                }
+
+                waiter->next_waiter = head;
+            }
+            while (!counter._waiters.compare_exchange_weak(head, waiter, std::memory_order_release, std::memory_order_acquire));
+        }
+
+        void fibers::finish_(fiber_counter& counter) noexcept
+        {
+            if (counter._pending.fetch_sub(1, std::memory_order_acq_rel) != 1)
+            {
+                return;
+            }
+
+            // The counter may be destroyed as soon as this lands, so the list is the last thing read from it
+            detail::fiber* waiter = counter._waiters.exchange(nullptr, std::memory_order_acq_rel);
+            while (waiter != nullptr && waiter != &open_list)
+            {
+                detail::fiber* next = waiter->next_waiter;
+                waiter->next_waiter = nullptr;
+                _jobs->spawn([this, waiter]() { resume_(waiter); });
+                waiter = next;
+            }
+        }
+
+        void fibers::yield_or_sleep_() noexcept
+        {
+            if (in_fiber())
+            {
+                yield();
+            }
+            else
+            {
+                std::this_thread::yield();
+            }
+        }
+
+        void fibers::fiber_main_(detail::fiber* self) noexcept
+        {
+            entered_fiber_(*self);
+
+            for (;;)
+            {
+                auto* current = static_cast<task*>(self->task);
+                fiber_counter* counter = current->counter;
+                fibers& owner = *self->owner;
+
+                current->run(*current);
+                owner._task_pool.destroy(current);
+                self->task = nullptr;
+
+                if (counter != nullptr)
+                {
+                    owner.finish_(*counter);
+                }
+
+                // Switching back frees the fiber, and the next task that takes it continues from here
+                self->pending = detail::fiber::action::finish;
+                owner.suspend_();
+            }
+        }
+    } // core namespace
+} // blade namespace
@@ -0,0 +1,37 @@
+#include "core/frame_arena.h"
+
+#if defined(_MSC_VER)
+    #define BLADE_FRAME_ARENA_NOINLINE __declspec(noinline)
+#else
+    #define BLADE_FRAME_ARENA_NOINLINE __attribute__((noinline))
+#endif
+
+namespace blade
+{
+    namespace core
+    {
+        namespace
+        {
+            thread_local frame_arena local_arena{};
+            thread_local u64 local_epoch = 0;
+        } // anonymous namespace
+
+        BLADE_FRAME_ARENA_NOINLINE frame_arena& frame_arena::local() noexcept
+        {
+            frame_arena* arena = &local_arena;
+#if !defined(_MSC_VER)
+            // Keeps link-time optimization from folding the thread lookup into a caller that may switch fibers
+            asm volatile("" : "+r"(arena));
+#endif
+
+            const u64 current = _epoch.load(std::memory_order_acquire);
+            if (local_epoch != current)
+            {
+                arena->reset();
+                local_epoch = current;
+            }
+
+            return *arena;
+        }
+    } // core namespace
+} // blade namespace
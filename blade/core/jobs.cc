@@ -0,0 +1,260 @@
+#include "core/jobs.h"
+
+namespace blade
+{
+    namespace core
+    {
+        namespace
+        {
+            /// @brief Rounds of searching before an idle worker goes to sleep
+            constexpr u32 spin_rounds = 64;
+
+            struct worker_identity
+            {
+                const void* scheduler { nullptr };
+                void* worker { nullptr };
+                u32 index { 0 };
+            };
+
+            thread_local worker_identity current_identity{};
+        } // anonymous namespace
+
+        jobs::jobs(u32 worker_count) noexcept
+        {
+            if (worker_count == 0)
+            {
+                worker_count = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+            }
+
+            _workers.reserve(worker_count);
+            for (u32 i = 0; i < worker_count; i++)
+            {
+                _workers.push_back(std::make_unique<worker>());
+            }
+
+            // Started only once every deque exists, since workers steal from each other straight away
+            for (u32 i = 0; i < worker_count; i++)
+            {
+                _workers[i]->thread = std::thread([this, i]() { run_worker_(i); });
+            }
+        }
+
+        jobs::~jobs() noexcept
+        {
+            _running.store(false, std::memory_order_seq_cst);
+            _work_signal.fetch_add(1, std::memory_order_seq_cst);
+            _work_signal.notify_all();
+
+            for (auto& worker : _workers)
+            {
+                worker->thread.join();
+            }
+        }
+
+        void jobs::wait(const job_counter& counter) noexcept
+        {
+            while (!counter.is_done())
+            {
+                if (!run_one())
+                {
+                    std::this_thread::yield();
+                }
+            }
+        }
+
+        bool jobs::run_one() noexcept
+        {
+            job* found = find_job_();
+            if (found == nullptr)
+            {
+                return false;
+            }
+
+            execute_(found);
+            return true;
+        }
+
+        jobs& jobs::shared() noexcept
+        {
+            static jobs instance{};
+            return instance;
+        }
+
+        jobs::job* jobs::allocate_job_() noexcept
+        {
+            if (worker* current = current_worker_())
+            {
+                return current->cache->create();
+            }
+
+            return _job_pool.create();
+        }
+
+        void jobs::free_job_(job* finished) noexcept
+        {
+            if (worker* current = current_worker_())
+            {
+                current->cache->destroy(finished);
+                return;
+            }
+
+            _job_pool.destroy(finished);
+        }
+
+        void jobs::submit_(job* submitted) noexcept
+        {
+            worker* current = current_worker_();
+            if (current == nullptr)
+            {
+                inject_(submitted);
+                return;
+            }
+
+            current->deque.push(submitted);
+            signal_work_();
+        }
+
+        void jobs::inject_(job* submitted) noexcept
+        {
+            {
+                std::lock_guard lock(_injected_mutex);
+                const usize count = _injected_count.load(std::memory_order_relaxed);
+                if (count == _injected.size())
+                {
+                    grow_injected_();
+                }
+
+                _injected[(_injected_head + count) % _injected.size()] = submitted;
+                _injected_count.fetch_add(1, std::memory_order_relaxed);
+            }
+
+            signal_work_();
+        }
+
+        void jobs::grow_injected_() noexcept
+        {
+            constexpr usize initial_capacity = 64;
+
+            // Unwrapped into the new ring so the queued jobs keep their order
+            const usize count = _injected_count.load(std::memory_order_relaxed);
+            std::vector<job*> grown(std::max(_injected.size() * 2, initial_capacity));
+            for (usize i = 0; i < count; i++)
+            {
+                grown[i] = _injected[(_injected_head + i) % _injected.size()];
+            }
+
+            _injected = std::move(grown);
+            _injected_head = 0;
+        }
+
+        void jobs::signal_work_() noexcept
+        {
+            // Pairs with the sleeping count going up before a worker's last look at the signal, so a wake is never lost
+            _work_signal.fetch_add(1, std::memory_order_seq_cst);
+            if (_sleeping.load(std::memory_order_seq_cst) > 0)
+            {
+                _work_signal.notify_one();
+            }
+        }
+
+        jobs::job* jobs::find_job_() noexcept
+        {
+            job* found = nullptr;
+
+            worker* current = current_worker_();
+            if (current != nullptr && current->deque.pop(found))
+            {
+                return found;
+            }
+
+            if (_injected_count.load(std::memory_order_relaxed) > 0)
+            {
+                std::lock_guard lock(_injected_mutex);
+                if (_injected_count.load(std::memory_order_relaxed) > 0)
+                {
+                    found = _injected[_injected_head];
+                    _injected_head = (_injected_head + 1) % _injected.size();
+                    _injected_count.fetch_sub(1, std::memory_order_relaxed);
+                    return found;
+                }
+            }
+
+            // Victims are visited starting after the thief, so thieves spread out instead of all hitting worker 0
+            const usize count = _workers.size();
+            const usize start = current != nullptr ? current_identity.index + 1 : 0;
+            for (usize i = 0; i < count; i++)
+            {
+                worker& victim = *_workers[(start + i) % count];
+                if (&victim != current && victim.deque.steal(found))
+                {
+                    return found;
+                }
+            }
+
+            return nullptr;
+        }
+
+        void jobs::execute_(job* found) noexcept
+        {
+            job_counter* counter = found->counter;
+            found->run(*found);
+            free_job_(found);
+
+            if (counter != nullptr)
+            {
+                counter->_pending.fetch_sub(1, std::memory_order_release);
+            }
+        }
+
+        void jobs::run_worker_(u32 index) noexcept
+        {
+            worker& self = *_workers[index];
+            self.cache.emplace(_job_pool);
+            current_identity = worker_identity{
+                .scheduler = this,
+                .worker = &self,
+                .index = index,
+            };
+
+            u32 idle_rounds = 0;
+            while (_running.load(std::memory_order_relaxed))
+            {
+                const u32 signal = _work_signal.load(std::memory_order_seq_cst);
+                if (job* found = find_job_())
+                {
+                    execute_(found);
+                    idle_rounds = 0;
+                    continue;
+                }
+
+                if (++idle_rounds < spin_rounds)
+                {
+                    std::this_thread::yield();
+                    continue;
+                }
+
+                _sleeping.fetch_add(1, std::memory_order_seq_cst);
+                if (_running.load(std::memory_order_seq_cst))
+                {
+                    _work_signal.wait(signal, std::memory_order_seq_cst);
+                }
+                _sleeping.fetch_sub(1, std::memory_order_seq_cst);
+                idle_rounds = 0;
+            }
+
+            // Jobs left at shutdown still run, so nothing waiting on a counter is stranded
+            while (job* found = find_job_())
+            {
+                execute_(found);
+            }
+
+            self.cache.reset();
+            current_identity = worker_identity{};
+        }
+
+        jobs::worker* jobs::current_worker_() const noexcept
+        {
+            return current_identity.scheduler == this ? static_cast<worker*>(current_identity.worker) : nullptr;
+        }
+    } // core namespace
+} // blade namespace
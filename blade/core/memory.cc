@@ -0,0 +1,75 @@
+#include "core/memory.h"
+#include "core/allocator.h"
+
+#include <cstddef>
+#include <cstring>
+#include <memory>
+
+namespace blade
+{
+    namespace core
+    {
+        namespace
+        {
+            struct borrowed_memory : memory
+            {
+                release_fn release { nullptr };
+                void* user_data { nullptr };
+            };
+
+            /// @brief Copies keep their header and bytes in one allocation, with the bytes aligned for any type
+            constexpr usize copy_header_size = (sizeof(memory) + alignof(std::max_align_t) - 1) & ~(alignof(std::max_align_t) - 1);
+        } // anonymous namespace
+
+        const memory* memory::copy(const void* data, usize size) noexcept
+        {
+            // Not on a frame arena: the consumer may run on another thread, after a frame boundary rewound the arena
+            auto* block = static_cast<std::byte*>(allocator::heap().allocate(copy_header_size + size, alignof(std::max_align_t), memory_tag::resources));
+            if (block == nullptr)
+            {
+                return nullptr;
+            }
+
+            std::byte* bytes = block + copy_header_size;
+            if (size > 0)
+            {
+                std::memcpy(bytes, data, size);
+            }
+
+            return std::construct_at(reinterpret_cast<memory*>(block), memory{
+                .data = bytes,
+                .size = size,
+                .releaser = [](const memory* released) {
+                    allocator::heap().deallocate(const_cast<memory*>(released));
+                },
+            });
+        }
+
+        const memory* memory::ref(const void* data, usize size, release_fn release, void* user_data) noexcept
+        {
+            auto* borrowed = new borrowed_memory{};
+            borrowed->data = const_cast<void*>(data);
+            borrowed->size = size;
+            borrowed->release = release;
+            borrowed->user_data = user_data;
+            borrowed->releaser = [](const memory* released) {
+                const auto* borrowed = static_cast<const borrowed_memory*>(released);
+                if (borrowed->release != nullptr)
+                {
+                    borrowed->release(borrowed->data, borrowed->user_data);
+                }
+                delete borrowed;
+            };
+
+            return borrowed;
+        }
+
+        void memory::release(const memory* memory) noexcept
+        {
+            if (memory != nullptr && memory->releaser != nullptr)
+            {
+                memory->releaser(memory);
+            }
+        }
+    } // core namespace
+} // blade namespace
@@ -0,0 +1,337 @@
+#include "core/tlsf_allocator.h"
+#include "core/logger.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+namespace blade
+{
+    namespace core
+    {
+        /**
+         * @brief Header in front of every block's payload
+         *
+         * Blocks of a region sit back to back and end in a used, empty sentinel, so `next_phys` never leaves the
+         * region. The size field also carries the free bit in its low bits, which alignment leaves unused, and
+         * the tag in its top byte, which no block size reaches. A free block keeps its list links in its payload.
+         */
+        struct tlsf_allocator::block
+        {
+            static constexpr usize header_size = 2 * sizeof(void*);
+            static constexpr usize min_size = 2 * sizeof(void*);
+            static constexpr usize free_bit = 1;
+            static constexpr u32 tag_shift = 56;
+            static constexpr usize size_mask = ((usize{ 1 } << tag_shift) - 1) & ~(align_size - 1);
+            static_assert(header_size % align_size == 0, "Payloads must stay aligned");
+
+            /// @brief Previous block in address order. `nullptr` for the first block of a region
+            block* prev_phys { nullptr };
+            usize bits { 0 };
+
+            block* next_free { nullptr };
+            block* prev_free { nullptr };
+
+            [[nodiscard]] usize size() const noexcept { return bits & size_mask; }
+            void set_size(usize size) noexcept { bits = (bits & ~size_mask) | size; }
+
+            [[nodiscard]] bool is_free() const noexcept { return (bits & free_bit) != 0; }
+            void set_free(bool free) noexcept { bits = free ? bits | free_bit : bits & ~free_bit; }
+
+            [[nodiscard]] memory_tag tag() const noexcept { return static_cast<memory_tag>(bits >> tag_shift); }
+            void set_tag(memory_tag tag) noexcept
+            {
+                bits = (bits & ((usize{ 1 } << tag_shift) - 1)) | (static_cast<usize>(tag) << tag_shift);
+            }
+
+            [[nodiscard]] std::byte* payload() noexcept { return reinterpret_cast<std::byte*>(this) + header_size; }
+            [[nodiscard]] block* next_phys() noexcept { return reinterpret_cast<block*>(payload() + size()); }
+
+            [[nodiscard]] static block* from_payload(void* memory) noexcept
+            {
+                return reinterpret_cast<block*>(static_cast<std::byte*>(memory) - header_size);
+            }
+        };
+
+        namespace
+        {
+            [[nodiscard]] constexpr usize align_up(usize value, usize alignment) noexcept
+            {
+                return (value + alignment - 1) & ~(alignment - 1);
+            }
+        } // anonymous namespace
+
+        tlsf_allocator::tlsf_allocator(usize region_size) noexcept
+            : _region_size { region_size }
+        {}
+
+        tlsf_allocator::~tlsf_allocator() noexcept
+        {
+            for (void* region : _regions)
+            {
+                ::operator delete(region, std::align_val_t{ align_size });
+            }
+        }
+
+        void* tlsf_allocator::allocate(usize size, usize alignment, memory_tag tag) noexcept
+        {
+            alignment = std::max(alignment, align_size);
+            if (size > (usize{ 1 } << (first_level_max - 2)) || alignment > (usize{ 1 } << (first_level_max - 2)))
+            {
+                logger::error("TLSF allocation of {} bytes aligned to {} is too large", size, alignment);
+                return nullptr;
+            }
+
+            const usize adjusted = std::max(align_up(size, align_size), block::min_size);
+
+            // Over-aligned requests need room to move the start forward, leaving a gap that is a block of its own
+            const usize search = round_to_list_(alignment > align_size
+                ? adjusted + alignment + block::header_size + block::min_size
+                : adjusted);
+
+            std::lock_guard lock(_mutex);
+
+            list_index index = mapping_insert_(search);
+            block* found = find_free_(index);
+            if (found == nullptr)
+            {
+                if (!add_region_(search))
+                {
+                    return nullptr;
+                }
+
+                index = mapping_insert_(search);
+                found = find_free_(index);
+            }
+
+            remove_free_(found);
+
+            if (alignment > align_size)
+            {
+                const auto start = reinterpret_cast<std::uintptr_t>(found->payload());
+                usize gap = align_up(start, alignment) - start;
+                if (gap != 0 && gap < block::header_size + block::min_size)
+                {
+                    gap = align_up(start + block::header_size + block::min_size, alignment) - start;
+                }
+
+                if (gap != 0)
+                {
+                    found = trim_leading_(found, gap);
+                }
+            }
+
+            trim_(found, adjusted);
+            found->set_free(false);
+            found->set_tag(tag);
+
+            track_allocate(tag, found->size());
+            return found->payload();
+        }
+
+        void tlsf_allocator::deallocate(void* memory) noexcept
+        {
+            if (memory == nullptr)
+            {
+                return;
+            }
+
+            std::lock_guard lock(_mutex);
+
+            block* freed = block::from_payload(memory);
+#ifndef NDEBUG
+            if (freed->is_free())
+            {
+                logger::error("TLSF block at {} freed twice", memory);
+                return;
+            }
+#endif
+            track_free(freed->tag(), freed->size());
+
+            if (block* prev = freed->prev_phys; prev != nullptr && prev->is_free())
+            {
+                remove_free_(prev);
+                prev->set_size(prev->size() + block::header_size + freed->size());
+                freed = prev;
+                freed->next_phys()->prev_phys = freed;
+            }
+
+            if (block* next = freed->next_phys(); next->is_free())
+            {
+                remove_free_(next);
+                freed->set_size(freed->size() + block::header_size + next->size());
+                freed->next_phys()->prev_phys = freed;
+            }
+
+            insert_free_(freed);
+        }
+
+        usize tlsf_allocator::capacity() const noexcept
+        {
+            std::lock_guard lock(_mutex);
+            return _capacity;
+        }
+
+        usize tlsf_allocator::region_count() const noexcept
+        {
+            std::lock_guard lock(_mutex);
+            return _regions.size();
+        }
+
+        tlsf_allocator::list_index tlsf_allocator::mapping_insert_(usize size) noexcept
+        {
+            if (size < small_block_size)
+            {
+                return list_index{
+                    .first = 0,
+                    .second = static_cast<u32>(size / (small_block_size / second_level_count)),
+                };
+            }
+
+            const u32 top_bit = static_cast<u32>(std::bit_width(size)) - 1;
+            return list_index{
+                .first = top_bit - (first_level_shift - 1),
+                .second = static_cast<u32>(size >> (top_bit - second_level_log2)) ^ second_level_count,
+            };
+        }
+
+        usize tlsf_allocator::round_to_list_(usize size) noexcept
+        {
+            if (size >= small_block_size)
+            {
+                size += (usize{ 1 } << (std::bit_width(size) - 1 - second_level_log2)) - 1;
+            }
+
+            return size;
+        }
+
+        tlsf_allocator::block* tlsf_allocator::find_free_(list_index& index) const noexcept
+        {
+            u32 second_map = _second_level_bitmaps[index.first] & (~0u << index.second);
+            if (second_map == 0)
+            {
+                const u32 first_map = index.first + 1 < first_level_count
+                    ? _first_level_bitmap & (~0u << (index.first + 1))
+                    : 0;
+                if (first_map == 0)
+                {
+                    return nullptr;
+                }
+
+                index.first = static_cast<u32>(std::countr_zero(first_map));
+                second_map = _second_level_bitmaps[index.first];
+            }
+
+            index.second = static_cast<u32>(std::countr_zero(second_map));
+            return _free_lists[index.first][index.second];
+        }
+
+        void tlsf_allocator::insert_free_(block* free) noexcept
+        {
+            const list_index index = mapping_insert_(free->size());
+            block*& head = _free_lists[index.first][index.second];
+
+            free->set_free(true);
+            free->prev_free = nullptr;
+            free->next_free = head;
+            if (head != nullptr)
+            {
+                head->prev_free = free;
+            }
+            head = free;
+
+            _first_level_bitmap |= 1u << index.first;
+            _second_level_bitmaps[index.first] |= 1u << index.second;
+        }
+
+        void tlsf_allocator::remove_free_(block* used) noexcept
+        {
+            const list_index index = mapping_insert_(used->size());
+            block*& head = _free_lists[index.first][index.second];
+
+            if (used->next_free != nullptr)
+            {
+                used->next_free->prev_free = used->prev_free;
+            }
+
+            if (used->prev_free != nullptr)
+            {
+                used->prev_free->next_free = used->next_free;
+            }
+            else
+            {
+                head = used->next_free;
+                if (head == nullptr)
+                {
+                    _second_level_bitmaps[index.first] &= ~(1u << index.second);
+                    if (_second_level_bitmaps[index.first] == 0)
+                    {
+                        _first_level_bitmap &= ~(1u << index.first);
+                    }
+                }
+            }
+
+            used->set_free(false);
+        }
+
+        void tlsf_allocator::trim_(block* used, usize size) noexcept
+        {
+            if (used->size() < size + block::header_size + block::min_size)
+            {
+                return;
+            }
+
+            auto* rest = reinterpret_cast<block*>(used->payload() + size);
+            rest->bits = 0;
+            rest->set_size(used->size() - size - block::header_size);
+            rest->prev_phys = used;
+            rest->next_phys()->prev_phys = rest;
+            used->set_size(size);
+
+            // The block was free, so its neighbours are not and the tail needs no merging
+            insert_free_(rest);
+        }
+
+        tlsf_allocator::block* tlsf_allocator::trim_leading_(block* used, usize gap) noexcept
+        {
+            auto* rest = reinterpret_cast<block*>(used->payload() + gap - block::header_size);
+            rest->bits = 0;
+            rest->set_size(used->size() - gap);
+            rest->prev_phys = used;
+            rest->next_phys()->prev_phys = rest;
+            used->set_size(gap - block::header_size);
+
+            insert_free_(used);
+            return rest;
+        }
+
+        bool tlsf_allocator::add_region_(usize payload) noexcept
+        {
+            // One block spanning the region, followed by the sentinel
+            const usize bytes = align_up(std::max(_region_size, payload + 2 * block::header_size), align_size);
+            void* region = ::operator new(bytes, std::align_val_t{ align_size }, std::nothrow);
+            if (region == nullptr)
+            {
+                logger::error("Failed to reserve a TLSF region of {} bytes", bytes);
+                return false;
+            }
+
+            auto* first = static_cast<block*>(region);
+            first->prev_phys = nullptr;
+            first->bits = 0;
+            first->set_size(bytes - 2 * block::header_size);
+
+            block* sentinel = first->next_phys();
+            sentinel->prev_phys = first;
+            sentinel->bits = 0;
+
+            insert_free_(first);
+
+            _regions.push_back(region);
+            _capacity += bytes;
+            return true;
+        }
+    } // core namespace
+} // blade namespace
@@ -0,0 +1,156 @@
+#include "gfx/render_thread.h"
+
+namespace blade
+{
+    namespace gfx
+    {
+        render_thread::render_thread(renderer_backend& backend) noexcept
+            : _backend { backend }
+        {
+            _thread = std::thread([this]() { run_(); });
+        }
+
+        render_thread::~render_thread() noexcept
+        {
+            stop();
+        }
+
+        void render_thread::kick() noexcept
+        {
+            std::unique_lock lock(_state_mutex);
+
+            // The render thread may still be replaying the other stream. Waiting here bounds the frontend to one frame ahead
+            _state_changed.wait(lock, [this]() { return !_has_work; });
+
+            _record_index ^= 1;
+            _streams[_record_index].clear();
+            _has_work = true;
+
+            lock.unlock();
+            _state_changed.notify_all();
+        }
+
+        void render_thread::stop() noexcept
+        {
+            if (!_thread.joinable())
+            {
+                return;
+            }
+
+            // Commands recorded since the last kick still run, so state set before shutdown is not lost
+            if (!stream().is_empty())
+            {
+                kick();
+            }
+
+            {
+                std::lock_guard lock(_state_mutex);
+                _stopping = true;
+            }
+            _state_changed.notify_all();
+
+            _thread.join();
+        }
+
+        void render_thread::run_() noexcept
+        {
+            while (true)
+            {
+                std::unique_lock lock(_state_mutex);
+                _state_changed.wait(lock, [this]() { return _has_work || _stopping; });
+
+                if (!_has_work)
+                {
+                    return;
+                }
+
+                // The frontend only touches the other stream until `_has_work` is cleared
+                const command_stream& stream = _streams[_record_index ^ 1];
+                lock.unlock();
+
+                {
+                    std::lock_guard backend_lock(_backend_mutex);
+                    execute_(stream);
+                }
+
+                lock.lock();
+                _has_work = false;
+                lock.unlock();
+                _state_changed.notify_all();
+            }
+        }
+
+        void render_thread::execute_(const command_stream& stream) noexcept
+        {
+            usize cursor = 0;
+            while (auto command = stream.read(cursor))
+            {
+                switch (command->code)
+                {
+                    case command_stream::op::set_viewport:
+                    {
+                        const auto payload = command->as<command_stream::set_viewport_payload>();
+                        _backend.set_viewport(payload.framebuffer, payload.x, payload.y, width{ payload.width }, height{ payload.height });
+                    } break;
+
+                    case command_stream::op::set_render_state:
+                    {
+                        const auto payload = command->as<command_stream::set_render_state_payload>();
+                        _backend.set_render_state(payload.framebuffer, payload.state);
+                    } break;
+
+                    case command_stream::op::set_vertex_buffer:
+                    {
+                        const auto payload = command->as<command_stream::set_buffer_payload>();
+                        _backend.set_vertex_buffer(payload.framebuffer, payload.buffer);
+                    } break;
+
+                    case command_stream::op::set_index_buffer:
+                    {
+                        const auto payload = command->as<command_stream::set_buffer_payload>();
+                        _backend.set_index_buffer(payload.framebuffer, payload.buffer);
+                    } break;
+
+                    case command_stream::op::draw:
+                    {
+                        const auto payload = command->as<command_stream::draw_payload>();
+                        _backend.draw(payload.framebuffer, payload.call);
+                    } break;
+
+                    case command_stream::op::set_push_constants:
+                    {
+                        const auto payload = command->as<command_stream::set_push_constants_payload>();
+                        const auto data = command->trailing<command_stream::set_push_constants_payload>();
+                        _backend.set_push_constants(payload.framebuffer, data.data(), payload.size, payload.offset);
+                    } break;
+
+                    case command_stream::op::set_frame_pacing:
+                    {
+                        const auto payload = command->as<command_stream::set_frame_pacing_payload>();
+                        _backend.set_frame_pacing(payload.framebuffer, payload.pacing);
+                    } break;
+
+                    case command_stream::op::destroy_shader:
+                    {
+                        _backend.destroy_shader(command->as<command_stream::destroy_shader_payload>().shader);
+                    } break;
+
+                    case command_stream::op::destroy_view_program:
+                    {
+                        _backend.destroy_view_program(command->as<command_stream::destroy_view_program_payload>().program);
+                    } break;
+
+                    case command_stream::op::destroy_buffer:
+                    {
+                        _backend.destroy_buffer(command->as<command_stream::destroy_buffer_payload>().buffer);
+                    } break;
+
+                    case command_stream::op::frame:
+                    {
+                        _backend.frame();
+                    } break;
+                }
+            }
+        }
+    } // gfx namespace
+} // blade namespace
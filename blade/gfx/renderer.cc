@@ -1,10 +1,16 @@
 #include "gfx/renderer.h"
+#include "core/event.h"
+#include "gfx/command_stream.h"
 #include "gfx/handle.h"
+#include "gfx/render_thread.h"
 #include "gfx/vertex.h"
 #include "gfx/view.h"
 #include "gfx/vulkan/renderer.h"
 
+#include <cstring>
+#include <future>
 #include <memory>
+#include <utility>
 
 namespace blade
 {
@@ -13,7 +19,7 @@ namespace blade
         std::unique_ptr<renderer> renderer::create(const init_info& init) noexcept
         {
             std::unique_ptr<renderer> renderer { new class renderer() };
-            
+
             switch (init.type)
             {
                 case init_info::type::VULKAN:
@@ -26,22 +32,53 @@ namespace blade
                     }
                     renderer->_backend = std::move(backend);
 
+                    if (init.use_render_thread)
+                    {
+                        renderer->_render_thread = std::make_unique<class render_thread>(*renderer->_backend);
+                        logger::info("Renderer replaying frames on a render thread");
+                    }
+
                     logger::info("Renderer initialized with vulkan backend");
 
                     return std::move(renderer);
                 } break;
-                
+
                 case init_info::type::DX12:
                 case init_info::type::METAL:
                 case init_info::type::AUTO:
                     break;
             }
-            
+
             return nullptr;
         }
 
+        renderer::renderer() noexcept = default;
+
+        renderer::~renderer() noexcept = default;
+
+        template <typename R, typename F>
+        R renderer::immediate_(R fallback, F&& function) const noexcept
+        {
+            if (_render_thread)
+            {
+                return _render_thread->immediate(std::forward<F>(function));
+            }
+
+            if (_backend)
+            {
+                return std::forward<F>(function)(*_backend);
+            }
+
+            return fallback;
+        }
+
         void renderer::submit() noexcept
         {
+            if (_render_thread)
+            {
+                return;
+            }
+
             if (_backend)
             {
                 _backend->submit();
@@ -50,7 +87,15 @@ namespace blade
 
         void renderer::present() noexcept
         {
-            if (_backend)
+            // Frame start for the application thread, so events posted since the last frame reach their handlers here
+            events::flush();
+
+            if (_render_thread)
+            {
+                _render_thread->stream().write(command_stream::op::frame);
+                _render_thread->kick();
+            }
+            else if (_backend)
             {
                 _backend->frame();
             }
@@ -58,88 +103,280 @@ namespace blade
 
         framebuffer_handle renderer::create_framebuffer(framebuffer_create_info info) noexcept
         {
-            if (_backend)
-            {
-                return _backend->create_framebuffer(info);
-            }
-
-            return framebuffer_handle { BLADE_NULL_HANDLE };
+            return immediate_(framebuffer_handle { BLADE_NULL_HANDLE }, [&info](renderer_backend& backend) {
+                return backend.create_framebuffer(info);
+            });
         }
 
+        // The backend creates these from any thread and applies them at its next frame boundary, so they skip
+        // the render thread's backend lock and never wait for a replay
         shader_handle renderer::create_shader(const std::vector<u8>& data) noexcept
         {
-            if (_backend)
+            const core::memory code{
+                .data = const_cast<u8*>(data.data()),
+                .size = data.size(),
+            };
+            return create_shader(&code);
+        }
+
+        shader_handle renderer::create_shader(const core::memory* code) noexcept
+        {
+            if (!_backend)
             {
-                return _backend->create_shader(data);
+                core::memory::release(code);
+                return shader_handle { BLADE_NULL_HANDLE };
             }
 
-            return shader_handle { BLADE_NULL_HANDLE };
+            return _backend->create_shader(code);
         }
 
         program_handle renderer::create_view_program(const framebuffer_handle framebuffer, const shader_handle vertex, const shader_handle fragment) noexcept
         {
-            if (_backend)
+            return _backend ? _backend->create_view_program(framebuffer, vertex, fragment) : program_handle { BLADE_NULL_HANDLE };
+        }
+
+        buffer_handle renderer::create_vertex_buffer(const core::memory* memory, const vertex_layout& layout) noexcept
+        {
+            if (!_backend)
             {
-                return _backend->create_view_program(framebuffer, vertex, fragment);
+                core::memory::release(memory);
+                return buffer_handle { BLADE_NULL_HANDLE };
             }
 
-            return program_handle { BLADE_NULL_HANDLE };
+            return _backend->create_vertex_buffer(memory, layout);
         }
 
-        buffer_handle renderer::create_vertex_buffer(const core::memory* memory, const vertex_layout& layout) noexcept
+        buffer_handle renderer::create_index_buffer(const core::memory* memory) const noexcept
         {
-            if (_backend)
+            if (!_backend)
             {
-                return _backend->create_vertex_buffer(memory, layout);
+                core::memory::release(memory);
+                return buffer_handle { BLADE_NULL_HANDLE };
             }
 
-            return buffer_handle { BLADE_NULL_HANDLE };
+            return _backend->create_index_buffer(memory);
         }
 
-        buffer_handle renderer::create_index_buffer(const core::memory* memory) const noexcept
+        void renderer::destroy_shader(const shader_handle handle) const noexcept
         {
-            if (_backend)
+            if (_render_thread)
             {
-                return _backend->create_index_buffer(memory);
+                _render_thread->stream().write(command_stream::op::destroy_shader, command_stream::destroy_shader_payload{
+                    .shader = handle,
+                });
             }
+            else if (_backend)
+            {
+                _backend->destroy_shader(handle);
+            }
+        }
 
-            return buffer_handle { BLADE_NULL_HANDLE };
+        void renderer::destroy_view_program(const program_handle handle) const noexcept
+        {
+            if (_render_thread)
+            {
+                _render_thread->stream().write(command_stream::op::destroy_view_program, command_stream::destroy_view_program_payload{
+                    .program = handle,
+                });
+            }
+            else if (_backend)
+            {
+                _backend->destroy_view_program(handle);
+            }
         }
 
-        void renderer::attach_vertex_buffer(const buffer_handle handle) const noexcept
+        void renderer::destroy_buffer(const buffer_handle handle) const noexcept
         {
-            if (_backend)
+            if (_render_thread)
+            {
+                // Replayed in order, so draws recorded earlier in the frame still see the buffer
+                _render_thread->stream().write(command_stream::op::destroy_buffer, command_stream::destroy_buffer_payload{
+                    .buffer = handle,
+                });
+            }
+            else if (_backend)
             {
-                _backend->attach_vertex_buffer(handle);
+                _backend->destroy_buffer(handle);
             }
         }
-        
-        void renderer::set_index_buffer(const buffer_handle handle) const noexcept
+
+        void renderer::attach_vertex_buffer(const framebuffer_handle framebuffer, const buffer_handle handle) const noexcept
         {
-            if (_backend)
+            // Attaching shapes the vertex input of programs created afterwards, so it cannot wait for the next replay
+            immediate_(false, [=](renderer_backend& backend) {
+                backend.attach_vertex_buffer(framebuffer, handle);
+                return true;
+            });
+        }
+
+        void renderer::set_index_buffer(const framebuffer_handle framebuffer, const buffer_handle handle) const noexcept
+        {
+            if (_render_thread)
+            {
+                _render_thread->stream().write(command_stream::op::set_index_buffer, command_stream::set_buffer_payload{
+                    .framebuffer = framebuffer,
+                    .buffer = handle,
+                });
+            }
+            else if (_backend)
             {
-                _backend->set_index_buffer(handle);
+                _backend->set_index_buffer(framebuffer, handle);
             }
         }
 
-        void renderer::set_vertex_buffer(const buffer_handle handle) const noexcept
+        void renderer::set_vertex_buffer(const framebuffer_handle framebuffer, const buffer_handle handle) const noexcept
         {
-            if (_backend)
+            if (_render_thread)
             {
-                _backend->set_vertex_buffer(handle);
+                _render_thread->stream().write(command_stream::op::set_vertex_buffer, command_stream::set_buffer_payload{
+                    .framebuffer = framebuffer,
+                    .buffer = handle,
+                });
+            }
+            else if (_backend)
+            {
+                _backend->set_vertex_buffer(framebuffer, handle);
             }
         }
 
         void renderer::set_viewport(const framebuffer_handle framebuffer, f32 x, f32 y, struct width width, struct height height) const noexcept
         {
-            if (_backend)
+            if (_render_thread)
+            {
+                _render_thread->stream().write(command_stream::op::set_viewport, command_stream::set_viewport_payload{
+                    .framebuffer = framebuffer,
+                    .x = x,
+                    .y = y,
+                    .width = width.w,
+                    .height = height.h,
+                });
+            }
+            else if (_backend)
             {
                 _backend->set_viewport(framebuffer, x, y, width, height);
             }
         }
 
+        void renderer::set_render_state(const framebuffer_handle framebuffer, const render_state& state) const noexcept
+        {
+            if (_render_thread)
+            {
+                _render_thread->stream().write(command_stream::op::set_render_state, command_stream::set_render_state_payload{
+                    .framebuffer = framebuffer,
+                    .state = state,
+                });
+            }
+            else if (_backend)
+            {
+                _backend->set_render_state(framebuffer, state);
+            }
+        }
+
+        void renderer::draw(const framebuffer_handle framebuffer, const draw_call& call) const noexcept
+        {
+            if (_render_thread)
+            {
+                _render_thread->stream().write(command_stream::op::draw, command_stream::draw_payload{
+                    .framebuffer = framebuffer,
+                    .call = call,
+                });
+            }
+            else if (_backend)
+            {
+                _backend->draw(framebuffer, call);
+            }
+        }
+
+        void renderer::set_frame_pacing(const framebuffer_handle framebuffer, const frame_pacing& pacing) const noexcept
+        {
+            if (_render_thread)
+            {
+                _render_thread->stream().write(command_stream::op::set_frame_pacing, command_stream::set_frame_pacing_payload{
+                    .framebuffer = framebuffer,
+                    .pacing = pacing,
+                });
+            }
+            else if (_backend)
+            {
+                _backend->set_frame_pacing(framebuffer, pacing);
+            }
+        }
+
+        bool renderer::read_framebuffer(const framebuffer_handle framebuffer, u32 target, readback_callback callback) const noexcept
+        {
+            return immediate_(false, [framebuffer, target, &callback](renderer_backend& backend) {
+                return backend.read_framebuffer(framebuffer, target, std::move(callback));
+            });
+        }
+
+        std::future<readback_image> renderer::read_framebuffer(const framebuffer_handle framebuffer, u32 target) const noexcept
+        {
+            // std::function needs a copyable callable, so the promise is shared with the callback
+            auto promise = std::make_shared<std::promise<readback_image>>();
+            auto future = promise->get_future();
+
+            const bool queued = read_framebuffer(framebuffer, target, [promise](const readback& result) {
+                readback_image image{
+                    .pixels = std::vector<u8>(result.pixels.size),
+                    .width = result.width,
+                    .height = result.height,
+                    .format = result.format,
+                };
+                if (result.pixels.data != nullptr)
+                {
+                    std::memcpy(image.pixels.data(), result.pixels.data, result.pixels.size);
+                }
+                promise->set_value(std::move(image));
+            });
+
+            if (!queued)
+            {
+                promise->set_value(readback_image{});
+            }
+
+            return future;
+        }
+
+        u32 renderer::get_bindless_index(const buffer_handle handle) const noexcept
+        {
+            return immediate_(BLADE_INVALID_BINDLESS_INDEX, [handle](renderer_backend& backend) {
+                return backend.get_bindless_index(handle);
+            });
+        }
+
+        bool renderer::declare_push_constants(const framebuffer_handle framebuffer, const push_constant_range range) const noexcept
+        {
+            return immediate_(false, [framebuffer, range](renderer_backend& backend) {
+                return backend.declare_push_constants(framebuffer, range);
+            });
+        }
+
+        void renderer::set_push_constants(const framebuffer_handle framebuffer, const void* data, u32 size, u32 offset) const noexcept
+        {
+            if (_render_thread)
+            {
+                // The data is copied into the stream, so the caller's buffer can change before the replay
+                _render_thread->stream().write(command_stream::op::set_push_constants, command_stream::set_push_constants_payload{
+                    .framebuffer = framebuffer,
+                    .size = size,
+                    .offset = offset,
+                }, data, size);
+            }
+            else if (_backend)
+            {
+                _backend->set_push_constants(framebuffer, data, size, offset);
+            }
+        }
+
         void renderer::shutdown() noexcept
         {
+            // Frames still queued for the render thread finish before the backend goes away
+            if (_render_thread)
+            {
+                _render_thread->stop();
+                _render_thread = nullptr;
+            }
+
             _backend->shutdown();
         }
     } // gfx namespace
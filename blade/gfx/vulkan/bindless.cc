@@ -0,0 +1,314 @@
+#include "gfx/vulkan/bindless.h"
+#include "gfx/vulkan/utils.h"
+#include <algorithm>
+#include <array>
+#include <vulkan/vulkan_core.h>
+
+namespace blade
+{
+    namespace gfx
+    {
+        namespace vk
+        {
+            std::optional<std::shared_ptr<bindless_set>> bindless_set::builder::build() const noexcept
+            {
+                auto device = info.device.lock();
+                if (!device || !device->get_enabled_features().descriptor_indexing)
+                {
+                    logger::error("Bindless set requires a device created with descriptor indexing");
+                    return std::nullopt;
+                }
+
+                // Clamp requested array sizes to what the device allows in a single update-after-bind set
+                const VkPhysicalDeviceDescriptorIndexingProperties& limits =
+                    device->get_physical_device().lock()->get_descriptor_indexing_properties();
+
+                const u32 max_buffers = std::min({
+                    info.max_buffers
+                    , limits.maxDescriptorSetUpdateAfterBindStorageBuffers
+                    , limits.maxPerStageDescriptorUpdateAfterBindStorageBuffers
+                });
+                const u32 max_sampled_images = std::min({
+                    info.max_sampled_images
+                    , limits.maxDescriptorSetUpdateAfterBindSampledImages
+                    , limits.maxPerStageDescriptorUpdateAfterBindSampledImages
+                });
+                const u32 max_samplers = std::min({
+                    info.max_samplers
+                    , limits.maxDescriptorSetUpdateAfterBindSamplers
+                    , limits.maxPerStageDescriptorUpdateAfterBindSamplers
+                });
+
+                logger::info("Creating bindless set. buffers: {}, images: {}, samplers: {}",
+                             max_buffers, max_sampled_images, max_samplers);
+
+                auto set = std::make_shared<bindless_set>(info.device, info.allocation_callbacks);
+                set->_slots[binding::storage_buffers].capacity = max_buffers;
+                set->_slots[binding::sampled_images].capacity = max_sampled_images;
+                set->_slots[binding::samplers].capacity = max_samplers;
+
+                const std::array<VkDescriptorSetLayoutBinding, binding::count> bindings = {
+                    VkDescriptorSetLayoutBinding{
+                        .binding = binding::storage_buffers,
+                        .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                        .descriptorCount = max_buffers,
+                        .stageFlags = VK_SHADER_STAGE_ALL,
+                    },
+                    VkDescriptorSetLayoutBinding{
+                        .binding = binding::sampled_images,
+                        .descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,
+                        .descriptorCount = max_sampled_images,
+                        .stageFlags = VK_SHADER_STAGE_ALL,
+                    },
+                    VkDescriptorSetLayoutBinding{
+                        .binding = binding::samplers,
+                        .descriptorType = VK_DESCRIPTOR_TYPE_SAMPLER,
+                        .descriptorCount = max_samplers,
+                        .stageFlags = VK_SHADER_STAGE_ALL,
+                    },
+                };
+
+                constexpr VkDescriptorBindingFlags binding_flags_value =
+                    VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT
+                    | VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT
+                    | VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT;
+
+                const std::array<VkDescriptorBindingFlags, binding::count> binding_flags = {
+                    binding_flags_value,
+                    binding_flags_value,
+                    binding_flags_value,
+                };
+
+                const VkDescriptorSetLayoutBindingFlagsCreateInfo binding_flags_info{
+                    .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO,
+                    .bindingCount = static_cast<u32>(binding_flags.size()),
+                    .pBindingFlags = binding_flags.data(),
+                };
+
+                const VkDescriptorSetLayoutCreateInfo layout_info{
+                    .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+                    .pNext = &binding_flags_info,
+                    .flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT,
+                    .bindingCount = static_cast<u32>(bindings.size()),
+                    .pBindings = bindings.data(),
+                };
+
+                VkResult result = vkCreateDescriptorSetLayout(
+                    device->handle()
+                    , &layout_info
+                    , info.allocation_callbacks
+                    , &set->_layout
+                );
+
+                if (result != VK_SUCCESS)
+                {
+                    logger::error("Failed to create bindless descriptor set layout: {}", error_string(result));
+                    return std::nullopt;
+                }
+
+                const std::array<VkDescriptorPoolSize, binding::count> pool_sizes = {
+                    VkDescriptorPoolSize{ .type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, .descriptorCount = max_buffers },
+                    VkDescriptorPoolSize{ .type = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, .descriptorCount = max_sampled_images },
+                    VkDescriptorPoolSize{ .type = VK_DESCRIPTOR_TYPE_SAMPLER, .descriptorCount = max_samplers },
+                };
+
+                const VkDescriptorPoolCreateInfo pool_info{
+                    .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+                    .flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT,
+                    .maxSets = 1,
+                    .poolSizeCount = static_cast<u32>(pool_sizes.size()),
+                    .pPoolSizes = pool_sizes.data(),
+                };
+
+                result = vkCreateDescriptorPool(device->handle(), &pool_info, info.allocation_callbacks, &set->_pool);
+                if (result != VK_SUCCESS)
+                {
+                    logger::error("Failed to create bindless descriptor pool: {}", error_string(result));
+                    set->destroy();
+                    return std::nullopt;
+                }
+
+                const VkDescriptorSetAllocateInfo allocate_info{
+                    .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+                    .descriptorPool = set->_pool,
+                    .descriptorSetCount = 1,
+                    .pSetLayouts = &set->_layout,
+                };
+
+                result = vkAllocateDescriptorSets(device->handle(), &allocate_info, &set->_set);
+                if (result != VK_SUCCESS)
+                {
+                    logger::error("Failed to allocate bindless descriptor set: {}", error_string(result));
+                    set->destroy();
+                    return std::nullopt;
+                }
+
+                return set;
+            }
+
+            bindless_set::builder& bindless_set::builder::set_max_buffers(u32 count) noexcept
+            {
+                info.max_buffers = count;
+
+                return *this;
+            }
+
+            bindless_set::builder& bindless_set::builder::set_max_sampled_images(u32 count) noexcept
+            {
+                info.max_sampled_images = count;
+
+                return *this;
+            }
+
+            bindless_set::builder& bindless_set::builder::set_max_samplers(u32 count) noexcept
+            {
+                info.max_samplers = count;
+
+                return *this;
+            }
+
+            bindless_set::builder& bindless_set::builder::set_allocation_callbacks(VkAllocationCallbacks* callbacks) noexcept
+            {
+                info.allocation_callbacks = callbacks;
+
+                return *this;
+            }
+
+            std::optional<u32> bindless_set::register_buffer(VkBuffer buffer, VkDeviceSize offset, VkDeviceSize range) noexcept
+            {
+                const auto index = _slots[binding::storage_buffers].acquire();
+                if (!index.has_value())
+                {
+                    logger::error("Bindless storage buffer array is full");
+                    return std::nullopt;
+                }
+
+                const VkDescriptorBufferInfo buffer_info{
+                    .buffer = buffer,
+                    .offset = offset,
+                    .range = range,
+                };
+
+                write_(binding::storage_buffers, index.value(), VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, nullptr, &buffer_info);
+
+                return index;
+            }
+
+            std::optional<u32> bindless_set::register_sampled_image(VkImageView view, VkImageLayout layout) noexcept
+            {
+                const auto index = _slots[binding::sampled_images].acquire();
+                if (!index.has_value())
+                {
+                    logger::error("Bindless sampled image array is full");
+                    return std::nullopt;
+                }
+
+                const VkDescriptorImageInfo image_info{
+                    .sampler = VK_NULL_HANDLE,
+                    .imageView = view,
+                    .imageLayout = layout,
+                };
+
+                write_(binding::sampled_images, index.value(), VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, &image_info, nullptr);
+
+                return index;
+            }
+
+            std::optional<u32> bindless_set::register_sampler(VkSampler sampler) noexcept
+            {
+                const auto index = _slots[binding::samplers].acquire();
+                if (!index.has_value())
+                {
+                    logger::error("Bindless sampler array is full");
+                    return std::nullopt;
+                }
+
+                const VkDescriptorImageInfo image_info{
+                    .sampler = sampler,
+                };
+
+                write_(binding::samplers, index.value(), VK_DESCRIPTOR_TYPE_SAMPLER, &image_info, nullptr);
+
+                return index;
+            }
+
+            void bindless_set::release(enum binding binding, u32 index) noexcept
+            {
+                if (binding >= binding::count || index == BLADE_INVALID_BINDLESS_INDEX)
+                {
+                    return;
+                }
+
+                // PARTIALLY_BOUND lets the stale descriptor stay in place until the slot is reused
+                _slots[binding].release(index);
+            }
+
+            void bindless_set::write_(
+                enum binding binding
+                , u32 index
+                , VkDescriptorType type
+                , const VkDescriptorImageInfo* image_info
+                , const VkDescriptorBufferInfo* buffer_info
+            ) const noexcept
+            {
+                const VkWriteDescriptorSet write{
+                    .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+                    .dstSet = _set,
+                    .dstBinding = binding,
+                    .dstArrayElement = index,
+                    .descriptorCount = 1,
+                    .descriptorType = type,
+                    .pImageInfo = image_info,
+                    .pBufferInfo = buffer_info,
+                };
+
+                vkUpdateDescriptorSets(_device.lock()->handle(), 1, &write, 0, nullptr);
+            }
+
+            void bindless_set::destroy() noexcept
+            {
+                const VkDevice device = _device.lock()->handle();
+
+                // Destroying the pool frees the set allocated from it
+                if (_pool != VK_NULL_HANDLE)
+                {
+                    vkDestroyDescriptorPool(device, _pool, _allocation_callbacks);
+                    _pool = VK_NULL_HANDLE;
+                    _set = VK_NULL_HANDLE;
+                }
+
+                if (_layout != VK_NULL_HANDLE)
+                {
+                    vkDestroyDescriptorSetLayout(device, _layout, _allocation_callbacks);
+                    _layout = VK_NULL_HANDLE;
+                }
+            }
+
+            ////////////////////////////////////////////////
+            ///            SLOT ALLOCATOR IMPL           ///
+            ////////////////////////////////////////////////
+
+            std::optional<u32> bindless_set::slot_allocator::acquire() noexcept
+            {
+                if (!free.empty())
+                {
+                    const u32 index = free.back();
+                    free.pop_back();
+                    return index;
+                }
+
+                if (next >= capacity)
+                {
+                    return std::nullopt;
+                }
+
+                return next++;
+            }
+
+            void bindless_set::slot_allocator::release(u32 index) noexcept
+            {
+                free.push_back(index);
+            }
+        } // vk namespace
+    } // gfx namespace
+} // blade namespace
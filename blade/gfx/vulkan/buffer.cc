@@ -125,6 +125,45 @@ namespace blade
                 memcpy(data, memory, _size);
                 logger::debug("Mapped {} bytes to vertex buffer", _size);
             }
+
+            const void* buffer::map() noexcept
+            {
+                void* data { nullptr };
+                u32 offset { 0 };
+                VkMemoryMapFlags flags { 0 };
+                if (vkMapMemory(_device.lock()->handle(), _memory, offset, _size, flags, &data) != VK_SUCCESS)
+                {
+                    logger::error("Failed to map buffer memory");
+                    return nullptr;
+                }
+
+                return data;
+            }
+
+            void buffer::unmap() noexcept
+            {
+                vkUnmapMemory(_device.lock()->handle(), _memory);
+            }
+
+            void buffer::invalidate() noexcept
+            {
+                const VkMappedMemoryRange range {
+                    .sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE,
+                    .memory = _memory,
+                    .offset = 0,
+                    .size = VK_WHOLE_SIZE,
+                };
+
+                vkInvalidateMappedMemoryRanges(_device.lock()->handle(), 1, &range);
+            }
+
+            VkMemoryRequirements buffer::memory_requirements() const noexcept
+            {
+                VkMemoryRequirements requirements {};
+                vkGetBufferMemoryRequirements(_device.lock()->handle(), _buffer, &requirements);
+
+                return requirements;
+            }
         }
     } // gfx namespace
 } // blade namespace
@@ -1,4 +1,5 @@
 #include "gfx/vulkan/command.h"
+#include "core/containers/small_vector.h"
 #include <vulkan/vulkan_core.h>
 
 namespace blade
@@ -42,6 +43,26 @@ namespace blade
 
                 return recording::create(*this, begin_info);
             }
+
+            std::optional<command_buffer::recording> command_buffer::begin_secondary(std::weak_ptr<renderpass> rp, VkFramebuffer framebuffer, VkCommandBufferUsageFlags flags) noexcept
+            {
+                const VkCommandBufferInheritanceInfo inheritance_info {
+                    .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO,
+                    .renderPass = rp.lock()->handle(),
+                    .subpass = 0,
+                    .framebuffer = framebuffer,
+                };
+
+                VkCommandBufferBeginInfo begin_info {
+                    .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+                    .flags = flags | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT,
+                    .pInheritanceInfo = &inheritance_info,
+                };
+
+                _is_active = true;
+
+                return recording::create(*this, begin_info);
+            }
             
             ////////////////////////////////////////////////
             ///               RECORDING                 ///
@@ -92,8 +113,9 @@ namespace blade
                     recording& rec
                     , std::weak_ptr<renderpass> rp
                     , VkFramebuffer framebuffer
-                    , const std::vector<VkClearValue>& clear_values
+                    , std::span<const VkClearValue> clear_values
                     , VkRect2D render_area
+                    , VkSubpassContents contents
                     ) noexcept
                 : _recording{ rec }
                 , _renderpass{ rp }
@@ -108,9 +130,16 @@ namespace blade
                         .pClearValues = clear_values.data()
                 };
 
-                vkCmdBeginRenderPass(rec._buffer.handle(), &pass_info, VK_SUBPASS_CONTENTS_INLINE);
+                vkCmdBeginRenderPass(rec._buffer.handle(), &pass_info, contents);
             }
 
+            command_buffer::recording::record_renderpass::record_renderpass(recording& rec, std::weak_ptr<renderpass> rp) noexcept
+                : _recording{ rec }
+                , _renderpass{ rp }
+                , _active{ true }
+                , _inherited{ true }
+            {}
+
             command_buffer::recording::record_renderpass::~record_renderpass() noexcept
             {
                 if (_active)
@@ -122,11 +151,17 @@ namespace blade
                 : _recording{ other._recording }
                 , _renderpass{ other._renderpass }
                 , _active{ other._active }
+                , _inherited{ other._inherited }
             {}
 
-            command_buffer::recording::record_renderpass command_buffer::recording::begin_renderpass(std::weak_ptr<renderpass> rp, VkFramebuffer framebuffer,  const std::vector<VkClearValue>& clear_values, VkRect2D render_area) noexcept
+            command_buffer::recording::record_renderpass command_buffer::recording::begin_renderpass(std::weak_ptr<renderpass> rp, VkFramebuffer framebuffer,  std::span<const VkClearValue> clear_values, VkRect2D render_area, VkSubpassContents contents) noexcept
             {
-                return record_renderpass(*this, rp, framebuffer, clear_values, render_area);
+                return record_renderpass(*this, rp, framebuffer, clear_values, render_area, contents);
+            }
+
+            command_buffer::recording::record_renderpass command_buffer::recording::continue_renderpass(std::weak_ptr<renderpass> rp) noexcept
+            {
+                return record_renderpass(*this, rp);
             }
 
             void command_buffer::recording::record_renderpass::bind_pipeline(VkPipelineBindPoint bind_point, VkPipeline pipeline) const noexcept
@@ -134,6 +169,18 @@ namespace blade
                 vkCmdBindPipeline(_recording._buffer.handle(), bind_point, pipeline);
             }
 
+            void command_buffer::recording::record_renderpass::bind_descriptor_set(VkPipelineBindPoint bind_point, VkPipelineLayout layout, u32 first_set, VkDescriptorSet set) const noexcept
+            {
+                const u32 set_count = 1;
+                const u32 dynamic_offset_count = 0;
+                vkCmdBindDescriptorSets(_recording._buffer.handle(), bind_point, layout, first_set, set_count, &set, dynamic_offset_count, nullptr);
+            }
+
+            void command_buffer::recording::record_renderpass::push_constants(VkPipelineLayout layout, VkShaderStageFlags stages, u32 offset, u32 size, const void* data) const noexcept
+            {
+                vkCmdPushConstants(_recording._buffer.handle(), layout, stages, offset, size, data);
+            }
+
             void command_buffer::recording::record_renderpass::set_viewport(VkViewport viewport) const noexcept
             {
                 const u32 viewport_count = 1;
@@ -163,6 +210,35 @@ namespace blade
                 vkCmdSetScissor(_recording._buffer.handle(), first_scissor, scissor_count, &scissor);
             }
 
+            void command_buffer::recording::record_renderpass::set_dynamic_state(const device::dynamic_state_commands& commands, const struct dynamic_state& state, u32 color_attachment_count) const noexcept
+            {
+                const VkCommandBuffer cb = _recording._buffer.handle();
+
+                if (commands.cmd_set_cull_mode)
+                {
+                    commands.cmd_set_cull_mode(cb, state.cull_mode);
+                    commands.cmd_set_front_face(cb, state.front_face);
+                    commands.cmd_set_primitive_topology(cb, state.topology);
+                    commands.cmd_set_depth_test_enable(cb, state.depth_test);
+                    commands.cmd_set_depth_write_enable(cb, state.depth_write);
+                    commands.cmd_set_depth_compare_op(cb, state.depth_compare);
+                }
+
+                if (commands.cmd_set_primitive_restart_enable)
+                {
+                    commands.cmd_set_primitive_restart_enable(cb, state.primitive_restart);
+                }
+
+                if (commands.cmd_set_polygon_mode)
+                {
+                    const u32 first_attachment = 0;
+                    // Set on every render state change, so the common attachment counts stay off the heap
+                    const core::small_vector<VkBool32, 8> blend(color_attachment_count, state.blend);
+                    commands.cmd_set_polygon_mode(cb, state.polygon_mode);
+                    commands.cmd_set_color_blend_enable(cb, first_attachment, color_attachment_count, blend.data());
+                }
+            }
+
             void command_buffer::recording::record_renderpass::draw(u32 vertex_count, u32 instance_count, u32 first_vertex, u32 first_instance) const noexcept
             {
                 vkCmdDraw(_recording._buffer.handle(), vertex_count, instance_count, first_vertex, first_instance);
@@ -173,6 +249,11 @@ namespace blade
                 vkCmdDrawIndexed(_recording._buffer.handle(), index_count, instance_count, first_index, vertex_offset, first_instance);
             }
 
+            void command_buffer::recording::record_renderpass::execute_commands(std::span<const VkCommandBuffer> buffers) const noexcept
+            {
+                vkCmdExecuteCommands(_recording._buffer.handle(), static_cast<u32>(buffers.size()), buffers.data());
+            }
+
             bool command_buffer::recording::record_renderpass::end() noexcept
             {
                 if (!_active)
@@ -181,7 +262,11 @@ namespace blade
                     return false;
                 }
 
-                vkCmdEndRenderPass(_recording._buffer.handle());
+                // The primary buffer that began the pass also ends it
+                if (!_inherited)
+                {
+                    vkCmdEndRenderPass(_recording._buffer.handle());
+                }
                 _active = false;
 
                 return true;
@@ -215,6 +300,87 @@ namespace blade
                 vkCmdCopyBuffer(_recording._buffer.handle(), src, dst, region_count, &copy_region);
             }
 
+            void command_buffer::recording::record_transfer::copy_image_to_buffer(VkImage src, VkImageLayout layout, VkBuffer dst, VkExtent2D extent) const noexcept
+            {
+                constexpr u32 region_count { 1 };
+                VkBufferImageCopy copy_region {
+                    .bufferOffset = 0,
+                    .bufferRowLength = 0,
+                    .bufferImageHeight = 0,
+                    .imageSubresource = {
+                        .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+                        .mipLevel = 0,
+                        .baseArrayLayer = 0,
+                        .layerCount = 1,
+                    },
+                    .imageOffset = { 0, 0, 0 },
+                    .imageExtent = { extent.width, extent.height, 1 },
+                };
+
+                vkCmdCopyImageToBuffer(_recording._buffer.handle(), src, layout, dst, region_count, &copy_region);
+
+                // Make the copy available to the host once the submission's fence signals
+                const VkBufferMemoryBarrier host_barrier {
+                    .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+                    .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+                    .dstAccessMask = VK_ACCESS_HOST_READ_BIT,
+                    .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                    .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                    .buffer = dst,
+                    .offset = 0,
+                    .size = VK_WHOLE_SIZE,
+                };
+
+                vkCmdPipelineBarrier(
+                    _recording._buffer.handle()
+                    , VK_PIPELINE_STAGE_TRANSFER_BIT
+                    , VK_PIPELINE_STAGE_HOST_BIT
+                    , 0
+                    , 0, nullptr
+                    , 1, &host_barrier
+                    , 0, nullptr
+                );
+            }
+
+            void command_buffer::recording::record_transfer::transition_image(
+                VkImage image
+                , VkImageLayout from
+                , VkImageLayout to
+                , VkPipelineStageFlags src_stage
+                , VkAccessFlags src_access
+                , VkPipelineStageFlags dst_stage
+                , VkAccessFlags dst_access
+            ) const noexcept
+            {
+                const VkImageMemoryBarrier barrier {
+                    .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+                    .srcAccessMask = src_access,
+                    .dstAccessMask = dst_access,
+                    .oldLayout = from,
+                    .newLayout = to,
+                    .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                    .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                    .image = image,
+                    .subresourceRange = {
+                        .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+                        .baseMipLevel = 0,
+                        .levelCount = 1,
+                        .baseArrayLayer = 0,
+                        .layerCount = 1,
+                    },
+                };
+
+                vkCmdPipelineBarrier(
+                    _recording._buffer.handle()
+                    , src_stage
+                    , dst_stage
+                    , 0
+                    , 0, nullptr
+                    , 0, nullptr
+                    , 1, &barrier
+                );
+            }
+
             bool command_buffer::recording::record_transfer::end() noexcept
             {
                 return false;
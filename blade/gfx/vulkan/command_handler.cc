@@ -1,4 +1,6 @@
 #include "gfx/vulkan/command_handler.h"
+#include "gfx/vulkan/submit_batch.h"
+#include <algorithm>
 #include <vulkan/vulkan_core.h>
 
 namespace blade
@@ -7,13 +9,14 @@ namespace blade
     {
         namespace vk
         {
-            command_handler::command_handler(std::weak_ptr<class device> device, const queue_type queue) noexcept
+            command_handler::command_handler(std::weak_ptr<class device> device, const queue_type queue, VkAllocationCallbacks* callbacks) noexcept
                 : _device{device}
+                , _allocation_callbacks{callbacks}
             {
                 constexpr u32 num_buffers = 16;
 
                 auto const transfer_pool_opt = command_pool::builder(device)
-                                               .use_allocation_callbacks(nullptr)
+                                               .use_allocation_callbacks(callbacks)
                                                .set_queue_family_index(
                                                    device.lock()->get_queue_index(queue).value())
                                                .build();
@@ -23,10 +26,9 @@ namespace blade
                 for (VkCommandBuffer buffer : _all_command_buffers)
                 {
                     VkFence fence = create_fence_().value();
-                    auto node = std::make_unique<buffer_free_list::node>(
-                        buffer, fence);
-                    _free_list.push_front(node.get());
-                    _all_buffer_nodes.push_back(std::move(node));
+                    auto* node = _node_pool.create(buffer, fence);
+                    _free_list.push_front(node);
+                    _all_buffer_nodes.push_back(node);
                 }
             }
 
@@ -48,6 +50,19 @@ namespace blade
                 return node->command_buffer;
             }
 
+            void command_handler::release_command_buffer(VkCommandBuffer buffer) noexcept
+            {
+                auto buffer_it = _active_nodes.find(buffer);
+                if (buffer_it == _active_nodes.end() || buffer_it->second->is_submitted)
+                {
+                    return;
+                }
+
+                // Its fence was never reset, so it is still signaled for the next acquire
+                _free_list.push_front(buffer_it->second);
+                _active_nodes.erase(buffer_it);
+            }
+
             void command_handler::update() noexcept
             {
                 process_completed_buffers_();
@@ -62,8 +77,7 @@ namespace blade
                 };
                 VkFence fence{};
 
-                VkAllocationCallbacks* callbacks{nullptr};
-                const VkResult result = vkCreateFence(_device.lock()->handle(), &fence_info, callbacks, &fence);
+                const VkResult result = vkCreateFence(_device.lock()->handle(), &fence_info, _allocation_callbacks, &fence);
                 if (result != VK_SUCCESS)
                 {
                     return std::nullopt;
@@ -103,11 +117,77 @@ namespace blade
 
                 vkResetFences(_device.lock()->handle(), 1, &node->fence);
                 const VkResult submit_result = vkQueueSubmit(queue, 1, &submit_info, buffer_it->second->fence);
+                node->batch_serial = 0;
                 node->is_submitted = true;
+                node->serial = ++_submitted_serial;
 
                 return submit_result;
             }
 
+            u64 command_handler::mark_submitted(VkCommandBuffer buffer, class submit_batch* batch, u64 batch_serial) noexcept
+            {
+                auto buffer_it = _active_nodes.find(buffer);
+                if (buffer_it == _active_nodes.end())
+                {
+                    return _submitted_serial;
+                }
+
+                // A failed batch leaves the buffer's own fence signaled from its last use, so it counts as done
+                buffer_free_list::node* node = buffer_it->second;
+                node->batch_serial = batch != nullptr ? batch_serial : 0;
+                node->is_submitted = true;
+                node->serial = ++_submitted_serial;
+
+                if (batch != nullptr)
+                {
+                    _batch = batch;
+                }
+
+                return node->serial;
+            }
+
+            bool command_handler::is_complete_(const buffer_free_list::node& node) const noexcept
+            {
+                if (node.batch_serial != 0)
+                {
+                    return _batch->completed_serial() >= node.batch_serial;
+                }
+
+                return vkGetFenceStatus(_device.lock()->handle(), node.fence) == VK_SUCCESS;
+            }
+
+            u64 command_handler::completed_serial() const noexcept
+            {
+                u64 completed = _submitted_serial;
+                for (const auto& [buffer, node] : _active_nodes)
+                {
+                    if (node->is_submitted && node->serial <= completed)
+                    {
+                        completed = node->serial - 1;
+                    }
+                }
+
+                return completed;
+            }
+
+            bool command_handler::wait_for_serial(u64 serial, u64 timeout) const noexcept
+            {
+                for (const auto& [buffer, node] : _active_nodes)
+                {
+                    if (node->is_submitted && node->serial == serial)
+                    {
+                        if (node->batch_serial != 0)
+                        {
+                            return _batch->wait_for_serial(node->batch_serial, timeout);
+                        }
+
+                        return vkWaitForFences(_device.lock()->handle(), 1, &node->fence, VK_TRUE, timeout) == VK_SUCCESS;
+                    }
+                }
+
+                // Nodes are only recycled once their fence has signaled
+                return true;
+            }
 
             void command_handler::process_completed_buffers_() noexcept
             {
@@ -117,12 +197,7 @@ namespace blade
                     buffer_free_list::node* node = it->second;
                     if (node->is_submitted)
                     {
-                        const VkResult fence_result = vkGetFenceStatus(
-                            _device.lock()->handle()
-                            , node->fence
-                        );
-
-                        if (fence_result == VK_SUCCESS)
+                        if (is_complete_(*node))
                         {
                             _free_list.push_front(node);
                             it = _active_nodes.erase(it);
@@ -165,11 +240,10 @@ namespace blade
 
             void command_handler::destroy() const noexcept
             {
-                const VkAllocationCallbacks* callbacks{nullptr};
                 logger::info("TOTAL BUFFERS: {}", _all_buffer_nodes.size());
                 for (const auto& node : _all_buffer_nodes)
                 {
-                    vkDestroyFence(_device.lock()->handle(), node->fence, callbacks);
+                    vkDestroyFence(_device.lock()->handle(), node->fence, _allocation_callbacks);
                 }
                 vkFreeCommandBuffers(_device.lock()->handle(), _command_pool->handle(), _all_command_buffers.size(),
                                      _all_command_buffers.data());
@@ -178,6 +252,110 @@ namespace blade
             }
 
 
+            ////////////////////////////////////////////////
+            ///          THREAD COMMAND POOLS            ///
+            ////////////////////////////////////////////////
+
+            thread_command_pools::thread_command_pools(std::weak_ptr<class device> device, const queue_type queue, u32 thread_count, VkAllocationCallbacks* callbacks) noexcept
+                : _device{device}
+                , _allocation_callbacks{callbacks}
+                , _queue_family_index{device.lock()->get_queue_index(queue).value()}
+                , _pools(std::max(thread_count, 1u))
+            {
+            }
+
+            VkCommandBuffer thread_command_pools::acquire_secondary(u32 thread) noexcept
+            {
+                if (thread >= _pools.size())
+                {
+                    return VK_NULL_HANDLE;
+                }
+
+                thread_pool& pool = _pools[thread];
+
+                // Pools are created by the first thread that records with them, so unused workers cost nothing
+                if (!pool.pool)
+                {
+                    auto pool_opt = command_pool::builder(_device)
+                                    .use_allocation_callbacks(_allocation_callbacks)
+                                    .set_queue_family_index(_queue_family_index)
+                                    .build();
+                    if (!pool_opt.has_value())
+                    {
+                        logger::error("Failed to create command pool for recording thread {}", thread);
+                        return VK_NULL_HANDLE;
+                    }
+
+                    pool.pool = pool_opt.value();
+                }
+
+                if (pool.free.empty())
+                {
+                    constexpr u32 grow_by = 4;
+                    pool.free = pool.pool->allocate_buffers(grow_by, VK_COMMAND_BUFFER_LEVEL_SECONDARY);
+                    if (pool.free.empty())
+                    {
+                        logger::error("Failed to allocate secondary command buffers for recording thread {}", thread);
+                        return VK_NULL_HANDLE;
+                    }
+                }
+
+                const VkCommandBuffer buffer = pool.free.back();
+                pool.free.pop_back();
+                vkResetCommandBuffer(buffer, 0);
+                pool.pending.emplace_back(0, buffer);
+
+                return buffer;
+            }
+
+            void thread_command_pools::submit(u64 serial) noexcept
+            {
+                for (auto&& pool : _pools)
+                {
+                    for (auto&& [buffer_serial, buffer] : pool.pending)
+                    {
+                        if (buffer_serial == 0)
+                        {
+                            buffer_serial = serial;
+                        }
+                    }
+                }
+            }
+
+            void thread_command_pools::release(u64 completed_serial) noexcept
+            {
+                for (auto&& pool : _pools)
+                {
+                    auto it = pool.pending.begin();
+                    while (it != pool.pending.end())
+                    {
+                        if (it->first != 0 && it->first <= completed_serial)
+                        {
+                            pool.free.push_back(it->second);
+                            it = pool.pending.erase(it);
+                            continue;
+                        }
+
+                        ++it;
+                    }
+                }
+            }
+
+            void thread_command_pools::destroy() noexcept
+            {
+                // Destroying a pool frees every buffer allocated from it
+                for (auto&& pool : _pools)
+                {
+                    if (pool.pool)
+                    {
+                        pool.pool->destroy();
+                        pool.pool = nullptr;
+                    }
+                    pool.free.clear();
+                    pool.pending.clear();
+                }
+            }
+
             ////////////////////////////////////////////////
             ///             FREE LIST IMPL               ///
             ////////////////////////////////////////////////
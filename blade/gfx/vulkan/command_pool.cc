@@ -87,12 +87,12 @@ namespace blade
             }
 
 
-            std::vector<VkCommandBuffer> command_pool::allocate_buffers(const u32 num_buffers) noexcept
+            std::vector<VkCommandBuffer> command_pool::allocate_buffers(const u32 num_buffers, VkCommandBufferLevel level) noexcept
             {
                 VkCommandBufferAllocateInfo alloc_info{
                     .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
                     .commandPool = _command_pool,
-                    .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+                    .level = level,
                     .commandBufferCount = num_buffers
                 };
 
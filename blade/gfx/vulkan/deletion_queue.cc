@@ -0,0 +1,37 @@
+#include "gfx/vulkan/deletion_queue.h"
+#include <utility>
+
+namespace blade
+{
+    namespace gfx
+    {
+        namespace vk
+        {
+            void deletion_queue::push(u64 serial, std::function<void()> deleter) noexcept
+            {
+                _entries.push_back(entry{
+                    .serial = serial,
+                    .deleter = std::move(deleter),
+                });
+            }
+
+            void deletion_queue::collect(u64 completed_serial) noexcept
+            {
+                while (!_entries.empty() && _entries.front().serial <= completed_serial)
+                {
+                    _entries.front().deleter();
+                    _entries.pop_front();
+                }
+            }
+
+            void deletion_queue::flush() noexcept
+            {
+                for (auto& entry : _entries)
+                {
+                    entry.deleter();
+                }
+                _entries.clear();
+            }
+        } // vk namespace
+    } // gfx namespace
+} // blade namespace
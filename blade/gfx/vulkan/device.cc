@@ -32,12 +32,132 @@ namespace blade
                 // device device (std::move(valid_devices[0]));
                 std::vector<VkDeviceQueueCreateInfo> queue_infos = device->_physical_device->get_queue_family_infos();
 
+                // Optional features are chained through pNext and only enabled when the device supports them
+                VkPhysicalDeviceVulkan12Features vulkan12_features{};
+                vulkan12_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+
+                if (info.request_descriptor_indexing)
+                {
+                    if (device->_physical_device->supports_descriptor_indexing())
+                    {
+                        vulkan12_features.descriptorIndexing = VK_TRUE;
+                        vulkan12_features.runtimeDescriptorArray = VK_TRUE;
+                        vulkan12_features.descriptorBindingPartiallyBound = VK_TRUE;
+                        vulkan12_features.descriptorBindingUpdateUnusedWhilePending = VK_TRUE;
+                        vulkan12_features.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+                        vulkan12_features.descriptorBindingStorageBufferUpdateAfterBind = VK_TRUE;
+                        vulkan12_features.shaderSampledImageArrayNonUniformIndexing = VK_TRUE;
+                        vulkan12_features.shaderStorageBufferArrayNonUniformIndexing = VK_TRUE;
+                        device->_enabled_features.descriptor_indexing = true;
+                    }
+                    else
+                    {
+                        logger::warn("Physical Device {} does not support descriptor indexing. Bindless disabled.",
+                                     device->_physical_device->name());
+                    }
+                }
+
+                std::vector<const char*> extensions = info.required_extensions;
+                void** next = &vulkan12_features.pNext;
+
+                VkPhysicalDeviceExtendedDynamicStateFeaturesEXT extended_dynamic_state_features{};
+                extended_dynamic_state_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTENDED_DYNAMIC_STATE_FEATURES_EXT;
+                VkPhysicalDeviceExtendedDynamicState2FeaturesEXT extended_dynamic_state2_features{};
+                extended_dynamic_state2_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTENDED_DYNAMIC_STATE_2_FEATURES_EXT;
+                VkPhysicalDeviceExtendedDynamicState3FeaturesEXT extended_dynamic_state3_features{};
+                extended_dynamic_state3_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTENDED_DYNAMIC_STATE_3_FEATURES_EXT;
+
+                if (info.request_extended_dynamic_state)
+                {
+                    if (device->_physical_device->supports_extended_dynamic_state())
+                    {
+                        extended_dynamic_state_features.extendedDynamicState = VK_TRUE;
+                        extensions.push_back(VK_EXT_EXTENDED_DYNAMIC_STATE_EXTENSION_NAME);
+                        *next = &extended_dynamic_state_features;
+                        next = &extended_dynamic_state_features.pNext;
+                        device->_enabled_features.extended_dynamic_state = true;
+                    }
+
+                    if (device->_physical_device->supports_extended_dynamic_state2())
+                    {
+                        extended_dynamic_state2_features.extendedDynamicState2 = VK_TRUE;
+                        extensions.push_back(VK_EXT_EXTENDED_DYNAMIC_STATE_2_EXTENSION_NAME);
+                        *next = &extended_dynamic_state2_features;
+                        next = &extended_dynamic_state2_features.pNext;
+                        device->_enabled_features.extended_dynamic_state2 = true;
+                    }
+
+                    if (device->_physical_device->supports_extended_dynamic_state3())
+                    {
+                        extended_dynamic_state3_features.extendedDynamicState3PolygonMode = VK_TRUE;
+                        extended_dynamic_state3_features.extendedDynamicState3ColorBlendEnable = VK_TRUE;
+                        extensions.push_back(VK_EXT_EXTENDED_DYNAMIC_STATE_3_EXTENSION_NAME);
+                        *next = &extended_dynamic_state3_features;
+                        next = &extended_dynamic_state3_features.pNext;
+                        device->_enabled_features.extended_dynamic_state3 = true;
+                    }
+
+                    logger::info("Extended dynamic state on {}: 1 [{}] 2 [{}] 3 [{}]",
+                                 device->_physical_device->name(),
+                                 device->_enabled_features.extended_dynamic_state,
+                                 device->_enabled_features.extended_dynamic_state2,
+                                 device->_enabled_features.extended_dynamic_state3);
+                }
+
+                VkPhysicalDeviceGraphicsPipelineLibraryFeaturesEXT graphics_pipeline_library_features{};
+                graphics_pipeline_library_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_FEATURES_EXT;
+
+                if (info.request_graphics_pipeline_library)
+                {
+                    if (device->_physical_device->supports_graphics_pipeline_library())
+                    {
+                        graphics_pipeline_library_features.graphicsPipelineLibrary = VK_TRUE;
+                        extensions.push_back(VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME);
+                        extensions.push_back(VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME);
+                        *next = &graphics_pipeline_library_features;
+                        next = &graphics_pipeline_library_features.pNext;
+                        device->_enabled_features.graphics_pipeline_library = true;
+                    }
+                    else
+                    {
+                        logger::info("Physical Device {} has no fast-linking pipeline libraries. Using monolithic pipelines.",
+                                     device->_physical_device->name());
+                    }
+                }
+
+                VkPhysicalDevicePresentIdFeaturesKHR present_id_features{};
+                present_id_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_ID_FEATURES_KHR;
+                VkPhysicalDevicePresentWaitFeaturesKHR present_wait_features{};
+                present_wait_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_WAIT_FEATURES_KHR;
+
+                if (info.request_present_wait)
+                {
+                    if (device->_physical_device->supports_present_wait())
+                    {
+                        present_id_features.presentId = VK_TRUE;
+                        present_wait_features.presentWait = VK_TRUE;
+                        extensions.push_back(VK_KHR_PRESENT_ID_EXTENSION_NAME);
+                        extensions.push_back(VK_KHR_PRESENT_WAIT_EXTENSION_NAME);
+                        *next = &present_id_features;
+                        next = &present_id_features.pNext;
+                        *next = &present_wait_features;
+                        next = &present_wait_features.pNext;
+                        device->_enabled_features.present_wait = true;
+                    }
+                    else
+                    {
+                        logger::info("Physical Device {} cannot wait on presents. Pacing frames from GPU completion instead.",
+                                     device->_physical_device->name());
+                    }
+                }
+
                 VkDeviceCreateInfo create_info{
                     .sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO,
+                    .pNext = &vulkan12_features,
                     .queueCreateInfoCount = static_cast<u32>(queue_infos.size()),
                     .pQueueCreateInfos = queue_infos.data(),
-                    .enabledExtensionCount = static_cast<u32>(info.required_extensions.size()),
-                    .ppEnabledExtensionNames = info.required_extensions.data(),
+                    .enabledExtensionCount = static_cast<u32>(extensions.size()),
+                    .ppEnabledExtensionNames = extensions.data(),
                     .pEnabledFeatures = device->_physical_device->get_features_ptr()
                 };
 
@@ -53,9 +173,46 @@ namespace blade
                     return std::nullopt;
                 }
 
+                device->_allocation_callbacks = info.allocation_callbacks;
+                device->load_dynamic_state_commands_();
+
+                if (device->_enabled_features.present_wait)
+                {
+                    device->_wait_for_present = reinterpret_cast<PFN_vkWaitForPresentKHR>(
+                        vkGetDeviceProcAddr(device->_logical_device, "vkWaitForPresentKHR"));
+                }
+
                 return std::move(device);
             }
 
+            void device::load_dynamic_state_commands_() noexcept
+            {
+                const auto load = [this]<typename F>(F& function, const char* name) {
+                    function = reinterpret_cast<F>(vkGetDeviceProcAddr(_logical_device, name));
+                };
+
+                if (_enabled_features.extended_dynamic_state)
+                {
+                    load(_dynamic_state_commands.cmd_set_cull_mode, "vkCmdSetCullModeEXT");
+                    load(_dynamic_state_commands.cmd_set_front_face, "vkCmdSetFrontFaceEXT");
+                    load(_dynamic_state_commands.cmd_set_primitive_topology, "vkCmdSetPrimitiveTopologyEXT");
+                    load(_dynamic_state_commands.cmd_set_depth_test_enable, "vkCmdSetDepthTestEnableEXT");
+                    load(_dynamic_state_commands.cmd_set_depth_write_enable, "vkCmdSetDepthWriteEnableEXT");
+                    load(_dynamic_state_commands.cmd_set_depth_compare_op, "vkCmdSetDepthCompareOpEXT");
+                }
+
+                if (_enabled_features.extended_dynamic_state2)
+                {
+                    load(_dynamic_state_commands.cmd_set_primitive_restart_enable, "vkCmdSetPrimitiveRestartEnableEXT");
+                }
+
+                if (_enabled_features.extended_dynamic_state3)
+                {
+                    load(_dynamic_state_commands.cmd_set_polygon_mode, "vkCmdSetPolygonModeEXT");
+                    load(_dynamic_state_commands.cmd_set_color_blend_enable, "vkCmdSetColorBlendEnableEXT");
+                }
+            }
+
             device::builder& device::builder::set_allocation_callbacks(VkAllocationCallbacks* callbacks) noexcept
             {
                 info.allocation_callbacks = callbacks;
@@ -84,6 +241,30 @@ namespace blade
                 return *this;
             }
 
+            device::builder& device::builder::request_descriptor_indexing(bool enabled) noexcept
+            {
+                info.request_descriptor_indexing = enabled;
+                return *this;
+            }
+
+            device::builder& device::builder::request_extended_dynamic_state(bool enabled) noexcept
+            {
+                info.request_extended_dynamic_state = enabled;
+                return *this;
+            }
+
+            device::builder& device::builder::request_present_wait(bool enabled) noexcept
+            {
+                info.request_present_wait = enabled;
+                return *this;
+            }
+
+            device::builder& device::builder::request_graphics_pipeline_library(bool enabled) noexcept
+            {
+                info.request_graphics_pipeline_library = enabled;
+                return *this;
+            }
+
             device::builder& device::builder::require_extension(const char* extension_name) noexcept
             {
                 if (extension_name != nullptr)
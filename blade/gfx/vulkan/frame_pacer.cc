@@ -0,0 +1,97 @@
+#include "gfx/vulkan/frame_pacer.h"
+#include "core/fibers.h"
+#include <algorithm>
+#include <thread>
+
+namespace blade
+{
+    namespace gfx
+    {
+        namespace vk
+        {
+            void frame_pacer::set_max_frame_rate(f32 max_frame_rate) noexcept
+            {
+                _min_frame_time = max_frame_rate > 0.f
+                    ? std::chrono::duration_cast<clock::duration>(std::chrono::duration<f64>(1.0 / max_frame_rate))
+                    : clock::duration::zero();
+            }
+
+            void frame_pacer::set_low_latency(bool enabled) noexcept
+            {
+                if (_low_latency != enabled)
+                {
+                    reset();
+                }
+
+                _low_latency = enabled;
+            }
+
+            void frame_pacer::frame_completed(clock::time_point time) noexcept
+            {
+                if (_last_completion != clock::time_point{} && time > _last_completion)
+                {
+                    const f64 interval = std::chrono::duration<f64>(time - _last_completion).count();
+                    _completion_interval = _completion_interval == 0.0
+                        ? interval
+                        : _completion_interval + smoothing * (interval - _completion_interval);
+                }
+
+                _last_completion = time;
+            }
+
+            void frame_pacer::wait_for_frame_start() noexcept
+            {
+                clock::time_point start = clock::now();
+
+                if (_min_frame_time != clock::duration::zero() && _frame_start != clock::time_point{})
+                {
+                    start = std::max(start, _frame_start + _min_frame_time);
+                }
+
+                // The frame in flight should finish one interval after the last one. Starting this frame's
+                // recording its CPU time before that lands the submission just as the GPU goes idle
+                if (_low_latency && _completion_interval > 0.0 && _last_completion != clock::time_point{})
+                {
+                    const auto lead = std::chrono::duration<f64>(_completion_interval - _cpu_frame_time);
+                    const auto ready = _last_completion
+                        + std::chrono::duration_cast<clock::duration>(lead)
+                        - slack;
+                    start = std::max(start, ready);
+                }
+
+                // Views are recorded as fiber tasks, where sleeping would hold the worker from every other job
+                const clock::time_point now = clock::now();
+                if (start > now && core::fibers::in_fiber())
+                {
+                    (void)core::fibers::shared().poll([start]() { return clock::now() >= start; }, start - now);
+                }
+                else if (start > now)
+                {
+                    std::this_thread::sleep_until(start);
+                }
+
+                _frame_start = clock::now();
+            }
+
+            void frame_pacer::frame_submitted() noexcept
+            {
+                if (_frame_start == clock::time_point{})
+                {
+                    return;
+                }
+
+                const f64 cpu_time = std::chrono::duration<f64>(clock::now() - _frame_start).count();
+                _cpu_frame_time = _cpu_frame_time == 0.0
+                    ? cpu_time
+                    : _cpu_frame_time + smoothing * (cpu_time - _cpu_frame_time);
+            }
+
+            void frame_pacer::reset() noexcept
+            {
+                _last_completion = {};
+                _completion_interval = 0.0;
+                _cpu_frame_time = 0.0;
+            }
+        } // vk namespace
+    } // gfx namespace
+} // blade namespace
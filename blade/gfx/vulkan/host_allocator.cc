@@ -0,0 +1,238 @@
+#include "gfx/vulkan/host_allocator.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace blade
+{
+    namespace gfx
+    {
+        namespace vk
+        {
+            namespace
+            {
+                struct command_arena;
+
+                /// @brief Stored right before every pointer handed to the driver
+                struct allocation_header
+                {
+                    usize size { 0 };
+                    /// @brief Arena the block came from, or `nullptr` if it came from the source allocator
+                    command_arena* arena { nullptr };
+                    u32 offset { 0 };
+                    u8 scope { 0 };
+                };
+
+                allocation_header* header_of(void* memory) noexcept
+                {
+                    return reinterpret_cast<allocation_header*>(static_cast<std::byte*>(memory) - sizeof(allocation_header));
+                }
+
+                /**
+                 * @brief Linear arena for command-scope allocations of one thread
+                 *
+                 * A Vulkan call frees its command-scope memory before it returns, so the arena rewinds as soon as
+                 * nothing in it is live. Drivers may free on another thread than the one that allocated, so blocks
+                 * are released through the arena recorded in their header, and only the owning thread rewinds.
+                 */
+                struct command_arena
+                {
+                    ~command_arena() noexcept
+                    {
+                        core::allocator::heap().deallocate(data);
+                    }
+
+                    [[nodiscard]] std::byte* allocate(usize size, usize alignment) noexcept
+                    {
+                        if (data == nullptr)
+                        {
+                            data = static_cast<std::byte*>(core::allocator::heap().allocate(
+                                host_allocator::command_arena_size, alignof(std::max_align_t), core::memory_tag::driver));
+                            if (data == nullptr)
+                            {
+                                return nullptr;
+                            }
+                        }
+
+                        if (live.load(std::memory_order_acquire) == 0)
+                        {
+                            offset = 0;
+                        }
+
+                        const auto base = reinterpret_cast<std::uintptr_t>(data);
+                        const std::uintptr_t aligned = (base + offset + alignment - 1) & ~(static_cast<std::uintptr_t>(alignment) - 1);
+                        const usize end = static_cast<usize>(aligned - base) + size;
+                        if (end > host_allocator::command_arena_size)
+                        {
+                            return nullptr;
+                        }
+
+                        offset = end;
+                        live.fetch_add(1, std::memory_order_relaxed);
+                        return reinterpret_cast<std::byte*>(aligned);
+                    }
+
+                    /// @brief Any thread. The owner rewinds on its next allocation once nothing is live
+                    void release() noexcept
+                    {
+                        live.fetch_sub(1, std::memory_order_release);
+                    }
+
+                    std::byte* data { nullptr };
+                    usize offset { 0 };
+                    std::atomic<u32> live { 0 };
+                };
+
+                thread_local command_arena local_command_arena{};
+            } // anonymous namespace
+
+            host_allocator::host_allocator(core::allocator& source) noexcept
+                : _source { source }
+                , _callbacks {
+                    .pUserData = this,
+                    .pfnAllocation = &host_allocator::allocate_,
+                    .pfnReallocation = &host_allocator::reallocate_,
+                    .pfnFree = &host_allocator::free_,
+                    .pfnInternalAllocation = &host_allocator::internal_allocation_,
+                    .pfnInternalFree = &host_allocator::internal_free_,
+                }
+            {}
+
+            core::memory_stats host_allocator::stats(VkSystemAllocationScope scope) const noexcept
+            {
+                const scope_counters& counters = _scopes[static_cast<usize>(scope)];
+                return core::memory_stats{
+                    .live_bytes = counters.live_bytes.load(std::memory_order_relaxed),
+                    .peak_bytes = counters.peak_bytes.load(std::memory_order_relaxed),
+                    .count = counters.count.load(std::memory_order_relaxed),
+                };
+            }
+
+            void* host_allocator::allocate_(void* user_data, size_t size, size_t alignment, VkSystemAllocationScope scope)
+            {
+                return static_cast<host_allocator*>(user_data)->allocate_memory_(size, alignment, scope);
+            }
+
+            void* host_allocator::reallocate_(void* user_data, void* original, size_t size, size_t alignment, VkSystemAllocationScope scope)
+            {
+                auto* allocator = static_cast<host_allocator*>(user_data);
+                if (original == nullptr)
+                {
+                    return allocator->allocate_memory_(size, alignment, scope);
+                }
+
+                if (size == 0)
+                {
+                    allocator->free_memory_(original);
+                    return nullptr;
+                }
+
+                // On failure the original must stay untouched, so it is only freed once the copy exists
+                void* reallocated = allocator->allocate_memory_(size, alignment, scope);
+                if (reallocated != nullptr)
+                {
+                    std::memcpy(reallocated, original, std::min(size, header_of(original)->size));
+                    allocator->free_memory_(original);
+                }
+
+                return reallocated;
+            }
+
+            void host_allocator::free_(void* user_data, void* memory)
+            {
+                static_cast<host_allocator*>(user_data)->free_memory_(memory);
+            }
+
+            void host_allocator::internal_allocation_(void* user_data, size_t size, VkInternalAllocationType, VkSystemAllocationScope scope)
+            {
+                static_cast<host_allocator*>(user_data)->count_allocation_(scope, size);
+            }
+
+            void host_allocator::internal_free_(void* user_data, size_t size, VkInternalAllocationType, VkSystemAllocationScope scope)
+            {
+                static_cast<host_allocator*>(user_data)->count_free_(scope, size);
+            }
+
+            void* host_allocator::allocate_memory_(usize size, usize alignment, VkSystemAllocationScope scope) noexcept
+            {
+                if (size == 0)
+                {
+                    return nullptr;
+                }
+
+                // The header sits in a prefix padded to the alignment, so the returned pointer stays aligned
+                alignment = std::max(alignment, alignof(allocation_header));
+                const usize prefix = (sizeof(allocation_header) + alignment - 1) & ~(alignment - 1);
+
+                std::byte* base = nullptr;
+                command_arena* arena = nullptr;
+                if (scope == VK_SYSTEM_ALLOCATION_SCOPE_COMMAND)
+                {
+                    base = local_command_arena.allocate(prefix + size, alignment);
+                    arena = base != nullptr ? &local_command_arena : nullptr;
+                }
+
+                if (base == nullptr)
+                {
+                    base = static_cast<std::byte*>(_source.allocate(prefix + size, alignment, core::memory_tag::driver));
+                    if (base == nullptr)
+                    {
+                        return nullptr;
+                    }
+                }
+
+                std::byte* memory = base + prefix;
+                *header_of(memory) = allocation_header{
+                    .size = size,
+                    .arena = arena,
+                    .offset = static_cast<u32>(prefix),
+                    .scope = static_cast<u8>(scope),
+                };
+
+                count_allocation_(scope, size);
+                return memory;
+            }
+
+            void host_allocator::free_memory_(void* memory) noexcept
+            {
+                if (memory == nullptr)
+                {
+                    return;
+                }
+
+                const allocation_header header = *header_of(memory);
+                count_free_(static_cast<VkSystemAllocationScope>(header.scope), header.size);
+
+                if (header.arena != nullptr)
+                {
+                    header.arena->release();
+                    return;
+                }
+
+                _source.deallocate(static_cast<std::byte*>(memory) - header.offset);
+            }
+
+            void host_allocator::count_allocation_(VkSystemAllocationScope scope, usize size) noexcept
+            {
+                scope_counters& counters = _scopes[static_cast<usize>(scope)];
+                counters.count.fetch_add(1, std::memory_order_relaxed);
+                const usize live = counters.live_bytes.fetch_add(size, std::memory_order_relaxed) + size;
+
+                usize peak = counters.peak_bytes.load(std::memory_order_relaxed);
+                while (live > peak && !counters.peak_bytes.compare_exchange_weak(peak, live, std::memory_order_relaxed))
+                {
+                }
+            }
+
+            void host_allocator::count_free_(VkSystemAllocationScope scope, usize size) noexcept
+            {
+                scope_counters& counters = _scopes[static_cast<usize>(scope)];
+                counters.count.fetch_sub(1, std::memory_order_relaxed);
+                counters.live_bytes.fetch_sub(size, std::memory_order_relaxed);
+            }
+        } // vk namespace
+    } // gfx namespace
+} // blade namespace
@@ -0,0 +1,176 @@
+#include "gfx/vulkan/image.h"
+#include "gfx/vulkan/utils.h"
+#include <vulkan/vulkan_core.h>
+
+namespace blade
+{
+    namespace gfx
+    {
+        namespace vk
+        {
+            namespace
+            {
+                VkImageAspectFlags aspect_of(const VkFormat format) noexcept
+                {
+                    switch (format)
+                    {
+                        case VK_FORMAT_D16_UNORM:
+                        case VK_FORMAT_X8_D24_UNORM_PACK32:
+                        case VK_FORMAT_D32_SFLOAT:
+                            return VK_IMAGE_ASPECT_DEPTH_BIT;
+                        case VK_FORMAT_D16_UNORM_S8_UINT:
+                        case VK_FORMAT_D24_UNORM_S8_UINT:
+                        case VK_FORMAT_D32_SFLOAT_S8_UINT:
+                            return VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT;
+                        default:
+                            return VK_IMAGE_ASPECT_COLOR_BIT;
+                    }
+                }
+            } // anonymous namespace
+
+            std::optional<std::shared_ptr<image>> image::builder::build() const noexcept
+            {
+                auto device = info.device.lock();
+                auto image = std::make_shared<class image>(info.device, info.allocation_callbacks);
+                image->_format = info.format;
+                image->_extent = info.extent;
+
+                const VkImageCreateInfo image_info{
+                    .sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+                    .imageType = VK_IMAGE_TYPE_2D,
+                    .format = info.format,
+                    .extent = { info.extent.width, info.extent.height, 1 },
+                    .mipLevels = 1,
+                    .arrayLayers = 1,
+                    .samples = VK_SAMPLE_COUNT_1_BIT,
+                    .tiling = VK_IMAGE_TILING_OPTIMAL,
+                    .usage = info.usage,
+                    .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+                    .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+                };
+
+                VkResult result = vkCreateImage(device->handle(), &image_info, info.allocation_callbacks, &image->_image);
+                if (result != VK_SUCCESS)
+                {
+                    logger::error("Failed to create image: {}", error_string(result));
+                    return std::nullopt;
+                }
+
+                VkMemoryRequirements requirements{};
+                vkGetImageMemoryRequirements(device->handle(), image->_image, &requirements);
+
+                const auto memory_type = device->get_physical_device().lock()->find_memory_type(
+                    requirements.memoryTypeBits
+                    , VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
+                );
+
+                if (!memory_type.has_value())
+                {
+                    logger::error("No device local memory type for image");
+                    image->destroy();
+                    return std::nullopt;
+                }
+
+                const VkMemoryAllocateInfo allocation_info{
+                    .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+                    .allocationSize = requirements.size,
+                    .memoryTypeIndex = memory_type.value(),
+                };
+
+                result = vkAllocateMemory(device->handle(), &allocation_info, info.allocation_callbacks, &image->_memory);
+                if (result != VK_SUCCESS)
+                {
+                    logger::error("Failed to allocate image memory: {}", error_string(result));
+                    image->destroy();
+                    return std::nullopt;
+                }
+
+                vkBindImageMemory(device->handle(), image->_image, image->_memory, 0);
+
+                const VkImageViewCreateInfo view_info{
+                    .sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+                    .image = image->_image,
+                    .viewType = VK_IMAGE_VIEW_TYPE_2D,
+                    .format = info.format,
+                    .components = {
+                        VK_COMPONENT_SWIZZLE_IDENTITY,
+                        VK_COMPONENT_SWIZZLE_IDENTITY,
+                        VK_COMPONENT_SWIZZLE_IDENTITY,
+                        VK_COMPONENT_SWIZZLE_IDENTITY,
+                    },
+                    .subresourceRange = {
+                        .aspectMask = aspect_of(info.format),
+                        .baseMipLevel = 0,
+                        .levelCount = 1,
+                        .baseArrayLayer = 0,
+                        .layerCount = 1,
+                    },
+                };
+
+                result = vkCreateImageView(device->handle(), &view_info, info.allocation_callbacks, &image->_view);
+                if (result != VK_SUCCESS)
+                {
+                    logger::error("Failed to create image view: {}", error_string(result));
+                    image->destroy();
+                    return std::nullopt;
+                }
+
+                return image;
+            }
+
+            image::builder& image::builder::set_format(const VkFormat format) noexcept
+            {
+                info.format = format;
+
+                return *this;
+            }
+
+            image::builder& image::builder::set_extent(struct width width, struct height height) noexcept
+            {
+                info.extent = VkExtent2D{
+                    .width = width.w,
+                    .height = height.h,
+                };
+
+                return *this;
+            }
+
+            image::builder& image::builder::set_usage(const VkImageUsageFlags usage) noexcept
+            {
+                info.usage = usage;
+
+                return *this;
+            }
+
+            image::builder& image::builder::set_allocation_callbacks(VkAllocationCallbacks* callbacks) noexcept
+            {
+                info.allocation_callbacks = callbacks;
+
+                return *this;
+            }
+
+            void image::destroy() noexcept
+            {
+                const VkDevice device = _device.lock()->handle();
+
+                if (_view != VK_NULL_HANDLE)
+                {
+                    vkDestroyImageView(device, _view, _allocation_callbacks);
+                    _view = VK_NULL_HANDLE;
+                }
+
+                if (_image != VK_NULL_HANDLE)
+                {
+                    vkDestroyImage(device, _image, _allocation_callbacks);
+                    _image = VK_NULL_HANDLE;
+                }
+
+                if (_memory != VK_NULL_HANDLE)
+                {
+                    vkFreeMemory(device, _memory, _allocation_callbacks);
+                    _memory = VK_NULL_HANDLE;
+                }
+            }
+        } // vk namespace
+    } // gfx namespace
+} // blade namespace
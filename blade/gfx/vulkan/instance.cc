@@ -223,7 +223,7 @@ namespace blade
                 if (_info.instance)
                 {
                     logger::info("Destroying vulkan instance...");
-                    vkDestroyInstance(_info.instance, nullptr);
+                    vkDestroyInstance(_info.instance, _info.allocation_callbacks);
                     logger::info("Destroyed.");
                 }
             }
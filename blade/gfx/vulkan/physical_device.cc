@@ -33,11 +33,143 @@ namespace blade
             void physical_device::set_properties_() noexcept
             {
                 vkGetPhysicalDeviceProperties(_info.physical_device, &_info.properties);
+
+                _info.descriptor_indexing_properties = {};
+                _info.descriptor_indexing_properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_PROPERTIES;
+
+                _info.graphics_pipeline_library_properties = {};
+                _info.graphics_pipeline_library_properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_PROPERTIES_EXT;
+
+                VkPhysicalDeviceProperties2 properties2{};
+                properties2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+                properties2.pNext = &_info.descriptor_indexing_properties;
+
+                if (extension_is_supported(VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME))
+                {
+                    _info.descriptor_indexing_properties.pNext = &_info.graphics_pipeline_library_properties;
+                }
+
+                vkGetPhysicalDeviceProperties2(_info.physical_device, &properties2);
+
+                _info.descriptor_indexing_properties.pNext = nullptr;
             }
 
             void physical_device::set_features_() noexcept
             {
                 vkGetPhysicalDeviceFeatures(_info.physical_device, &_info.features);
+
+                _info.vulkan12_features = {};
+                _info.vulkan12_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+
+                _info.extended_dynamic_state_features = {};
+                _info.extended_dynamic_state_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTENDED_DYNAMIC_STATE_FEATURES_EXT;
+                _info.extended_dynamic_state2_features = {};
+                _info.extended_dynamic_state2_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTENDED_DYNAMIC_STATE_2_FEATURES_EXT;
+                _info.extended_dynamic_state3_features = {};
+                _info.extended_dynamic_state3_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTENDED_DYNAMIC_STATE_3_FEATURES_EXT;
+                _info.graphics_pipeline_library_features = {};
+                _info.graphics_pipeline_library_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_FEATURES_EXT;
+                _info.present_id_features = {};
+                _info.present_id_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_ID_FEATURES_KHR;
+                _info.present_wait_features = {};
+                _info.present_wait_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_WAIT_FEATURES_KHR;
+
+                VkPhysicalDeviceFeatures2 features2{};
+                features2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+                features2.pNext = &_info.vulkan12_features;
+
+                // Extension feature structs may only be chained when the extension is exposed
+                void** next = &_info.vulkan12_features.pNext;
+                if (extension_is_supported(VK_EXT_EXTENDED_DYNAMIC_STATE_EXTENSION_NAME))
+                {
+                    *next = &_info.extended_dynamic_state_features;
+                    next = &_info.extended_dynamic_state_features.pNext;
+                }
+                if (extension_is_supported(VK_EXT_EXTENDED_DYNAMIC_STATE_2_EXTENSION_NAME))
+                {
+                    *next = &_info.extended_dynamic_state2_features;
+                    next = &_info.extended_dynamic_state2_features.pNext;
+                }
+                if (extension_is_supported(VK_EXT_EXTENDED_DYNAMIC_STATE_3_EXTENSION_NAME))
+                {
+                    *next = &_info.extended_dynamic_state3_features;
+                    next = &_info.extended_dynamic_state3_features.pNext;
+                }
+                if (extension_is_supported(VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME))
+                {
+                    *next = &_info.graphics_pipeline_library_features;
+                    next = &_info.graphics_pipeline_library_features.pNext;
+                }
+                if (extension_is_supported(VK_KHR_PRESENT_ID_EXTENSION_NAME))
+                {
+                    *next = &_info.present_id_features;
+                    next = &_info.present_id_features.pNext;
+                }
+                if (extension_is_supported(VK_KHR_PRESENT_WAIT_EXTENSION_NAME))
+                {
+                    *next = &_info.present_wait_features;
+                    next = &_info.present_wait_features.pNext;
+                }
+
+                vkGetPhysicalDeviceFeatures2(_info.physical_device, &features2);
+
+                // Do not keep pointers into this object around once the query is done
+                _info.vulkan12_features.pNext = nullptr;
+                _info.extended_dynamic_state_features.pNext = nullptr;
+                _info.extended_dynamic_state2_features.pNext = nullptr;
+                _info.extended_dynamic_state3_features.pNext = nullptr;
+                _info.graphics_pipeline_library_features.pNext = nullptr;
+                _info.present_id_features.pNext = nullptr;
+                _info.present_wait_features.pNext = nullptr;
+            }
+
+            bool physical_device::supports_descriptor_indexing() const noexcept
+            {
+                const VkPhysicalDeviceVulkan12Features& features = _info.vulkan12_features;
+
+                return features.descriptorIndexing
+                    && features.runtimeDescriptorArray
+                    && features.descriptorBindingPartiallyBound
+                    && features.descriptorBindingUpdateUnusedWhilePending
+                    && features.descriptorBindingSampledImageUpdateAfterBind
+                    && features.descriptorBindingStorageBufferUpdateAfterBind
+                    && features.shaderSampledImageArrayNonUniformIndexing
+                    && features.shaderStorageBufferArrayNonUniformIndexing;
+            }
+
+            bool physical_device::supports_extended_dynamic_state() const noexcept
+            {
+                return extension_is_supported(VK_EXT_EXTENDED_DYNAMIC_STATE_EXTENSION_NAME)
+                    && _info.extended_dynamic_state_features.extendedDynamicState;
+            }
+
+            bool physical_device::supports_extended_dynamic_state2() const noexcept
+            {
+                return extension_is_supported(VK_EXT_EXTENDED_DYNAMIC_STATE_2_EXTENSION_NAME)
+                    && _info.extended_dynamic_state2_features.extendedDynamicState2;
+            }
+
+            bool physical_device::supports_extended_dynamic_state3() const noexcept
+            {
+                return extension_is_supported(VK_EXT_EXTENDED_DYNAMIC_STATE_3_EXTENSION_NAME)
+                    && _info.extended_dynamic_state3_features.extendedDynamicState3PolygonMode
+                    && _info.extended_dynamic_state3_features.extendedDynamicState3ColorBlendEnable;
+            }
+
+            bool physical_device::supports_graphics_pipeline_library() const noexcept
+            {
+                return extension_is_supported(VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME)
+                    && extension_is_supported(VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME)
+                    && _info.graphics_pipeline_library_features.graphicsPipelineLibrary
+                    && _info.graphics_pipeline_library_properties.graphicsPipelineLibraryFastLinking;
+            }
+
+            bool physical_device::supports_present_wait() const noexcept
+            {
+                return extension_is_supported(VK_KHR_PRESENT_ID_EXTENSION_NAME)
+                    && extension_is_supported(VK_KHR_PRESENT_WAIT_EXTENSION_NAME)
+                    && _info.present_id_features.presentId
+                    && _info.present_wait_features.presentWait;
             }
 
             void physical_device::set_memory_properties_() noexcept
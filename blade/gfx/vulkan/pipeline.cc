@@ -1,8 +1,10 @@
 #include "gfx/vulkan/pipeline.h"
 #include "gfx/vulkan/device.h"
+#include "gfx/vulkan/utils.h"
 #include <array>
 #include <memory>
 #include <optional>
+#include <vector>
 #include <vulkan/vulkan_core.h>
 
 namespace blade
@@ -14,7 +16,7 @@ namespace blade
             std::optional<std::shared_ptr<pipeline>> pipeline::builder::build() const noexcept
             {
                 auto pipeline = std::make_shared<class pipeline>(info.device);
-
+                pipeline->_allocation_callbacks = info.allocation_callbacks;
 
                 VkPipelineDynamicStateCreateInfo dynamic_state {
                     .sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO,
@@ -46,6 +48,15 @@ namespace blade
                     return std::nullopt;
                 }
 
+                // Every color attachment shares the same blend state
+                const core::small_vector<VkPipelineColorBlendAttachmentState, 8> color_blend_attachments(
+                    info.color_attachment_count
+                    , info.color_blend_attachment
+                );
+                VkPipelineColorBlendStateCreateInfo color_blend_info = info.color_blend_info;
+                color_blend_info.attachmentCount = static_cast<u32>(color_blend_attachments.size());
+                color_blend_info.pAttachments = color_blend_attachments.data();
+
                 switch(info.type)
                 {
                     case type::compute:
@@ -64,8 +75,8 @@ namespace blade
                             .pViewportState = &info.viewport_info,
                             .pRasterizationState = &info.rasterization_info,
                             .pMultisampleState = &info.multisampler_info,
-                            .pDepthStencilState = nullptr,
-                            .pColorBlendState = &info.color_blend_info,
+                            .pDepthStencilState = &info.depth_stencil_info,
+                            .pColorBlendState = &color_blend_info,
                             .pDynamicState = &dynamic_state,
                             .layout = pipeline->_layout,
                             .renderPass = info.renderpass,
@@ -91,6 +102,174 @@ namespace blade
                 return pipeline;
             }
 
+            std::optional<std::shared_ptr<pipeline>> pipeline::builder::build_library(const library_part part) const noexcept
+            {
+                auto pipeline = std::make_shared<class pipeline>(info.device);
+                pipeline->_allocation_callbacks = info.allocation_callbacks;
+
+                VkGraphicsPipelineLibraryFlagsEXT library_flags = 0;
+                VkShaderStageFlagBits stage = VK_SHADER_STAGE_ALL;
+                switch (part)
+                {
+                    case library_part::vertex_input:
+                        library_flags = VK_GRAPHICS_PIPELINE_LIBRARY_VERTEX_INPUT_INTERFACE_BIT_EXT;
+                        break;
+                    case library_part::pre_rasterization:
+                        library_flags = VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT;
+                        stage = VK_SHADER_STAGE_VERTEX_BIT;
+                        break;
+                    case library_part::fragment_shader:
+                        library_flags = VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT;
+                        stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+                        break;
+                    case library_part::fragment_output:
+                        library_flags = VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_OUTPUT_INTERFACE_BIT_EXT;
+                        break;
+                    case library_part::count:
+                        return std::nullopt;
+                }
+
+                // Only the shader parts reference the layout
+                if (stage != VK_SHADER_STAGE_ALL)
+                {
+                    if (VK_SUCCESS != vkCreatePipelineLayout(
+                        info.device.lock()->handle(),
+                        &info.pipeline_layout_info,
+                        info.allocation_callbacks,
+                        &pipeline->_layout))
+                    {
+                        return std::nullopt;
+                    }
+                }
+
+                core::small_vector<VkPipelineShaderStageCreateInfo, 2> stages{};
+                for (const auto& shader_stage : info.shader_stages)
+                {
+                    if (shader_stage.stage == stage)
+                    {
+                        stages.push_back(shader_stage);
+                    }
+                }
+
+                const VkPipelineDynamicStateCreateInfo dynamic_state {
+                    .sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO,
+                    .flags = 0,
+                    .dynamicStateCount = static_cast<u32>(info.dynamic_states.size()),
+                    .pDynamicStates = info.dynamic_states.data(),
+                };
+
+                const VkGraphicsPipelineLibraryCreateInfoEXT library_info {
+                    .sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_LIBRARY_CREATE_INFO_EXT,
+                    .flags = library_flags,
+                };
+
+                const bool vertex_input = part == library_part::vertex_input;
+                const bool pre_rasterization = part == library_part::pre_rasterization;
+                const bool fragment_shader = part == library_part::fragment_shader;
+                const bool fragment_output = part == library_part::fragment_output;
+
+                // Every color attachment shares the same blend state
+                const core::small_vector<VkPipelineColorBlendAttachmentState, 8> color_blend_attachments(
+                    info.color_attachment_count
+                    , info.color_blend_attachment
+                );
+                VkPipelineColorBlendStateCreateInfo color_blend_info = info.color_blend_info;
+                color_blend_info.attachmentCount = static_cast<u32>(color_blend_attachments.size());
+                color_blend_info.pAttachments = color_blend_attachments.data();
+
+                // Keep link-time optimization info so the background link can produce an optimized pipeline
+                const VkGraphicsPipelineCreateInfo graphics_info {
+                    .sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
+                    .pNext = &library_info,
+                    .flags = VK_PIPELINE_CREATE_LIBRARY_BIT_KHR | VK_PIPELINE_CREATE_RETAIN_LINK_TIME_OPTIMIZATION_INFO_BIT_EXT,
+                    .stageCount = static_cast<u32>(stages.size()),
+                    .pStages = stages.empty() ? nullptr : stages.data(),
+                    .pVertexInputState = vertex_input ? &info.vertex_info : nullptr,
+                    .pInputAssemblyState = vertex_input ? &info.input_assembly_info : nullptr,
+                    .pViewportState = pre_rasterization ? &info.viewport_info : nullptr,
+                    .pRasterizationState = pre_rasterization ? &info.rasterization_info : nullptr,
+                    .pMultisampleState = fragment_shader || fragment_output ? &info.multisampler_info : nullptr,
+                    .pDepthStencilState = fragment_shader ? &info.depth_stencil_info : nullptr,
+                    .pColorBlendState = fragment_output ? &color_blend_info : nullptr,
+                    .pDynamicState = &dynamic_state,
+                    .layout = pipeline->_layout,
+                    .renderPass = vertex_input ? VK_NULL_HANDLE : info.renderpass,
+                    .subpass = 0,
+                };
+
+                const VkResult result = vkCreateGraphicsPipelines(
+                    info.device.lock()->handle()
+                    , VK_NULL_HANDLE
+                    , 1
+                    , &graphics_info
+                    , info.allocation_callbacks
+                    , &pipeline->_pipeline
+                );
+
+                if (result != VK_SUCCESS)
+                {
+                    logger::error("Failed to build pipeline library part {}: {}", static_cast<u32>(part), error_string(result));
+                    pipeline->destroy();
+                    return std::nullopt;
+                }
+
+                return pipeline;
+            }
+
+            std::optional<std::shared_ptr<pipeline>> pipeline::link(
+                std::weak_ptr<const class device> device
+                , const libraries& parts
+                , const bool optimize
+                , VkAllocationCallbacks* callbacks
+            ) noexcept
+            {
+                std::array<VkPipeline, static_cast<u32>(library_part::count)> handles{};
+                for (u32 i = 0; i < handles.size(); i++)
+                {
+                    if (!parts[i])
+                    {
+                        return std::nullopt;
+                    }
+                    handles[i] = parts[i]->handle();
+                }
+
+                auto pipeline = std::make_shared<class pipeline>(device);
+                pipeline->_allocation_callbacks = callbacks;
+                pipeline->_layout = parts[static_cast<u32>(library_part::pre_rasterization)]->layout();
+                pipeline->_owns_layout = false;
+                pipeline->_libraries = parts;
+
+                const VkPipelineLibraryCreateInfoKHR library_info {
+                    .sType = VK_STRUCTURE_TYPE_PIPELINE_LIBRARY_CREATE_INFO_KHR,
+                    .libraryCount = static_cast<u32>(handles.size()),
+                    .pLibraries = handles.data(),
+                };
+
+                const VkGraphicsPipelineCreateInfo graphics_info {
+                    .sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
+                    .pNext = &library_info,
+                    .flags = optimize ? static_cast<VkPipelineCreateFlags>(VK_PIPELINE_CREATE_LINK_TIME_OPTIMIZATION_BIT_EXT) : 0,
+                    .layout = pipeline->_layout,
+                };
+
+                const VkResult result = vkCreateGraphicsPipelines(
+                    device.lock()->handle()
+                    , VK_NULL_HANDLE
+                    , 1
+                    , &graphics_info
+                    , callbacks
+                    , &pipeline->_pipeline
+                );
+
+                if (result != VK_SUCCESS)
+                {
+                    logger::error("Failed to link graphics pipeline: {}", error_string(result));
+                    return std::nullopt;
+                }
+
+                return pipeline;
+            }
+
             pipeline::builder& pipeline::builder::add_dynamic_state(const VkDynamicState dynamic_state) noexcept
             {
                 info.dynamic_states.push_back(dynamic_state);
@@ -149,8 +328,30 @@ namespace blade
                 return *this;
             }
 
+            pipeline::builder& pipeline::builder::clear_program() noexcept
+            {
+                info.shader_stages.clear();
+                info.dynamic_states.clear();
+
+                return *this;
+            }
+
             // pipeline::builder& pipeline::builder::add_multisampling(VkPipeline
             
+            pipeline::builder& pipeline::builder::use_blending(const bool enabled) noexcept
+            {
+                info.color_blend_attachment.blendEnable = enabled ? VK_TRUE : VK_FALSE;
+
+                return *this;
+            }
+
+            pipeline::builder& pipeline::builder::set_color_attachment_count(const u32 count) noexcept
+            {
+                info.color_attachment_count = count;
+
+                return *this;
+            }
+
             pipeline::builder& pipeline::builder::add_renderpass(const VkRenderPass& renderpass) noexcept
             {
                 info.renderpass = renderpass;
@@ -336,6 +537,40 @@ namespace blade
                 return *this;
             }
 
+            pipeline::builder& pipeline::builder::set_depth_test(const VkBool32 enabled) noexcept
+            {
+                info.depth_stencil_info.depthTestEnable = enabled;
+
+                return *this;
+            }
+
+            pipeline::builder& pipeline::builder::set_depth_write(const VkBool32 enabled) noexcept
+            {
+                info.depth_stencil_info.depthWriteEnable = enabled;
+
+                return *this;
+            }
+
+            pipeline::builder& pipeline::builder::set_depth_compare_op(const VkCompareOp compare_op) noexcept
+            {
+                info.depth_stencil_info.depthCompareOp = compare_op;
+
+                return *this;
+            }
+
+            pipeline::builder& pipeline::builder::set_dynamic_state_values(const struct dynamic_state& state) noexcept
+            {
+                return set_rasterization_cull_mode(state.cull_mode)
+                       .set_rasterization_front_face(state.front_face)
+                       .set_rasterization_polygon_mode(state.polygon_mode)
+                       .set_input_assembly_topology(state.topology)
+                       .set_input_assembly_primitive_restart(state.primitive_restart)
+                       .set_depth_test(state.depth_test)
+                       .set_depth_write(state.depth_write)
+                       .set_depth_compare_op(state.depth_compare)
+                       .use_blending(state.blend == VK_TRUE);
+            }
+
             pipeline::builder& pipeline::builder::add_pipeline_layout_push_constant(const VkPushConstantRange push_constant) noexcept
             {
                 info.push_constants.push_back(push_constant);
@@ -345,6 +580,19 @@ namespace blade
                 return *this;
             }
             
+            pipeline::builder& pipeline::builder::set_pipeline_layout_push_constants(std::span<const VkPushConstantRange> push_constants) noexcept
+            {
+                info.push_constants.clear();
+                for (const auto& push_constant : push_constants)
+                {
+                    info.push_constants.push_back(push_constant);
+                }
+                info.pipeline_layout_info.pushConstantRangeCount = static_cast<u32>(info.push_constants.size());
+                info.pipeline_layout_info.pPushConstantRanges = info.push_constants.data();
+
+                return *this;
+            }
+
             pipeline::builder& pipeline::builder::add_pipeline_layout_descriptor_set(const VkDescriptorSetLayout descriptor_set) noexcept
             {
                 info.descriptor_sets.push_back(descriptor_set);
@@ -371,7 +619,14 @@ namespace blade
             void pipeline::destroy() noexcept
             {
                 vkDestroyPipeline(_device.lock()->handle(), _pipeline, _allocation_callbacks);
-                vkDestroyPipelineLayout(_device.lock()->handle(), _layout, _allocation_callbacks);
+                _pipeline = VK_NULL_HANDLE;
+
+                if (_owns_layout)
+                {
+                    vkDestroyPipelineLayout(_device.lock()->handle(), _layout, _allocation_callbacks);
+                }
+                _layout = VK_NULL_HANDLE;
+                _libraries = {};
             }
         } // vk namespace
     } // gfx namespace
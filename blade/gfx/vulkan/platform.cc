@@ -19,6 +19,18 @@ namespace blade
 #elif defined(BLADE_PLATFORM_WINDOWS)
                     create_info_ref.hwnd = window_data.hwnd;
                     create_info_ref.hinstance = window_data.hinstance;
+#endif
+                }
+
+                bool same_window(const struct framebuffer_create_info::native_window_data& lhs,
+                                 const struct framebuffer_create_info::native_window_data& rhs) noexcept
+                {
+#ifdef BLADE_PLATFORM_LINUX
+                    return lhs.display == rhs.display && lhs.window == rhs.window;
+#elif defined(BLADE_PLATFORM_WINDOWS)
+                    return lhs.hwnd == rhs.hwnd;
+#else
+                    return false;
 #endif
                 }
             } // platform namespace
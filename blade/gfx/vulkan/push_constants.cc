@@ -0,0 +1,243 @@
+#include "gfx/vulkan/push_constants.h"
+#include <algorithm>
+#include <cstring>
+
+namespace blade
+{
+    namespace gfx
+    {
+        namespace vk
+        {
+            bool push_constant_block::reserve(const VkPushConstantRange range, const u32 limit) noexcept
+            {
+                if (!_ranges.empty() || _reserved.size != 0 || range.offset != 0)
+                {
+                    logger::error("Push constant bytes can only be reserved at offset 0 before any range is declared");
+                    return false;
+                }
+
+                if (!check_size_(range, limit))
+                {
+                    return false;
+                }
+
+                _reserved = range;
+                _size = std::max(_size, range.size);
+                _captured = no_capture;
+                update_layout_ranges_();
+
+                return true;
+            }
+
+            bool push_constant_block::declare(const VkPushConstantRange range, const u32 limit) noexcept
+            {
+                if (!check_size_(range, limit))
+                {
+                    return false;
+                }
+
+                if (range.offset < _reserved.size)
+                {
+                    logger::error("Push constant range [{}, {}) overlaps the {} reserved bytes", range.offset, range.offset + range.size, _reserved.size);
+                    return false;
+                }
+
+                for (const auto& declared : _ranges)
+                {
+                    if ((declared.stageFlags & range.stageFlags) != 0)
+                    {
+                        logger::error("Push constant stages may only appear in one range");
+                        return false;
+                    }
+                }
+
+                _ranges.push_back(range);
+                _size = std::max(_size, range.offset + range.size);
+                _captured = no_capture;
+                update_layout_ranges_();
+
+                return true;
+            }
+
+            bool push_constant_block::check_size_(const VkPushConstantRange range, const u32 limit) const noexcept
+            {
+                const u32 max = std::min(limit, max_size);
+
+                if (range.size == 0 || range.offset % 4 != 0 || range.size % 4 != 0)
+                {
+                    logger::error("Push constant range [{}, {}) must be non-empty and 4-byte aligned", range.offset, range.offset + range.size);
+                    return false;
+                }
+
+                if (range.offset + range.size > max)
+                {
+                    logger::error("Push constant range [{}, {}) exceeds the device limit of {} bytes", range.offset, range.offset + range.size, max);
+                    return false;
+                }
+
+                if (range.stageFlags == 0)
+                {
+                    logger::error("Push constant range [{}, {}) has no shader stages", range.offset, range.offset + range.size);
+                    return false;
+                }
+
+                return true;
+            }
+
+            void push_constant_block::update_layout_ranges_() noexcept
+            {
+                _layout_ranges.clear();
+
+                VkShaderStageFlags widened = 0;
+                for (auto range : _ranges)
+                {
+                    if (_reserved.size != 0 && (range.stageFlags & _reserved.stageFlags) != 0)
+                    {
+                        range.size += range.offset;
+                        range.offset = 0;
+                        widened |= range.stageFlags;
+                    }
+
+                    _layout_ranges.push_back(range);
+                }
+
+                // Reserved stages no declared range covers still need a range of their own
+                const VkShaderStageFlags remaining = _reserved.stageFlags & ~widened;
+                if (_reserved.size != 0 && remaining != 0)
+                {
+                    _layout_ranges.push_back(VkPushConstantRange{
+                        .stageFlags = remaining,
+                        .offset = 0,
+                        .size = _reserved.size,
+                    });
+                }
+            }
+
+            bool push_constant_block::write(const void* data, u32 size, u32 offset) noexcept
+            {
+                if (size == 0 || data == nullptr)
+                {
+                    return true;
+                }
+
+                const u32 end = offset + size;
+                if (offset < _reserved.size)
+                {
+                    logger::error("Push constant write [{}, {}) overlaps the {} reserved bytes", offset, end, _reserved.size);
+                    return false;
+                }
+
+                // Vulkan requires the pushed stages to be exactly the stages of every range touching those bytes,
+                // and each of those ranges must contain the whole update
+                VkShaderStageFlags stages = 0;
+                for (const auto& range : _layout_ranges)
+                {
+                    const u32 range_end = range.offset + range.size;
+                    if (offset >= range_end || end <= range.offset)
+                    {
+                        continue;
+                    }
+
+                    if (offset < range.offset || end > range_end)
+                    {
+                        logger::error("Push constant write [{}, {}) straddles the range [{}, {})", offset, end, range.offset, range_end);
+                        return false;
+                    }
+
+                    stages |= range.stageFlags;
+                }
+
+                if (stages == 0 || offset % 4 != 0 || size % 4 != 0)
+                {
+                    logger::error("Push constant write [{}, {}) is not inside an aligned declared range", offset, end);
+                    return false;
+                }
+
+                const bool already_written = std::any_of(_written.begin(), _written.end(), [&](const span& s) {
+                    return s.stages == stages && s.begin <= offset && end <= s.end;
+                });
+
+                if (already_written && std::memcmp(_data.data() + offset, data, size) == 0)
+                {
+                    return true;
+                }
+
+                std::memcpy(_data.data() + offset, data, size);
+                mark_written_(stages, offset, end);
+                _captured = no_capture;
+
+                return true;
+            }
+
+            void push_constant_block::mark_written_(VkShaderStageFlags stages, u32 begin, u32 end) noexcept
+            {
+                // Merge with overlapping or touching spans that push to the same stages
+                for (auto it = _written.begin(); it != _written.end();)
+                {
+                    if (it->stages == stages && it->begin <= end && begin <= it->end)
+                    {
+                        begin = std::min(begin, it->begin);
+                        end = std::max(end, it->end);
+                        it = _written.erase(it);
+                    }
+                    else
+                    {
+                        ++it;
+                    }
+                }
+
+                _written.push_back(span{
+                    .stages = stages,
+                    .begin = begin,
+                    .end = end,
+                });
+            }
+
+            u32 push_constant_block::capture(std::vector<u8>& captures) noexcept
+            {
+                if (_captured == no_capture)
+                {
+                    _captured = snapshot(captures);
+                }
+
+                return _captured;
+            }
+
+            u32 push_constant_block::snapshot(std::vector<u8>& captures) const noexcept
+            {
+                if (_size == 0)
+                {
+                    return no_capture;
+                }
+
+                const u32 offset = static_cast<u32>(captures.size());
+                captures.insert(captures.end(), _data.begin(), _data.begin() + _size);
+
+                return offset;
+            }
+
+            void push_constant_block::record(const command_buffer::recording::record_renderpass& pass, VkPipelineLayout layout, const u8* captured) const noexcept
+            {
+                for (const auto& span : _written)
+                {
+                    pass.push_constants(layout, span.stages, span.begin, span.end - span.begin, captured + span.begin);
+                }
+            }
+
+            void push_constant_block::record_reserved(const command_buffer::recording::record_renderpass& pass, VkPipelineLayout layout, const void* data) const noexcept
+            {
+                // Every layout range starting at 0 covers the reserved bytes, and all of their stages must be named
+                VkShaderStageFlags stages = 0;
+                for (const auto& range : _layout_ranges)
+                {
+                    if (range.offset < _reserved.size)
+                    {
+                        stages |= range.stageFlags;
+                    }
+                }
+
+                pass.push_constants(layout, stages, 0, _reserved.size, data);
+            }
+        } // vk namespace
+    } // gfx namespace
+} // blade namespace
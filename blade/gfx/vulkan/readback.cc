@@ -0,0 +1,189 @@
+#include "gfx/vulkan/readback.h"
+#include <algorithm>
+#include <utility>
+
+namespace blade
+{
+    namespace gfx
+    {
+        namespace vk
+        {
+            u32 readback_ring::bytes_per_pixel(texture_format format) noexcept
+            {
+                switch (format)
+                {
+                    case texture_format::rgba8:
+                    case texture_format::bgra8:   return 4;
+                    case texture_format::rgba16f: return 8;
+                    case texture_format::rgba32f: return 16;
+                }
+
+                return 4;
+            }
+
+            bool readback_ring::request(u32 target, VkExtent2D extent, texture_format format, readback_callback callback) noexcept
+            {
+                if (_slots.empty())
+                {
+                    _slots.resize(initial_slots);
+                }
+
+                auto slot_it = std::find_if(_slots.begin(), _slots.end(), [](const slot& s) { return !s.in_use; });
+                if (slot_it == _slots.end())
+                {
+                    if (_slots.size() >= max_slots)
+                    {
+                        logger::warn("Readback ring is full. Dropping request for target {}", target);
+                        return false;
+                    }
+
+                    slot_it = _slots.emplace(_slots.end());
+                }
+
+                const u32 size = extent.width * extent.height * bytes_per_pixel(format);
+                if (!reserve_(*slot_it, size))
+                {
+                    return false;
+                }
+
+                slot_it->in_use = true;
+                slot_it->serial = 0;
+                slot_it->target = target;
+                slot_it->extent = extent;
+                slot_it->format = format;
+                slot_it->callback = std::move(callback);
+
+                return true;
+            }
+
+            bool readback_ring::reserve_(slot& slot, u32 size) noexcept
+            {
+                if (slot.staging && slot.staging->size() >= size)
+                {
+                    return true;
+                }
+
+                release_(slot);
+
+                auto staging_opt = buffer::builder(_device)
+                                   .set_usage(VK_BUFFER_USAGE_TRANSFER_DST_BIT)
+                                   .set_size(size)
+                                   .set_allocation_callbacks(_allocation_callbacks)
+                                   .build();
+
+                if (!staging_opt.has_value())
+                {
+                    logger::error("Failed to create {} byte readback buffer", size);
+                    return false;
+                }
+
+                // The CPU reads every byte, so cached memory is much faster to read from when the device has it
+                auto staging = staging_opt.value();
+                const auto requirements = staging->memory_requirements();
+                const VkMemoryPropertyFlags cached = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_CACHED_BIT;
+                const bool has_cached = _device.lock()->get_physical_device().lock()->find_memory_type(
+                    requirements.memoryTypeBits
+                    , cached
+                ).has_value();
+
+                staging->allocate(has_cached ? cached : VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+
+                slot.mapped = staging->map();
+                if (slot.mapped == nullptr)
+                {
+                    staging->destroy();
+                    return false;
+                }
+
+                slot.staging = staging;
+
+                return true;
+            }
+
+            bool readback_ring::has_queued() const noexcept
+            {
+                return std::any_of(_slots.begin(), _slots.end(), [](const slot& s) { return s.in_use && s.serial == 0; });
+            }
+
+            void readback_ring::record(const command_buffer::recording::record_transfer& transfer, std::span<const VkImage> targets, VkImageLayout layout) const noexcept
+            {
+                for (const auto& slot : _slots)
+                {
+                    if (slot.in_use && slot.serial == 0 && slot.target < targets.size())
+                    {
+                        transfer.copy_image_to_buffer(targets[slot.target], layout, slot.staging->handle(), slot.extent);
+                    }
+                }
+            }
+
+            void readback_ring::submit(u64 serial) noexcept
+            {
+                for (auto&& slot : _slots)
+                {
+                    if (slot.in_use && slot.serial == 0)
+                    {
+                        slot.serial = serial;
+                    }
+                }
+            }
+
+            void readback_ring::resolve(u64 completed_serial) noexcept
+            {
+                for (auto&& slot : _slots)
+                {
+                    if (!slot.in_use || slot.serial == 0 || slot.serial > completed_serial)
+                    {
+                        continue;
+                    }
+
+                    slot.staging->invalidate();
+                    slot.callback(readback{
+                        .pixels = core::memory{
+                            .data = const_cast<void*>(slot.mapped),
+                            .size = slot.extent.width * slot.extent.height * bytes_per_pixel(slot.format),
+                        },
+                        .width = { slot.extent.width },
+                        .height = { slot.extent.height },
+                        .format = slot.format,
+                    });
+
+                    slot.in_use = false;
+                    slot.callback = nullptr;
+                }
+            }
+
+            void readback_ring::cancel_queued() noexcept
+            {
+                for (auto&& slot : _slots)
+                {
+                    if (slot.in_use && slot.serial == 0)
+                    {
+                        slot.callback(readback{ .format = slot.format });
+                        slot.in_use = false;
+                        slot.callback = nullptr;
+                    }
+                }
+            }
+
+            void readback_ring::release_(slot& slot) noexcept
+            {
+                if (slot.staging)
+                {
+                    slot.staging->unmap();
+                    slot.staging->destroy();
+                    slot.staging = nullptr;
+                    slot.mapped = nullptr;
+                }
+            }
+
+            void readback_ring::destroy() noexcept
+            {
+                for (auto&& slot : _slots)
+                {
+                    release_(slot);
+                }
+                _slots.clear();
+            }
+        } // vk namespace
+    } // gfx namespace
+} // blade namespace
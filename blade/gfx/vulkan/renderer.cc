@@ -1,4 +1,6 @@
 #include "gfx/vulkan/renderer.h"
+#include "core/frame_arena.h"
+#include "core/fibers.h"
 #include "core/memory.h"
 #include "core/types.h"
 #include "gfx/handle.h"
@@ -12,10 +14,12 @@
 #include "gfx/vulkan/shader.h"
 #include "gfx/vulkan/types.h"
 #include "gfx/vulkan/utils.h"
+#include <algorithm>
 #include <cstdint>
 #include <cstring>
 #include <locale>
 #include <optional>
+#include <span>
 #include <utility>
 #include <vulkan/vulkan_core.h>
 
@@ -25,6 +29,13 @@ namespace blade
     {
         namespace vk
         {
+            /// @brief Backend slot a frontend handle refers to
+            template <typename Handle>
+            static core::slot_id slot_of(const Handle handle) noexcept
+            {
+                return core::slot_id{ .value = handle.id };
+            }
+
             vulkan_backend::vulkan_backend() noexcept
             {
                 logger::debug("vulkan_backend constructor called");
@@ -71,20 +82,51 @@ namespace blade
                                     .require_api_version(version{.major{1}, .minor{3}, .patch{0}})
                                     .request_extensions(extensions)
                                     .request_validation_layers(validation_layers)
+                                    .set_allocation_callbacks(_host_allocator.callbacks())
                                     .build();
 
 
                 // auto instance_opt = instance::create();
                 _instance = std::make_shared<class instance>(std::move(instance_opt.value()));
 
-                auto builder = device::builder(_instance)
-                               .require_extension(VK_KHR_SWAPCHAIN_EXTENSION_NAME)
-                               .set_allocation_callbacks(nullptr);
+                auto builder = device::builder(_instance);
+                builder
+                    .request_descriptor_indexing(init.bindless)
+                    .request_extended_dynamic_state()
+                    .request_graphics_pipeline_library()
+                    .set_allocation_callbacks(_host_allocator.callbacks());
+
+                // Headless devices never present, so they do not need a swapchain
+                if (!init.headless)
+                {
+                    builder
+                        .require_extension(VK_KHR_SWAPCHAIN_EXTENSION_NAME)
+                        .request_present_wait();
+                }
+
+                _default_pacing.mode = init.resolution.reset;
 
                 auto device_opt = builder.build();
 
                 _device = device_opt.value();
 
+                if (init.bindless)
+                {
+                    auto bindless_opt = bindless_set::builder(_device)
+                                        .set_allocation_callbacks(_host_allocator.callbacks())
+                                        .build();
+
+                    if (bindless_opt.has_value())
+                    {
+                        _bindless = bindless_opt.value();
+                        logger::info("Bindless descriptors enabled");
+                    }
+                    else
+                    {
+                        logger::warn("Bindless descriptors requested but unavailable. Falling back to bound resources.");
+                    }
+                }
+
                 if (init.enable_debug)
                 {
                     _instance->create_debug_messenger();
@@ -92,7 +134,9 @@ namespace blade
 
                 logger::info("Creating command pool");
 
-                _transfer_cmd_handler = std::make_shared<command_handler>(_device, queue_type::transfer);
+                _transfer_cmd_handler = std::make_shared<command_handler>(_device, queue_type::transfer, _host_allocator.callbacks());
+                _submit_batch = std::make_unique<submit_batch>(_device);
+                _submit_batch->set_allocation_callbacks(_host_allocator.callbacks());
 
                 _is_initialized = true;
                 return true;
@@ -152,35 +196,57 @@ namespace blade
             bool vulkan_backend::shutdown() noexcept
             {
                 logger::info("Vulkan backend shutting down");
+
+                // Creations that never reached a frame boundary still own staging buffers
+                apply_pending_creations_();
                 vkDeviceWaitIdle(_device->handle());
 
+                // Background links may still read pipeline libraries the deletion queue is about to destroy
+                for (auto&& view : _views)
+                {
+                    view.finish_pipeline_links();
+                }
+                _deletion_queue.flush();
+
                 if (_transfer_cmd_handler)
                 {
                     _transfer_cmd_handler->destroy();
                 }
 
-                for (auto&& buffer : _index_input_infos)
+                if (_submit_batch)
                 {
-                    buffer.second->destroy();
+                    _submit_batch->destroy();
+                    _submit_batch = nullptr;
                 }
 
-                for (auto&& buffer : _vertex_input_infos)
+                for (auto&& resource : _buffers)
                 {
-                    buffer.second->destroy();
+                    resource.buffer->destroy();
                 }
+                _buffers.clear();
 
                 for (auto&& shader : _shaders)
                 {
                     logger::info("Destroying shader...");
-                    shader.second.destroy();
+                    shader.destroy();
                     logger::info("Destroyed.");
                 }
+                _shaders.clear();
+                _programs.clear();
 
-                for (auto&& view : _views)
+                for (usize i = 0; i < _views.size(); i++)
+                {
+                    const u32 id = _views.ids()[i].value;
+                    logger::info("Destroying view: {}", id);
+                    _views.values()[i].destroy();
+                    logger::info("Destroyed view {}.", id);
+                }
+                _views.clear();
+
+                if (_bindless)
                 {
-                    logger::info("Destroying view: {}", view.first.index);
-                    view.second.destroy();
-                    logger::info("Destroyed view {}.", view.first.index);
+                    _bindless->destroy();
+                    _bindless = nullptr;
                 }
 
                 logger::info("Destroying device...");
@@ -200,9 +266,8 @@ namespace blade
             framebuffer_handle vulkan_backend::create_framebuffer(framebuffer_create_info create_info) noexcept
             {
                 logger::info("Creating framebuffer...");
-                static u16 framebuffer_handle_id = 0;
 
-                auto view_opt = view::create(_instance, _device, create_info);
+                auto view_opt = view::create(_instance, _device, create_info, _host_allocator.callbacks());
                 if (!view_opt.has_value())
                 {
                     logger::info("Failed to create view");
@@ -210,110 +275,409 @@ namespace blade
                 }
 
                 auto view = std::move(view_opt.value());
+                if (_bindless)
+                {
+                    view.use_bindless(_bindless);
+                }
 
-                const framebuffer_handle handle{.index = framebuffer_handle_id};
-                _views.insert(std::make_pair(handle, std::move(view)));
+                set_view_pacing_(view, _default_pacing);
 
-                framebuffer_handle_id += 1;
+                const framebuffer_handle handle{.id = _views.emplace(std::move(view)).value};
 
                 logger::info("Created framebuffer.");
                 return handle;
             }
 
-            shader_handle vulkan_backend::create_shader(
-                const std::vector<u8>& mem
-            ) noexcept
+            shader_handle vulkan_backend::create_shader(const core::memory* code) noexcept
             {
-                static u16 shader_handle_id = 1;
+                // Shader modules only need the device, so compiling happens on the calling thread
                 const auto shader_opt = shader::builder(*_device)
-                                        .use_allocation_callbacks(nullptr)
-                                        .set_code(mem)
+                                        .use_allocation_callbacks(_host_allocator.callbacks())
+                                        .set_code(std::span(static_cast<const u8*>(code->data), code->size))
                                         .build();
 
+                // The module keeps its own copy of the code
+                core::memory::release(code);
+
                 if (!shader_opt.has_value())
                 {
                     return {BLADE_NULL_HANDLE};
                 }
 
-                auto shader = shader_opt.value();
+                const core::slot_id slot = _shaders.reserve();
+                if (slot.is_null())
+                {
+                    return {BLADE_NULL_HANDLE};
+                }
 
-                shader_handle handle{.index = shader_handle_id};
-                _shaders.insert(std::make_pair(handle, shader));
+                defer_creation_([this, slot, shader = shader_opt.value()]() {
+                    _shaders.insert(slot, shader);
+                });
 
-                shader_handle_id += 1;
+                const shader_handle handle{.id = slot.value};
 
                 return handle;
             }
 
             void vulkan_backend::frame() noexcept
             {
+                // Temporaries from here on, on this thread and the recording workers, come from the frame arenas
+                core::frame_arena::begin_frame();
+                apply_pending_creations_();
+
+                if (_views.is_empty())
+                {
+                    return;
+                }
+
+                // Each view only touches its own command pool, swapchain and targets while recording, so all but
+                // the first record as tasks while the calling thread records the first and then helps with the rest
+                auto views = core::make_frame_vector<class view*>(_views.size());
                 for (auto&& view : _views)
                 {
-                    view.second.frame();
+                    views.push_back(&view);
+                }
+
+                auto frames = core::make_frame_vector<std::optional<view::recorded_frame>>(views.size());
+                frames.resize(views.size());
+
+                // Views record as tasks, so one waiting on its pacing fence lets the others record meanwhile
+                core::fibers& fibers = core::fibers::shared();
+                core::fiber_counter recorded{};
+                for (usize i = 1; i < views.size(); i++)
+                {
+                    fibers.spawn(recorded, [&frames, view = views[i], i]() {
+                        frames[i] = view->record_frame();
+                    });
+                }
+
+                frames[0] = views[0]->record_frame();
+                fibers.wait(recorded);
+
+                for (const auto& frame : frames)
+                {
+                    if (frame.has_value())
+                    {
+                        _submit_batch->add(submit_batch::entry{
+                            .command_buffer = frame->command_buffer,
+                            .wait_semaphore = frame->wait_semaphore,
+                            .signal_semaphore = frame->signal_semaphore,
+                        });
+                    }
+                }
+
+                if (!_submit_batch->is_empty())
+                {
+                    // One submission for every view. After a failed submit the views recycle their buffers and hand their images back
+                    const bool submitted = _submit_batch->submit(_device->get_queue(queue_type::graphics).value()).has_value();
+                    for (usize i = 0; i < views.size(); i++)
+                    {
+                        if (frames[i].has_value())
+                        {
+                            views[i]->submitted(frames[i].value(), submitted ? _submit_batch.get() : nullptr);
+                        }
+                    }
+                }
+
+                for (auto* view : views)
+                {
+                    view->resolve_readbacks();
                 }
+
+                _deletion_queue.collect(_submit_batch->completed_serial());
             }
 
             void vulkan_backend::set_viewport(const framebuffer_handle framebuffer, f32 x, f32 y, struct width width,
                                               struct height height) noexcept
             {
-                auto view_it = _views.find(framebuffer);
-                if (view_it == _views.end())
+                auto* view = _views.get(slot_of(framebuffer));
+                if (view == nullptr)
                 {
                     logger::info("SetViewport framebuffer not found");
                     return;
                 }
 
-                view_it->second.set_viewport(x, y, width, height);
+                view->set_viewport(x, y, width, height);
             }
 
-            void vulkan_backend::submit() noexcept
+            void vulkan_backend::set_render_state(const framebuffer_handle framebuffer, const render_state& state) noexcept
             {
-                for (const auto& view_item : _views)
+                auto* view = _views.get(slot_of(framebuffer));
+                if (view == nullptr)
                 {
-                    auto handle = view_item.first;
-                    const auto& view = view_item.second;
+                    logger::info("SetRenderState framebuffer not found");
+                    return;
                 }
+
+                static constexpr VkCullModeFlags cull_modes[] = {
+                    VK_CULL_MODE_NONE,
+                    VK_CULL_MODE_FRONT_BIT,
+                    VK_CULL_MODE_BACK_BIT,
+                };
+
+                static constexpr VkPrimitiveTopology topologies[] = {
+                    VK_PRIMITIVE_TOPOLOGY_POINT_LIST,
+                    VK_PRIMITIVE_TOPOLOGY_LINE_LIST,
+                    VK_PRIMITIVE_TOPOLOGY_LINE_STRIP,
+                    VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST,
+                    VK_PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP,
+                };
+
+                // render_state::compare is declared in VkCompareOp order
+                const struct dynamic_state vk_state{
+                    .cull_mode = cull_modes[static_cast<u32>(state.cull_mode)],
+                    .front_face = state.front_face == render_state::winding::clockwise
+                        ? VK_FRONT_FACE_CLOCKWISE
+                        : VK_FRONT_FACE_COUNTER_CLOCKWISE,
+                    .topology = topologies[static_cast<u32>(state.topology)],
+                    .primitive_restart = state.primitive_restart ? VK_TRUE : VK_FALSE,
+                    .depth_test = state.depth_test ? VK_TRUE : VK_FALSE,
+                    .depth_write = state.depth_write ? VK_TRUE : VK_FALSE,
+                    .depth_compare = static_cast<VkCompareOp>(state.depth_compare),
+                    .polygon_mode = state.wireframe ? VK_POLYGON_MODE_LINE : VK_POLYGON_MODE_FILL,
+                    .blend = state.blend ? VK_TRUE : VK_FALSE,
+                };
+
+                view->set_render_state(vk_state);
+            }
+
+            void vulkan_backend::submit() noexcept
+            {
             }
 
-            void view::record_commands(class command_buffer& command_buffer) const noexcept
+            void view::record_commands(class command_buffer& command_buffer, std::span<const queued_draw> draws) noexcept
             {
                 auto recording = command_buffer.begin();
 
-                u32 vertex_count = 3,
-                    instance_count = 1,
-                    first_vertex = 0,
-                    first_instance = 0;
-
-                std::vector<VkClearValue> clear_values(2);
-                clear_values[0].color = {{0.f, 0.f, 0.f, 0.f}};
-                clear_values[1].depthStencil = {1.f, 0};
+                const u32 color_attachment_count = color_attachment_count_();
+                auto clear_values = core::make_frame_vector<VkClearValue>(color_attachment_count + 1);
+                clear_values.resize(color_attachment_count + 1);
+                for (u32 i = 0; i < color_attachment_count; i++)
+                {
+                    clear_values[i].color = {{0.f, 0.f, 0.f, 0.f}};
+                }
+                clear_values[color_attachment_count].depthStencil = {1.f, 0};
 
                 VkRect2D render_area{
                     .offset = {0, 0},
                     .extent = get_extent(),
                 };
 
-                auto pass = recording->begin_renderpass(renderpass, framebuffers[current_image_index], clear_values,
-                                                        render_area);
-                pass.bind_pipeline(VK_PIPELINE_BIND_POINT_GRAPHICS, graphics_pipeline->handle());
+                // Framebuffers nobody queued draws for keep their fixed test draws. Without a program they only clear
+                auto default_draws = core::make_frame_vector<queued_draw>(2);
+                if (!graphics_pipeline)
+                {
+                    draws = {};
+                }
+                else if (draws.empty())
+                {
+                    // They use the push constants and render state as they are now
+                    const u32 captured = push_constants.snapshot(recording_push_captures);
+                    const u32 state = static_cast<u32>(recording_draw_states.size());
+                    recording_draw_states.push_back(draw_state{
+                        .state = render_state,
+                        .pipeline_key = pipeline_key_(render_state),
+                    });
+
+                    default_draws.push_back(queued_draw{ .call = draw_call{ .vertex_count = 3 }, .push_constants = captured, .state = state });
+                    if (index_buffer != nullptr)
+                    {
+                        default_draws.push_back(queued_draw{ .call = draw_call{ .index_count = 6 }, .push_constants = captured, .state = state });
+                    }
+                    draws = default_draws;
+                }
+
+                const VkFramebuffer framebuffer = framebuffers[current_image_index];
+                const u32 chunk_count = std::min<u32>(
+                    secondary_pools.thread_count()
+                    , static_cast<u32>(draws.size() / min_draws_per_chunk)
+                );
+
+                if (chunk_count > 1)
+                {
+                    auto pass = recording->begin_renderpass(renderpass, framebuffer, clear_values, render_area,
+                                                            VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+                    const auto secondaries = record_draw_chunks_(draws, chunk_count, framebuffer, render_area);
+                    pass.execute_commands(secondaries);
+                    pass.end();
+                }
+                else
+                {
+                    auto pass = recording->begin_renderpass(renderpass, framebuffer, clear_values, render_area);
+                    record_draws_(pass, draws, render_area);
+                    pass.end();
+                }
+
+                // Requests made since the last frame copy the targets this pass just finished
+                if (readbacks.has_queued())
+                {
+                    auto transfer = recording->begin_transfer();
+                    if (swapchain.has_value())
+                    {
+                        const VkImage image = swapchain.value()->get_image(current_image_index);
+                        transfer.transition_image(
+                            image
+                            , VK_IMAGE_LAYOUT_PRESENT_SRC_KHR
+                            , VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL
+                            , VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT
+                            , VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT
+                            , VK_PIPELINE_STAGE_TRANSFER_BIT
+                            , VK_ACCESS_TRANSFER_READ_BIT
+                        );
+                        readbacks.record(transfer, std::span<const VkImage>(&image, 1), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
+                        transfer.transition_image(
+                            image
+                            , VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL
+                            , VK_IMAGE_LAYOUT_PRESENT_SRC_KHR
+                            , VK_PIPELINE_STAGE_TRANSFER_BIT
+                            , 0
+                            , VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT
+                            , 0
+                        );
+                    }
+                    else
+                    {
+                        auto targets = core::make_frame_vector<VkImage>(offscreen_targets.size());
+                        for (const auto& target : offscreen_targets)
+                        {
+                            targets.push_back(target->handle());
+                        }
+
+                        readbacks.record(transfer, targets, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
+                    }
+                }
+
+                command_buffer.end();
+            }
+
+            void view::record_draws_(const command_buffer::recording::record_renderpass& pass, std::span<const queued_draw> draws, VkRect2D render_area) const noexcept
+            {
+                if (!graphics_pipeline)
+                {
+                    return;
+                }
+
+                // Nothing is inherited by secondary buffers, so every chunk binds the full state again. Every
+                // pipeline shares one layout, so the set and push constants stay bound across pipeline changes
+                if (auto set = bindless.lock())
+                {
+                    // Every resource lives in the one set, so it is bound once instead of per draw
+                    pass.bind_descriptor_set(VK_PIPELINE_BIND_POINT_GRAPHICS, graphics_pipeline->layout(), 0, set->handle());
+                }
                 pass.set_viewport(viewport);
                 pass.set_scissor(render_area);
-                pass.bind_vertex_buffers(buffer.lock()->handle_ptr());
-                pass.draw(vertex_count, instance_count, first_vertex, first_instance);
-
+                if (auto vertex_buffer = buffer.lock())
+                {
+                    pass.bind_vertex_buffers(vertex_buffer->handle_ptr());
+                }
                 if (index_buffer != nullptr)
                 {
-                    u32 index_count = 6
-                        , first_index = 0
-                        , first_instance = 0;
-                    i32 vertex_offset = 0;
                     pass.bind_index_buffers(index_buffer->handle(), index_buffer->size());
-                    pass.draw_indexed(index_count, instance_count, first_index, vertex_offset, vertex_offset);
                 }
 
-                pass.end();
+                // Draws queued without a push constant write in between share a capture, so it is pushed once for all of them
+                u32 pushed = push_constant_block::no_capture;
+                const bool push_indices = push_constants.reserved_size() != 0;
+                const std::array<u32, max_bindless_indices>* pushed_indices = nullptr;
 
-                command_buffer.end();
+                // Pipelines are bound and dynamic state set only where consecutive draws differ
+                const auto& dynamic_state_commands = device.lock()->get_dynamic_state_commands();
+                const u32 color_attachment_count = color_attachment_count_();
+                const draw_state* bound = nullptr;
+                for (const auto& [call, captured, state] : draws)
+                {
+                    const draw_state& wanted = recording_draw_states[state];
+                    if (bound == nullptr || bound->pipeline_key != wanted.pipeline_key)
+                    {
+                        // The state's pipeline can be missing if the program was rebuilt after the draw was queued
+                        const auto pipeline_it = pipelines.find(wanted.pipeline_key);
+                        if (pipeline_it == pipelines.end())
+                        {
+                            continue;
+                        }
+
+                        pass.bind_pipeline(VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline_it->second->handle());
+                    }
+                    if (bound == nullptr || bound->state != wanted.state)
+                    {
+                        pass.set_dynamic_state(dynamic_state_commands, wanted.state, color_attachment_count);
+                    }
+                    bound = &wanted;
+
+                    if (captured != pushed && captured != push_constant_block::no_capture)
+                    {
+                        push_constants.record(pass, graphics_pipeline->layout(), recording_push_captures.data() + captured);
+                        pushed = captured;
+                    }
+
+                    // Bindless indices go out with every draw that changes them
+                    if (push_indices && (pushed_indices == nullptr || *pushed_indices != call.bindless_indices))
+                    {
+                        push_constants.record_reserved(pass, graphics_pipeline->layout(), call.bindless_indices.data());
+                        pushed_indices = &call.bindless_indices;
+                    }
+
+                    if (call.index_count == 0)
+                    {
+                        pass.draw(call.vertex_count, call.instance_count, call.first_vertex, call.first_instance);
+                    }
+                    else if (index_buffer != nullptr)
+                    {
+                        pass.draw_indexed(call.index_count, call.instance_count, call.first_index, call.vertex_offset, call.first_instance);
+                    }
+                }
+            }
+
+            core::frame_vector<VkCommandBuffer> view::record_draw_chunks_(std::span<const queued_draw> draws, u32 chunk_count, VkFramebuffer framebuffer, VkRect2D render_area) noexcept
+            {
+                const usize chunk_size = (draws.size() + chunk_count - 1) / chunk_count;
+
+                // Chunk `i` is recorded from the pool of thread `i`, so no two threads share a pool
+                auto record_chunk = [this, draws, chunk_size, framebuffer, render_area](u32 chunk) -> VkCommandBuffer {
+                    const VkCommandBuffer handle = secondary_pools.acquire_secondary(chunk);
+                    if (handle == VK_NULL_HANDLE)
+                    {
+                        return VK_NULL_HANDLE;
+                    }
+
+                    class command_buffer secondary(handle);
+                    auto recording = secondary.begin_secondary(renderpass, framebuffer);
+                    if (!recording.has_value())
+                    {
+                        logger::error("Failed to begin secondary command buffer {}", chunk);
+                        return VK_NULL_HANDLE;
+                    }
+
+                    const usize first = chunk * chunk_size;
+                    const usize count = std::min(chunk_size, draws.size() - first);
+
+                    auto pass = recording->continue_renderpass(renderpass);
+                    record_draws_(pass, draws.subspan(first, count), render_area);
+                    pass.end();
+                    secondary.end();
+
+                    return handle;
+                };
+
+                auto secondaries = core::make_frame_vector<VkCommandBuffer>(chunk_count);
+                secondaries.resize(chunk_count, VK_NULL_HANDLE);
+
+                core::fibers& fibers = core::fibers::shared();
+                core::fiber_counter recorded{};
+                for (u32 chunk = 1; chunk < chunk_count; chunk++)
+                {
+                    fibers.spawn(recorded, [&secondaries, &record_chunk, chunk]() {
+                        secondaries[chunk] = record_chunk(chunk);
+                    });
+                }
+
+                secondaries[0] = record_chunk(0);
+                fibers.wait(recorded);
+
+                // Execution order matches draw order. Failed chunks are dropped rather than executed unrecorded
+                std::erase(secondaries, VK_NULL_HANDLE);
+
+                return secondaries;
             }
 
             VkExtent2D view::get_extent() const noexcept
@@ -323,6 +687,11 @@ namespace blade
                     return swapchain.value()->get_extent();
                 }
 
+                if (!offscreen_targets.empty())
+                {
+                    return offscreen_targets.front()->extent();
+                }
+
                 return VkExtent2D{
                     .width = static_cast<u32>(viewport.width),
                     .height = static_cast<u32>(viewport.height),
@@ -336,71 +705,322 @@ namespace blade
             ) noexcept
             {
                 logger::info("Creating program");
-                static u16 program_handle_id = 1;
-
-                const auto& view = _views.find(framebuffer);
 
-                if (
-                    _shaders.find(vert) == _shaders.end()
-                    || _shaders.find(frag) == _shaders.end()
-                    || view == _views.end()
-                )
+                // Building the pipeline reads the view and the shaders, which only the frame thread may touch
+                const core::slot_id slot = _programs.reserve();
+                if (slot.is_null())
                 {
                     return {BLADE_NULL_HANDLE};
                 }
 
-                logger::info("Found program and shaders");
+                defer_creation_([this, slot, framebuffer, vert, frag]() {
+                    auto* view = _views.get(slot_of(framebuffer));
+                    const auto* vertex_shader = _shaders.get(slot_of(vert));
+                    const auto* fragment_shader = _shaders.get(slot_of(frag));
 
-                struct program program{
-                    .vertex = vert,
-                    .fragment = frag
-                };
+                    if (view == nullptr || vertex_shader == nullptr || fragment_shader == nullptr)
+                    {
+                        logger::error("CreateViewProgram {} framebuffer or shaders not found", slot.value);
+                        _programs.erase(slot);
+                        return;
+                    }
 
-                program_handle handle{program_handle_id};
+                    logger::info("Found program and shaders");
 
-                _programs.insert(std::make_pair(handle, program));
+                    struct program program{
+                        .vertex = vert,
+                        .fragment = frag
+                    };
 
-                view->second.create_program(program, _shaders.find(vert)->second, _shaders.find(frag)->second);
+                    _programs.insert(slot, program_resource{
+                        .program = program,
+                        .framebuffer = framebuffer,
+                    });
 
-                program_handle_id += 1;
+                    view->create_program(program, *vertex_shader, *fragment_shader);
+                });
 
-                return handle;
+                return {slot.value};
+            }
+
+            void vulkan_backend::destroy_shader(const shader_handle handle) noexcept
+            {
+                apply_pending_creations_();
+
+                auto* shader = _shaders.get(slot_of(handle));
+                if (shader == nullptr)
+                {
+                    logger::error("DestroyShader shader {} not found", handle.id);
+                    return;
+                }
+
+                // Views rebuild pipelines from the shader modules whenever a new render state is used
+                for (const auto& resource : _programs)
+                {
+                    if (resource.program.vertex == handle || resource.program.fragment == handle)
+                    {
+                        logger::error("DestroyShader shader {} is still used by a program", handle.id);
+                        return;
+                    }
+                }
+
+                _deletion_queue.push(_submit_batch->submitted_serial(), [shader = *shader]() mutable {
+                    shader.destroy();
+                });
+                _shaders.erase(slot_of(handle));
+            }
+
+            void vulkan_backend::destroy_view_program(const program_handle handle) noexcept
+            {
+                apply_pending_creations_();
+
+                const auto* resource = _programs.get(slot_of(handle));
+                if (resource == nullptr)
+                {
+                    logger::error("DestroyViewProgram program {} not found", handle.id);
+                    return;
+                }
+
+                if (auto* view = _views.get(slot_of(resource->framebuffer)))
+                {
+                    // Pipelines of the last submitted batch may still be executing
+                    _deletion_queue.push(_submit_batch->submitted_serial(), [pipelines = view->release_program()]() {
+                        for (const auto& pipeline : pipelines)
+                        {
+                            pipeline->destroy();
+                        }
+                    });
+                }
+
+                _programs.erase(slot_of(handle));
+            }
+
+            void vulkan_backend::destroy_buffer(const buffer_handle handle) noexcept
+            {
+                apply_pending_creations_();
+
+                const auto* resource = _buffers.get(slot_of(handle));
+                if (resource == nullptr)
+                {
+                    logger::error("DestroyBuffer buffer {} not found", handle.id);
+                    return;
+                }
+
+                for (auto&& view : _views)
+                {
+                    view.release_buffer(*resource->buffer);
+                }
+
+                _deletion_queue.push(_submit_batch->submitted_serial(), [resource = *resource, bindless = _bindless]() {
+                    resource.buffer->destroy();
+                    if (bindless)
+                    {
+                        // The descriptor can only be rewritten once no batch reads it
+                        bindless->release(bindless_set::binding::storage_buffers, resource.bindless_index);
+                    }
+                });
+                _buffers.erase(slot_of(handle));
+            }
+
+            void vulkan_backend::attach_vertex_buffer(const framebuffer_handle framebuffer, const buffer_handle handle) noexcept
+            {
+                apply_pending_creations_();
+
+                auto* view = _views.get(slot_of(framebuffer));
+                if (view == nullptr)
+                {
+                    logger::error("AttachVertexBuffer framebuffer not found");
+                    return;
+                }
+
+                const auto* resource = _buffers.get(slot_of(handle));
+                if (resource == nullptr || resource->usage != buffer_resource::usage::vertex)
+                {
+                    logger::error("AttachVertexBuffer vertex buffer {} not found", handle.id);
+                    return;
+                }
+
+                view->attach_vertex_buffer(resource->buffer);
+            }
+
+            void vulkan_backend::set_index_buffer(const framebuffer_handle framebuffer, const buffer_handle handle) noexcept
+            {
+                apply_pending_creations_();
+
+                auto* view = _views.get(slot_of(framebuffer));
+                if (view == nullptr)
+                {
+                    logger::error("SetIndexBuffer framebuffer not found");
+                    return;
+                }
+
+                const auto* resource = _buffers.get(slot_of(handle));
+                if (resource == nullptr || resource->usage != buffer_resource::usage::index)
+                {
+                    logger::error("SetIndexBuffer index buffer {} not found", handle.id);
+                    return;
+                }
+
+                view->set_index_buffer(resource->buffer);
+            }
+
+            void vulkan_backend::set_vertex_buffer(const framebuffer_handle framebuffer, const buffer_handle handle) noexcept
+            {
+                apply_pending_creations_();
+
+                auto* view = _views.get(slot_of(framebuffer));
+                if (view == nullptr)
+                {
+                    logger::error("SetVertexBuffer framebuffer not found");
+                    return;
+                }
+
+                const auto* resource = _buffers.get(slot_of(handle));
+                if (resource == nullptr || resource->usage != buffer_resource::usage::vertex)
+                {
+                    logger::error("SetVertexBuffer vertex buffer {} not found", handle.id);
+                    return;
+                }
+
+                view->set_vertex_buffer(resource->buffer);
+            }
+
+            u32 vulkan_backend::get_bindless_index(const buffer_handle handle) noexcept
+            {
+                apply_pending_creations_();
+
+                const auto* resource = _buffers.get(slot_of(handle));
+                if (resource == nullptr)
+                {
+                    return BLADE_INVALID_BINDLESS_INDEX;
+                }
+
+                return resource->bindless_index;
+            }
+
+            bool vulkan_backend::declare_push_constants(const framebuffer_handle framebuffer, const push_constant_range range) noexcept
+            {
+                auto* view = _views.get(slot_of(framebuffer));
+                if (view == nullptr)
+                {
+                    logger::error("DeclarePushConstants framebuffer not found");
+                    return false;
+                }
+
+                VkShaderStageFlags stages = 0;
+                if (range.stages & push_constant_range::stage::vertex)
+                {
+                    stages |= VK_SHADER_STAGE_VERTEX_BIT;
+                }
+                if (range.stages & push_constant_range::stage::fragment)
+                {
+                    stages |= VK_SHADER_STAGE_FRAGMENT_BIT;
+                }
+
+                return view->declare_push_constants(VkPushConstantRange{
+                    .stageFlags = stages,
+                    .offset = range.offset,
+                    .size = range.size,
+                });
+            }
+
+            void vulkan_backend::set_push_constants(const framebuffer_handle framebuffer, const void* data, u32 size, u32 offset) noexcept
+            {
+                auto* view = _views.get(slot_of(framebuffer));
+                if (view == nullptr)
+                {
+                    logger::error("SetPushConstants framebuffer not found");
+                    return;
+                }
+
+                view->set_push_constants(data, size, offset);
+            }
+
+            bool vulkan_backend::read_framebuffer(const framebuffer_handle framebuffer, u32 target, readback_callback callback) noexcept
+            {
+                auto* view = _views.get(slot_of(framebuffer));
+                if (view == nullptr)
+                {
+                    logger::error("ReadFramebuffer framebuffer not found");
+                    return false;
+                }
+
+                return view->read_framebuffer(target, std::move(callback));
             }
 
-            void vulkan_backend::attach_vertex_buffer(const buffer_handle handle) noexcept
+            void vulkan_backend::draw(const framebuffer_handle framebuffer, const draw_call& call) noexcept
             {
-                if (handle.index > _vertex_input_infos.size() - 1)
+                auto* view = _views.get(slot_of(framebuffer));
+                if (view == nullptr)
                 {
+                    logger::error("Draw framebuffer not found");
                     return;
                 }
 
-                // TODO: allow specifying of views
-                auto first_view = _views.begin();
-                if (first_view != _views.end())
+                view->draw(call);
+            }
+
+            void vulkan_backend::set_frame_pacing(const framebuffer_handle framebuffer, const frame_pacing& pacing) noexcept
+            {
+                auto* view = _views.get(slot_of(framebuffer));
+                if (view == nullptr)
                 {
-                    first_view->second.attach_vertex_buffer(_vertex_input_infos[handle]);
+                    logger::error("SetFramePacing framebuffer not found");
+                    return;
                 }
+
+                set_view_pacing_(*view, pacing);
+            }
+
+            void vulkan_backend::set_view_pacing_(class view& view, const frame_pacing& pacing) const noexcept
+            {
+                static constexpr present_mode present_modes[] = {
+                    present_mode::FIFO,
+                    present_mode::FIFO_RELAXED,
+                    present_mode::MAILBOX,
+                    present_mode::IMMEDIATE,
+                };
+
+                view.set_frame_pacing(
+                    present_modes[static_cast<u32>(pacing.mode)]
+                    , pacing.image_count
+                    , pacing.max_frame_rate
+                    , pacing.low_latency
+                );
             }
 
-            void vulkan_backend::set_index_buffer(const buffer_handle handle) noexcept
+            void vulkan_backend::defer_creation_(std::function<void()> creation) noexcept
             {
-                auto first_view = _views.begin();
-                if (first_view != _views.end())
+                auto* pending = new pending_creation{};
+                pending->create = std::move(creation);
+                _pending_creations.push(pending);
+            }
+
+            void vulkan_backend::apply_pending_creations_() noexcept
+            {
+                // Queued order is kept, so a program queued after its shaders finds them
+                while (pending_creation* pending = _pending_creations.pop())
                 {
-                    auto index = _index_input_infos[handle];
-                    if (!index)
-                        logger::error("NO INDEX");
-                    first_view->second.set_index_buffer(_index_input_infos[handle]);
+                    pending->create();
+                    delete pending;
                 }
             }
 
-            void vulkan_backend::set_vertex_buffer(const buffer_handle handle) noexcept
+            void vulkan_backend::register_bindless_buffer_(const core::slot_id slot, buffer_resource& resource) noexcept
             {
-                auto first_view = _views.begin();
-                if (first_view != _views.end())
+                if (!_bindless)
+                {
+                    return;
+                }
+
+                const auto index = _bindless->register_buffer(resource.buffer->handle());
+                if (!index.has_value())
                 {
-                    first_view->second.set_vertex_buffer(_vertex_input_infos[handle]);
+                    logger::error("Buffer {} has no bindless index", slot.value);
+                    return;
                 }
+
+                resource.bindless_index = index.value();
             }
 
             static const VkFormat vertex_formats[][4][2] =
@@ -444,94 +1064,119 @@ namespace blade
 
             buffer_handle vulkan_backend::create_index_buffer(const core::memory* memory) noexcept
             {
-                buffer_handle handle = {_buffer_handle_index};
-
+                // Buffers and staging memory only need the device. The copy needs the transfer queue, so it waits for the frame thread
                 const auto staging_buffer_opt = buffer::builder(_device)
                                                 .set_usage(VK_BUFFER_USAGE_TRANSFER_SRC_BIT)
                                                 .set_size(memory->size)
-                                                .set_allocation_callbacks(nullptr)
+                                                .set_allocation_callbacks(_host_allocator.callbacks())
                                                 .build();
 
                 if (!staging_buffer_opt.has_value())
                 {
                     logger::error("FAILED TO CREATE STAGING BUFFER");
+                    core::memory::release(memory);
                     return {BLADE_NULL_HANDLE};
                 }
 
+                // Nothing reads the caller's bytes after they reach staging memory, so they go back straight away
+                const usize size = memory->size;
                 const auto& staging_buffer = staging_buffer_opt.value();
                 staging_buffer->allocate(VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
                 staging_buffer->map_memory(memory->data);
+                core::memory::release(memory);
 
+                const VkBufferUsageFlags bindless_usage = _bindless ? VK_BUFFER_USAGE_STORAGE_BUFFER_BIT : 0;
                 const auto index_buffer_opt = buffer::builder(_device)
-                                              .set_size(memory->size)
+                                              .set_size(size)
                                               .set_usage(
-                                                  VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT)
-                                              .set_allocation_callbacks(nullptr)
+                                                  VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT
+                                                  | bindless_usage)
+                                              .set_allocation_callbacks(_host_allocator.callbacks())
                                               .build();
 
                 if (!index_buffer_opt.has_value())
                 {
+                    staging_buffer->destroy();
                     return {BLADE_NULL_HANDLE};
                 }
 
                 const auto& index_buffer = index_buffer_opt.value();
                 index_buffer->allocate(VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
 
-                class command_buffer command_buffer(_transfer_cmd_handler->acquire_command_buffer());
+                const core::slot_id slot = _buffers.reserve();
+                if (slot.is_null())
+                {
+                    staging_buffer->destroy();
+                    index_buffer->destroy();
+                    return {BLADE_NULL_HANDLE};
+                }
 
-                command_buffer.begin()
-                              ->begin_transfer()
-                              .copy_buffers(staging_buffer->handle(), index_buffer->handle(), memory->size);
+                defer_creation_([this, slot, staging_buffer, index_buffer, size]() {
+                    class command_buffer command_buffer(_transfer_cmd_handler->acquire_command_buffer());
 
-                command_buffer.end();
+                    command_buffer.begin()
+                                  ->begin_transfer()
+                                  .copy_buffers(staging_buffer->handle(), index_buffer->handle(), size);
 
-                VkResult submit_result = _transfer_cmd_handler->submit_buffer(
-                    command_buffer.handle()
-                    , _device->get_queue(queue_type::transfer).value()
-                );
-                _transfer_cmd_handler->update();
+                    command_buffer.end();
 
-                vkQueueWaitIdle(_device->get_queue(queue_type::transfer).value());
-                staging_buffer->destroy();
+                    VkResult submit_result = _transfer_cmd_handler->submit_buffer(
+                        command_buffer.handle()
+                        , _device->get_queue(queue_type::transfer).value()
+                    );
+                    _transfer_cmd_handler->update();
 
-                _index_input_infos[handle] = index_buffer;
+                    vkQueueWaitIdle(_device->get_queue(queue_type::transfer).value());
+                    staging_buffer->destroy();
 
-                _buffer_handle_index++;
-                logger::info("INDEX HANDLE: {}", handle.index);
-                return handle;
+                    auto* resource = _buffers.insert(slot, buffer_resource{
+                        .buffer = index_buffer,
+                        .usage = buffer_resource::usage::index,
+                    });
+                    register_bindless_buffer_(slot, *resource);
+                });
+
+                logger::info("INDEX HANDLE: {}", slot.value);
+                return {slot.value};
             }
 
             buffer_handle vulkan_backend::create_vertex_buffer(const core::memory* memory,
                                                                const vertex_layout& layout) noexcept
             {
-                buffer_handle handle{_buffer_handle_index};
-
+                // Same split as index buffers. The binding number is only known once the creation reaches the frame thread
                 const auto staging_buffer_opt = buffer::builder(_device)
                                                 .set_usage(VK_BUFFER_USAGE_TRANSFER_SRC_BIT)
                                                 .set_size(memory->size)
-                                                .set_allocation_callbacks(nullptr)
+                                                .set_allocation_callbacks(_host_allocator.callbacks())
                                                 .build();
 
                 if (!staging_buffer_opt.has_value())
                 {
                     logger::error("FAILED TO CREATE STAGING BUFFER");
+                    core::memory::release(memory);
                     return {BLADE_NULL_HANDLE};
                 }
 
+                // Nothing reads the caller's bytes after they reach staging memory, so they go back straight away
+                const usize size = memory->size;
                 const auto& staging_buffer = staging_buffer_opt.value();
                 staging_buffer->allocate(VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
                 staging_buffer->map_memory(memory->data);
+                core::memory::release(memory);
 
+                const VkBufferUsageFlags bindless_usage = _bindless ? VK_BUFFER_USAGE_STORAGE_BUFFER_BIT : 0;
                 const auto vertex_buffer_opt = buffer::builder(_device)
-                                               .set_size(memory->size)
+                                               .set_size(size)
                                                .set_usage(
-                                                   VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT)
-                                               .set_allocation_callbacks(nullptr)
+                                                   VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT
+                                                   | bindless_usage)
+                                               .set_allocation_callbacks(_host_allocator.callbacks())
                                                .build();
 
                 if (!vertex_buffer_opt.has_value())
                 {
                     logger::error("FAILED TO CREATE VERTEX BUFFER");
+                    staging_buffer->destroy();
                     return {BLADE_NULL_HANDLE};
                 }
 
@@ -539,54 +1184,67 @@ namespace blade
                 vertex_buffer->allocate(VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
                 logger::info("STRIDE: {}", layout.stride());
 
-                class command_buffer command_buffer(_transfer_cmd_handler->acquire_command_buffer());
-                command_buffer.begin()
-                              ->begin_transfer()
-                              .copy_buffers(staging_buffer->handle(), vertex_buffer->handle(), memory->size);
+                const core::slot_id slot = _buffers.reserve();
+                if (slot.is_null())
+                {
+                    staging_buffer->destroy();
+                    vertex_buffer->destroy();
+                    return {BLADE_NULL_HANDLE};
+                }
 
-                command_buffer.end();
+                defer_creation_([this, slot, staging_buffer, vertex_buffer, stride = layout.stride(), attributes = layout.attributes(), size]() {
+                    class command_buffer command_buffer(_transfer_cmd_handler->acquire_command_buffer());
+                    command_buffer.begin()
+                                  ->begin_transfer()
+                                  .copy_buffers(staging_buffer->handle(), vertex_buffer->handle(), size);
 
-                VkResult submit_result = _transfer_cmd_handler->submit_buffer(
-                    command_buffer.handle()
-                    , _device->get_queue(queue_type::transfer).value()
-                );
+                    command_buffer.end();
 
-                _transfer_cmd_handler->update();
-                vkQueueWaitIdle(_device->get_queue(queue_type::transfer).value());
+                    VkResult submit_result = _transfer_cmd_handler->submit_buffer(
+                        command_buffer.handle()
+                        , _device->get_queue(queue_type::transfer).value()
+                    );
 
-                vertex_buffer->set_input_binding_description(VkVertexInputBindingDescription{
-                    .binding = _num_bindings,
-                    .stride = layout.stride(),
-                    .inputRate = VK_VERTEX_INPUT_RATE_VERTEX,
-                });
+                    _transfer_cmd_handler->update();
+                    vkQueueWaitIdle(_device->get_queue(queue_type::transfer).value());
 
-                for (usize i = 0; i < layout.attributes().size(); i++)
-                {
-                    const attribute& attr = layout.attributes()[i];
-                    VkVertexInputAttributeDescription desc{
-                        .location = static_cast<u32>(attr.semantic),
+                    vertex_buffer->set_input_binding_description(VkVertexInputBindingDescription{
                         .binding = _num_bindings,
-                        .format = vertex_formats[static_cast<u32>(attr.type)][attr.count - 1][0],
-                        .offset = attr.offset
-                    };
+                        .stride = stride,
+                        .inputRate = VK_VERTEX_INPUT_RATE_VERTEX,
+                    });
 
-                    logger::debug("Attribute \"{}\" offset: {}, location: {}, format: {}"
-                                  , attr.name
-                                  , attr.offset
-                                  , static_cast<u32>(attr.semantic)
-                                  , vk_vertex_format_str(vertex_formats[static_cast<u32>(attr.type)][attr.count - 1][0])
-                    );
-                    vertex_buffer->add_input_attribute_description(desc);
-                }
+                    for (usize i = 0; i < attributes.size(); i++)
+                    {
+                        const attribute& attr = attributes[i];
+                        VkVertexInputAttributeDescription desc{
+                            .location = static_cast<u32>(attr.semantic),
+                            .binding = _num_bindings,
+                            .format = vertex_formats[static_cast<u32>(attr.type)][attr.count - 1][0],
+                            .offset = attr.offset
+                        };
+
+                        logger::debug("Attribute \"{}\" offset: {}, location: {}, format: {}"
+                                      , attr.name
+                                      , attr.offset
+                                      , static_cast<u32>(attr.semantic)
+                                      , vk_vertex_format_str(vertex_formats[static_cast<u32>(attr.type)][attr.count - 1][0])
+                        );
+                        vertex_buffer->add_input_attribute_description(desc);
+                    }
 
-                staging_buffer->destroy();
+                    staging_buffer->destroy();
 
-                _vertex_input_infos.insert(std::make_pair(handle, vertex_buffer));
+                    auto* resource = _buffers.insert(slot, buffer_resource{
+                        .buffer = vertex_buffer,
+                        .usage = buffer_resource::usage::vertex,
+                    });
+                    register_bindless_buffer_(slot, *resource);
 
-                _num_bindings++;
+                    _num_bindings++;
+                });
 
-                _buffer_handle_index++;
-                return handle;
+                return {slot.value};
             }
         } // vk namespace
     } // gfx namespace
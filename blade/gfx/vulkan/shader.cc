@@ -33,6 +33,7 @@ namespace blade
                     return std::nullopt;
                 }
 
+                shader_module._callbacks = info.callbacks;
                 return shader_module;
             }
 
@@ -43,7 +44,7 @@ namespace blade
                 return *this;
             }
 
-            shader::builder& shader::builder::set_code(const std::vector<u8>& code) noexcept
+            shader::builder& shader::builder::set_code(std::span<const u8> code) noexcept
             {
                 info.code = code;
 
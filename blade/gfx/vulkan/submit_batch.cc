@@ -0,0 +1,152 @@
+#include "gfx/vulkan/submit_batch.h"
+#include "gfx/vulkan/utils.h"
+#include "core/frame_arena.h"
+#include <algorithm>
+
+namespace blade
+{
+    namespace gfx
+    {
+        namespace vk
+        {
+            std::optional<VkFence> submit_batch::submit(VkQueue queue) noexcept
+            {
+                const auto fence_opt = acquire_fence_();
+                if (!fence_opt.has_value())
+                {
+                    _entries.clear();
+                    return std::nullopt;
+                }
+
+                // Every pointer handed to the queue points into `_entries`, which is not touched until the call returns
+                auto submit_infos = core::make_frame_vector<VkSubmitInfo>(_entries.size());
+                for (const auto& entry : _entries)
+                {
+                    const bool waits = entry.wait_semaphore != VK_NULL_HANDLE;
+                    const bool signals = entry.signal_semaphore != VK_NULL_HANDLE;
+
+                    submit_infos.push_back(VkSubmitInfo{
+                        .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+                        .waitSemaphoreCount = waits ? 1u : 0u,
+                        .pWaitSemaphores = waits ? &entry.wait_semaphore : nullptr,
+                        .pWaitDstStageMask = waits ? &entry.wait_stage : nullptr,
+                        .commandBufferCount = 1,
+                        .pCommandBuffers = &entry.command_buffer,
+                        .signalSemaphoreCount = signals ? 1u : 0u,
+                        .pSignalSemaphores = signals ? &entry.signal_semaphore : nullptr,
+                    });
+                }
+
+                const VkFence fence = fence_opt.value();
+                const VkResult result = vkQueueSubmit(queue, static_cast<u32>(submit_infos.size()), submit_infos.data(), fence);
+                _entries.clear();
+
+                if (result != VK_SUCCESS)
+                {
+                    logger::error("Failed to submit batch: {}", error_string(result));
+                    _free_fences.push_back(fence);
+                    return std::nullopt;
+                }
+
+                _submitted_serial++;
+                _in_flight_fences.push_back(in_flight{
+                    .fence = fence,
+                    .serial = _submitted_serial,
+                });
+
+                return fence;
+            }
+
+            u64 submit_batch::completed_serial() noexcept
+            {
+                poll_();
+                return _completed_serial;
+            }
+
+            bool submit_batch::wait_for_serial(u64 serial, u64 timeout) noexcept
+            {
+                if (completed_serial() >= serial)
+                {
+                    return true;
+                }
+
+                // Batches finish in order, so the oldest one at or past `serial` covers it
+                const VkDevice device = _device.lock()->handle();
+                for (const auto& batch : _in_flight_fences)
+                {
+                    if (batch.serial >= serial)
+                    {
+                        return vkWaitForFences(device, 1, &batch.fence, VK_TRUE, timeout) == VK_SUCCESS;
+                    }
+                }
+
+                return true;
+            }
+
+            void submit_batch::poll_() noexcept
+            {
+                const VkDevice device = _device.lock()->handle();
+
+                auto signaled = std::stable_partition(_in_flight_fences.begin(), _in_flight_fences.end(), [device](const in_flight& batch) {
+                    return vkGetFenceStatus(device, batch.fence) != VK_SUCCESS;
+                });
+
+                // Batches on one queue finish in submission order, so the newest signaled batch covers the older ones
+                for (auto it = signaled; it != _in_flight_fences.end(); ++it)
+                {
+                    _completed_serial = std::max(_completed_serial, it->serial);
+                    _free_fences.push_back(it->fence);
+                }
+                _in_flight_fences.erase(signaled, _in_flight_fences.end());
+            }
+
+            std::optional<VkFence> submit_batch::acquire_fence_() noexcept
+            {
+                const VkDevice device = _device.lock()->handle();
+
+                poll_();
+
+                if (!_free_fences.empty())
+                {
+                    const VkFence fence = _free_fences.back();
+                    _free_fences.pop_back();
+                    vkResetFences(device, 1, &fence);
+                    return fence;
+                }
+
+                const VkFenceCreateInfo fence_info{
+                    .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
+                };
+
+                VkFence fence{VK_NULL_HANDLE};
+                const VkResult result = vkCreateFence(device, &fence_info, _allocation_callbacks, &fence);
+                if (result != VK_SUCCESS)
+                {
+                    logger::error("Failed to create batch fence: {}", error_string(result));
+                    return std::nullopt;
+                }
+
+                return fence;
+            }
+
+            void submit_batch::destroy() noexcept
+            {
+                const VkDevice device = _device.lock()->handle();
+
+                for (const auto& batch : _in_flight_fences)
+                {
+                    vkDestroyFence(device, batch.fence, _allocation_callbacks);
+                }
+                for (const VkFence fence : _free_fences)
+                {
+                    vkDestroyFence(device, fence, _allocation_callbacks);
+                }
+
+                _in_flight_fences.clear();
+                _free_fences.clear();
+                _entries.clear();
+                _completed_serial = _submitted_serial;
+            }
+        } // vk namespace
+    } // gfx namespace
+} // blade namespace
@@ -70,8 +70,8 @@ namespace blade
                         return std::max<u32>(info.min_image_count, capabilities.minImageCount + 1);
 
                     default:
-                        return std::clamp<u32>(info.min_image_count, capabilities.minImageCount + 1,
-                                               capabilities.maxImageCount);
+                        return std::min<u32>(std::max<u32>(info.min_image_count, capabilities.minImageCount + 1),
+                                             capabilities.maxImageCount);
                     }
                 }();
 
@@ -89,6 +89,9 @@ namespace blade
                     return std::nullopt;
                 }
 
+                const VkImageUsageFlags image_usage = info.image_usage
+                    | (info.requested_image_usage & capabilities.supportedUsageFlags);
+
                 VkSwapchainCreateInfoKHR create_info{
                     .sType = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR,
                     .surface = info.surface.lock()->vk_surface,
@@ -97,7 +100,7 @@ namespace blade
                     .imageColorSpace = selected_format.colorSpace,
                     .imageExtent = selected_extent,
                     .imageArrayLayers = num_image_array_layers,
-                    .imageUsage = info.image_usage,
+                    .imageUsage = image_usage,
                 };
 
                 if (graphics_queue_index == present_queue_index)
@@ -131,6 +134,7 @@ namespace blade
                 }
 
                 swapchain->_format = selected_format.format;
+                swapchain->_usage = image_usage;
                 swapchain->_extent = selected_extent;
                 swapchain->_allocation_callbacks = info.allocation_callbacks;
 
@@ -189,6 +193,13 @@ namespace blade
                 return *this;
             }
 
+            swapchain::builder& swapchain::builder::request_image_usage(VkImageUsageFlags usage) noexcept
+            {
+                info.requested_image_usage |= usage;
+
+                return *this;
+            }
+
             swapchain::builder& swapchain::builder::set_composite_alpha(VkCompositeAlphaFlagBitsKHR alpha) noexcept
             {
                 info.composite_alpha = alpha;
@@ -203,6 +214,13 @@ namespace blade
                 return *this;
             }
 
+            swapchain::builder& swapchain::builder::set_old_swapchain(VkSwapchainKHR old_swapchain) noexcept
+            {
+                info.old_swapchain = old_swapchain;
+
+                return *this;
+            }
+
             swapchain::builder& swapchain::builder::set_clipped(VkBool32 clipped) noexcept
             {
                 info.clipped = clipped;
@@ -245,9 +263,10 @@ namespace blade
                         return available_present_mode;
                 }
 
-                logger::warn("Preferred present mode not found");
+                logger::warn("Preferred present mode not found. Falling back to FIFO");
 
-                return VK_PRESENT_MODE_IMMEDIATE_KHR;
+                // FIFO is the only mode every implementation has to support
+                return VK_PRESENT_MODE_FIFO_KHR;
             }
 
             VkExtent2D swapchain::builder::select_extent_(const VkSurfaceCapabilitiesKHR& capabilities) const noexcept
@@ -303,18 +322,28 @@ namespace blade
                 return images;
             }
 
-            std::optional<u32> swapchain::get_image_index(VkSemaphore semaphore, VkFence fence) const noexcept
+            std::optional<swapchain::acquired_image> swapchain::acquire_image(VkSemaphore semaphore, VkFence fence) const noexcept
             {
                 u32 index;
                 const u64 timeout = UINT64_MAX;
                 VkResult result = vkAcquireNextImageKHR(_device.lock()->handle(), handle(), timeout, semaphore, fence,
                                                         &index);
-                if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR)
+
+                // A suboptimal image is still acquired, so it has to be rendered and presented
+                if (result == VK_SUCCESS || result == VK_SUBOPTIMAL_KHR)
                 {
-                    return std::nullopt;
+                    return acquired_image{
+                        .index = index,
+                        .suboptimal = result == VK_SUBOPTIMAL_KHR,
+                    };
+                }
+
+                if (result != VK_ERROR_OUT_OF_DATE_KHR)
+                {
+                    logger::error("Failed to acquire swapchain image: {}", error_string(result));
                 }
 
-                return index;
+                return std::nullopt;
             }
 
 
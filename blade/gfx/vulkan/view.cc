@@ -1,7 +1,20 @@
 #include "gfx/vulkan/view.h"
 #include "gfx/program.h"
 #include "gfx/vulkan/command.h"
+#include "gfx/vulkan/platform.h"
+#include "gfx/vulkan/submit_batch.h"
+#include "gfx/vulkan/utils.h"
+#include "core/event.h"
+#include "core/fibers.h"
+#include "window/window.h"
 #include "submit.h"
+#include <algorithm>
+#include <chrono>
+#include <future>
+#include <limits>
+#include <thread>
+#include <utility>
+#include <vector>
 #include <vulkan/vulkan_core.h>
 
 namespace blade
@@ -10,44 +23,79 @@ namespace blade
     {
         namespace vk
         {
-            view::view(std::weak_ptr<class device> device, std::shared_ptr<class surface> surface) noexcept
+            view::view(std::weak_ptr<class device> device, std::shared_ptr<class surface> surface, VkAllocationCallbacks* callbacks) noexcept
                 : device{device}
                   , surface{surface}
+                  , allocation_callbacks{callbacks}
                   , pipeline_builder{std::make_unique<pipeline::builder>(device)}
-                  , cmd_handler{device, queue_type::graphics}
+                  , cmd_handler{device, queue_type::graphics, callbacks}
+                  , secondary_pools{device, queue_type::graphics, std::clamp(std::thread::hardware_concurrency(), 1u, max_recording_threads), callbacks}
+                  , readbacks{device}
             {
+                readbacks.set_allocation_callbacks(allocation_callbacks);
+                pipeline_builder->use_allocation_callbacks(allocation_callbacks);
             }
 
             std::optional<view> view::create(std::weak_ptr<class instance> instance, std::weak_ptr<class device> device,
-                                             const framebuffer_create_info info) noexcept
+                                             const framebuffer_create_info info, VkAllocationCallbacks* callbacks) noexcept
             {
-                const auto surface_opt = surface::create(instance, info);
-                if (!surface_opt.has_value())
+                std::shared_ptr<struct surface> surface { nullptr };
+                if (info.native_window_data)
                 {
-                    logger::error("Failed to create framebuffer");
-                    return std::nullopt;
+                    const auto surface_opt = surface::create(instance, info);
+                    if (!surface_opt.has_value())
+                    {
+                        logger::error("Failed to create framebuffer");
+                        return std::nullopt;
+                    }
+
+                    surface = surface_opt.value();
                 }
 
-                const auto& surface = surface_opt.value();
-                class view view(device, surface);
+                class view view(device, surface, callbacks);
 
                 if (info.native_window_data)
                 {
                     logger::info("Creating swapchain...");
                     view.create_swapchain_(info.width, info.height);
+                    view.subscribe_to_resize_(info.native_window_data.value());
 
                     logger::info("Swapchain created.");
                 }
+                else
+                {
+                    const u32 max_targets = device.lock()->get_physical_device().lock()->get_properties().limits.maxColorAttachments;
+                    if (info.color_targets == 0 || info.color_targets > max_targets)
+                    {
+                        logger::error("Offscreen framebuffer needs between 1 and {} color targets", max_targets);
+                        return std::nullopt;
+                    }
+
+                    view.offscreen_target_count = info.color_targets;
+                    view.offscreen_format = info.format;
+
+                    logger::info("Creating {} offscreen color targets...", info.color_targets);
+                    if (!view.create_offscreen_targets_(info.width, info.height))
+                    {
+                        logger::error("Failed to create offscreen color targets");
+                        return std::nullopt;
+                    }
+
+                    view.set_viewport(0.f, 0.f, info.width, info.height);
+                    logger::info("Offscreen color targets created.");
+                }
 
                 view.cached_width = info.width.w;
                 view.cached_height = info.height.h;
                 view.cached_width_prev = info.width.w;
                 view.cached_height_prev = info.height.h;
 
+                view.depth_format = view.find_depth_format_();
                 (void)view.create_renderpass_();
                 view.pipeline_builder
                     // ->set_extent(view.get_extent())
-                    ->add_viewport(VkViewport{
+                    ->set_color_attachment_count(view.color_attachment_count_())
+                    .add_viewport(VkViewport{
                         .x = 0.0f,
                         .y = 0.0f,
                         .width = static_cast<f32>(view.get_extent().width),
@@ -69,10 +117,10 @@ namespace blade
                 };
 
                 const VkResult image_available_sem_result = vkCreateSemaphore(
-                    device.lock()->handle(), &semaphore_info, nullptr, &view.image_available_semaphore);
+                    device.lock()->handle(), &semaphore_info, view.allocation_callbacks, &view.image_available_semaphore);
                 const VkResult render_finished_sem_result = vkCreateSemaphore(
-                    device.lock()->handle(), &semaphore_info, nullptr, &view.render_finished_semaphore);
-                const VkResult fence_result = vkCreateFence(device.lock()->handle(), &fence_info, nullptr,
+                    device.lock()->handle(), &semaphore_info, view.allocation_callbacks, &view.render_finished_semaphore);
+                const VkResult fence_result = vkCreateFence(device.lock()->handle(), &fence_info, view.allocation_callbacks,
                                                             &view.in_flight_fence);
 
                 if (image_available_sem_result != VK_SUCCESS
@@ -96,13 +144,29 @@ namespace blade
                     return swapchain.value()->get_format();
                 }
 
-                // TODO: This is random and will 99.99% not work
-                return VK_FORMAT_R8_SINT;
+                switch (offscreen_format)
+                {
+                    case texture_format::rgba8:   return VK_FORMAT_R8G8B8A8_UNORM;
+                    case texture_format::bgra8:   return VK_FORMAT_B8G8R8A8_UNORM;
+                    case texture_format::rgba16f: return VK_FORMAT_R16G16B16A16_SFLOAT;
+                    case texture_format::rgba32f: return VK_FORMAT_R32G32B32A32_SFLOAT;
+                }
+
+                return VK_FORMAT_R8G8B8A8_UNORM;
+            }
+
+            u32 view::color_attachment_count_() const noexcept
+            {
+                return swapchain.has_value() ? 1 : offscreen_target_count;
             }
 
             bool view::create_renderpass_() noexcept
             {
-                VkAttachmentDescription color_attachment{
+                const bool offscreen = !swapchain.has_value();
+                const u32 attachment_count = color_attachment_count_();
+
+                // Offscreen targets are left ready to be copied out instead of presented
+                const VkAttachmentDescription color_attachment{
                     .format = get_format_(),
                     .samples = VK_SAMPLE_COUNT_1_BIT,
                     .loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR,
@@ -110,39 +174,247 @@ namespace blade
                     .stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE,
                     .stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE,
                     .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
-                    .finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR
+                    .finalLayout = offscreen ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR
                 };
 
-                VkAttachmentReference color_attachment_reference{
-                    .attachment = 0,
-                    .layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+                std::vector<VkAttachmentReference> color_attachment_references{};
+                for (u32 i = 0; i < attachment_count; i++)
+                {
+                    color_attachment_references.push_back(VkAttachmentReference{
+                        .attachment = i,
+                        .layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+                    });
+                }
+
+                // Cleared every frame and never read back, so nothing from the previous frame is kept
+                const VkAttachmentDescription depth_attachment{
+                    .format = depth_format,
+                    .samples = VK_SAMPLE_COUNT_1_BIT,
+                    .loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR,
+                    .storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE,
+                    .stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE,
+                    .stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE,
+                    .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+                    .finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL
+                };
+
+                const VkAttachmentReference depth_attachment_reference{
+                    .attachment = attachment_count,
+                    .layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
                 };
 
                 VkSubpassDescription subpass{
                     .pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS,
-                    .colorAttachmentCount = 1,
-                    .pColorAttachments = &color_attachment_reference,
+                    .colorAttachmentCount = attachment_count,
+                    .pColorAttachments = color_attachment_references.data(),
+                    .pDepthStencilAttachment = &depth_attachment_reference,
                 };
 
+                // Frames in flight share the depth target, so the clear waits for the previous frame's depth tests
                 VkSubpassDependency dependency{
                     .srcSubpass = VK_SUBPASS_EXTERNAL,
                     .dstSubpass = 0,
-                    .srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
-                    .dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
-                    .srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
-                    .dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+                    .srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+                    .dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT,
+                    .srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+                    .dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+                };
+
+                auto builder = renderpass::builder(device);
+                builder
+                    .use_allocation_callbacks(allocation_callbacks)
+                    .add_subpass_description(subpass)
+                    .add_subpass_dependency(dependency);
+
+                for (u32 i = 0; i < attachment_count; i++)
+                {
+                    builder.add_attachment(color_attachment);
+                }
+                builder.add_attachment(depth_attachment);
+
+                if (offscreen)
+                {
+                    // Readback copies recorded after the pass must see the finished color writes
+                    builder.add_subpass_dependency(VkSubpassDependency{
+                        .srcSubpass = 0,
+                        .dstSubpass = VK_SUBPASS_EXTERNAL,
+                        .srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                        .dstStageMask = VK_PIPELINE_STAGE_TRANSFER_BIT,
+                        .srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+                        .dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT,
+                    });
+                }
+
+                auto renderpass_opt = builder.build();
+                if (!renderpass_opt.has_value())
+                {
+                    logger::error("Failed to create renderpass");
+                    return false;
+                }
+
+                renderpass = renderpass_opt.value();
+
+                return true;
+            }
+
+            bool view::create_offscreen_targets_(struct width width, struct height height) noexcept
+            {
+                for (u32 i = 0; i < offscreen_target_count; i++)
+                {
+                    auto image_opt = image::builder(device)
+                                     .set_format(get_format_())
+                                     .set_extent(width, height)
+                                     .set_usage(VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT)
+                                     .set_allocation_callbacks(allocation_callbacks)
+                                     .build();
+
+                    if (!image_opt.has_value())
+                    {
+                        destroy_offscreen_targets_();
+                        return false;
+                    }
+
+                    offscreen_targets.push_back(image_opt.value());
+                }
+
+                return true;
+            }
+
+            bool view::recreate_offscreen_targets_(struct width width, struct height height) noexcept
+            {
+                logger::trace("Recreating offscreen targets {} by {}", width.w, height.h);
+
+                // Frames still in flight keep rendering into the old targets until they are released
+                retired_targets.push_back(retired_target{
+                    .serial = cmd_handler.submitted_serial(),
+                    .images = std::move(offscreen_targets),
+                    .framebuffers = std::move(framebuffers),
+                });
+                offscreen_targets.clear();
+                framebuffers.clear();
+                retire_depth_target_();
+
+                // Queued copies were sized for the old targets
+                readbacks.cancel_queued();
+
+                if (!create_offscreen_targets_(width, height))
+                {
+                    logger::error("Offscreen targets not recreated!");
+                    return false;
+                }
+
+                return create_framebuffers();
+            }
+
+            void view::destroy_offscreen_targets_() noexcept
+            {
+                for (auto&& target : offscreen_targets)
+                {
+                    target->destroy();
+                }
+                offscreen_targets.clear();
+            }
+
+            VkFormat view::find_depth_format_() const noexcept
+            {
+                // `D16_UNORM` is always supported as a depth attachment, so the search cannot come up empty
+                constexpr std::array candidates{
+                    VK_FORMAT_D32_SFLOAT,
+                    VK_FORMAT_X8_D24_UNORM_PACK32,
+                    VK_FORMAT_D16_UNORM,
                 };
 
-                renderpass = renderpass::builder(device)
-                             .add_subpass_description(subpass)
-                             .add_attachment(color_attachment)
-                             .add_subpass_dependency(dependency)
-                             .build()
-                             .value();
+                const VkPhysicalDevice physical_device = device.lock()->get_physical_device().lock()->handle();
+                for (const VkFormat format : candidates)
+                {
+                    VkFormatProperties properties{};
+                    vkGetPhysicalDeviceFormatProperties(physical_device, format, &properties);
+                    if (properties.optimalTilingFeatures & VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT)
+                    {
+                        return format;
+                    }
+                }
+
+                return VK_FORMAT_D16_UNORM;
+            }
 
+            bool view::create_depth_target_() noexcept
+            {
+                const VkExtent2D extent = get_extent();
+                auto image_opt = image::builder(device)
+                                 .set_format(depth_format)
+                                 .set_extent(width(extent.width), height(extent.height))
+                                 .set_usage(VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT)
+                                 .set_allocation_callbacks(allocation_callbacks)
+                                 .build();
+
+                if (!image_opt.has_value())
+                {
+                    logger::error("Failed to create depth target");
+                    return false;
+                }
+
+                depth_target = image_opt.value();
                 return true;
             }
 
+            void view::retire_depth_target_() noexcept
+            {
+                if (!depth_target)
+                {
+                    return;
+                }
+
+                // Frames still in flight test against it until the retired targets are released
+                retired_targets.push_back(retired_target{
+                    .serial = cmd_handler.submitted_serial(),
+                    .images = { std::move(depth_target) },
+                });
+                depth_target = nullptr;
+            }
+
+            std::optional<texture_format> view::readback_format_() const noexcept
+            {
+                if (!swapchain.has_value())
+                {
+                    return offscreen_format;
+                }
+
+                switch (swapchain.value()->get_format())
+                {
+                    case VK_FORMAT_R8G8B8A8_UNORM:
+                    case VK_FORMAT_R8G8B8A8_SRGB:       return texture_format::rgba8;
+                    case VK_FORMAT_B8G8R8A8_UNORM:
+                    case VK_FORMAT_B8G8R8A8_SRGB:       return texture_format::bgra8;
+                    case VK_FORMAT_R16G16B16A16_SFLOAT: return texture_format::rgba16f;
+                    default:                            return std::nullopt;
+                }
+            }
+
+            bool view::read_framebuffer(u32 target, readback_callback callback) noexcept
+            {
+                if (target >= color_attachment_count_())
+                {
+                    logger::error("Readback target {} does not exist. The framebuffer has {} targets", target, color_attachment_count_());
+                    return false;
+                }
+
+                if (swapchain.has_value() && (swapchain.value()->get_usage() & VK_IMAGE_USAGE_TRANSFER_SRC_BIT) == 0)
+                {
+                    logger::error("The surface does not allow copying swapchain images");
+                    return false;
+                }
+
+                const auto format = readback_format_();
+                if (!format.has_value())
+                {
+                    logger::error("Swapchain format {} cannot be read back", static_cast<u32>(swapchain.value()->get_format()));
+                    return false;
+                }
+
+                return readbacks.request(target, get_extent(), format.value(), std::move(callback));
+            }
+
             void view::attach_vertex_buffer(std::weak_ptr<class buffer> buffer) noexcept
             {
                 logger::info("Attaching vertex buffer");
@@ -165,28 +437,97 @@ namespace blade
                 this->index_buffer = index_buffer;
             }
 
+            void view::use_bindless(std::weak_ptr<bindless_set> set) noexcept
+            {
+                bindless = set;
+                pipeline_builder->add_pipeline_layout_descriptor_set(set.lock()->layout());
+
+                const u32 limit = device.lock()->get_physical_device().lock()->get_properties().limits.maxPushConstantsSize;
+                if (push_constants.reserve(bindless_set::push_constant_range(), limit))
+                {
+                    pipeline_builder->set_pipeline_layout_push_constants(push_constants.ranges());
+                }
+            }
+
+            bool view::declare_push_constants(const VkPushConstantRange range) noexcept
+            {
+                if (graphics_pipeline)
+                {
+                    logger::error("Push constants must be declared before the program is created");
+                    return false;
+                }
+
+                const u32 limit = device.lock()->get_physical_device().lock()->get_properties().limits.maxPushConstantsSize;
+                if (!push_constants.declare(range, limit))
+                {
+                    return false;
+                }
+
+                // Declaring may widen ranges declared earlier, so the layout takes the whole list again
+                pipeline_builder->set_pipeline_layout_push_constants(push_constants.ranges());
+
+                return true;
+            }
+
+            void view::draw(const draw_call& call) noexcept
+            {
+                // Draws queued without a state change in between share one entry
+                if (!render_state_captured)
+                {
+                    draw_states.push_back(draw_state{
+                        .state = render_state,
+                        .pipeline_key = pipeline_key_(render_state),
+                    });
+                    render_state_captured = true;
+                }
+
+                draws.push_back(queued_draw{
+                    .call = call,
+                    .push_constants = push_constants.capture(push_captures),
+                    .state = static_cast<u32>(draw_states.size() - 1),
+                });
+            }
+
+            void view::set_push_constants(const void* data, u32 size, u32 offset) noexcept
+            {
+                if (!push_constants.write(data, size, offset))
+                {
+                    logger::warn("Dropped push constant write at offset {}", offset);
+                }
+            }
+
             bool view::recreate_swapchain_(struct width width, struct height height) noexcept
             {
                 logger::trace("Recreating swapchain {} by {}", width.w, height.h);
-                vkDeviceWaitIdle(device.lock()->handle());
-                destroy_framebuffers_();
 
-                swapchain.value()->destroy();
-                swapchain = swapchain::builder(device, surface)
-                            .set_allocation_callbacks(nullptr)
-                            .set_composite_alpha(VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR)
-                            .require_image_usage(VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT)
-                            .set_clipped(VK_TRUE)
-                            .set_extent(width, height)
-                            .prefer_present_mode(present_mode::MAILBOX)
-                            .build();
+                // Handing the old swapchain to the new one lets the presentation engine finish with its images
+                // while the new ones are created. Only this view's submissions have to finish before it goes
+                auto old_swapchain = std::move(swapchain.value());
+                auto old_framebuffers = std::move(framebuffers);
+                framebuffers.clear();
 
-                if (!swapchain.has_value())
+                if (!create_swapchain_(width, height, old_swapchain->handle()))
                 {
                     logger::error("Swapchain not recreated!");
+                    swapchain = std::move(old_swapchain);
+                    framebuffers = std::move(old_framebuffers);
                     return false;
                 }
 
+                retired_targets.push_back(retired_target{
+                    .serial = cmd_handler.submitted_serial(),
+                    .swapchain = std::move(old_swapchain),
+                    .framebuffers = std::move(old_framebuffers),
+                });
+                retire_depth_target_();
+
+                // Present ids belong to the swapchain they were presented to, and the new one may pace differently
+                first_present_id = present_id + 1;
+                pacer.reset();
+
+                // Queued copies were sized for the old images
+                readbacks.cancel_queued();
+
                 bool framebuffer_result = create_framebuffers();
                 if (!framebuffer_result)
                 {
@@ -196,15 +537,18 @@ namespace blade
                 return true;
             }
 
-            bool view::create_swapchain_(struct width width, struct height height) noexcept
+            bool view::create_swapchain_(struct width width, struct height height, VkSwapchainKHR old_swapchain) noexcept
             {
                 swapchain = swapchain::builder(device, surface)
-                            .set_allocation_callbacks(nullptr)
+                            .set_allocation_callbacks(allocation_callbacks)
                             .set_composite_alpha(VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR)
                             .require_image_usage(VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT)
+                            .request_image_usage(VK_IMAGE_USAGE_TRANSFER_SRC_BIT)
                             .set_clipped(VK_TRUE)
                             .set_extent(width, height)
-                            .prefer_present_mode(present_mode::MAILBOX)
+                            .prefer_present_mode(preferred_present_mode)
+                            .request_min_image_count(min_image_count)
+                            .set_old_swapchain(old_swapchain)
                             .build();
 
                 if (!swapchain.has_value())
@@ -215,6 +559,53 @@ namespace blade
                 return true;
             }
 
+            void view::subscribe_to_resize_(const struct framebuffer_create_info::native_window_data window) noexcept
+            {
+                resize_requests->window = window;
+
+                std::weak_ptr<resize_request> weak_request = resize_requests;
+                resize_subscription = events::subscribe<events::window_resize<blade::window>>([weak_request](const events::window_resize<blade::window>& e) {
+                    auto request = weak_request.lock();
+                    if (!request || !platform::same_window(request->window.value(), e.window.get_window_handle()))
+                    {
+                        return false;
+                    }
+
+                    request->width.store(e.width, std::memory_order_relaxed);
+                    request->height.store(e.height, std::memory_order_relaxed);
+                    request->pending.store(true, std::memory_order_release);
+
+                    return true;
+                });
+            }
+
+            void view::release_retired_targets_(const u64 completed_serial) noexcept
+            {
+                std::erase_if(retired_targets, [this, completed_serial](retired_target& retired) {
+                    if (retired.serial > completed_serial)
+                    {
+                        return false;
+                    }
+
+                    for (const auto& framebuffer : retired.framebuffers)
+                    {
+                        vkDestroyFramebuffer(device.lock()->handle(), framebuffer, allocation_callbacks);
+                    }
+
+                    for (auto&& image : retired.images)
+                    {
+                        image->destroy();
+                    }
+
+                    if (retired.swapchain)
+                    {
+                        retired.swapchain->destroy();
+                    }
+
+                    return true;
+                });
+            }
+
             void view::set_viewport(f32 x, f32 y, struct width width, struct height height) noexcept
             {
                 if (cached_width != width.w || cached_height != height.h)
@@ -237,15 +628,288 @@ namespace blade
                                       const shader& fragment) noexcept
             {
                 this->program = program;
-                graphics_pipeline = pipeline_builder
-                                    ->add_shader(shader::type::vertex, vertex.handle())
-                                    .add_shader(shader::type::fragment, fragment.handle())
-                                    .add_renderpass(renderpass->handle())
-                                    .add_dynamic_state(VK_DYNAMIC_STATE_VIEWPORT)
-                                    .add_dynamic_state(VK_DYNAMIC_STATE_SCISSOR)
-                                    .build().value();
+                pipeline_builder
+                    ->add_shader(shader::type::vertex, vertex.handle())
+                    .add_shader(shader::type::fragment, fragment.handle())
+                    .add_renderpass(renderpass->handle())
+                    .add_dynamic_state(VK_DYNAMIC_STATE_VIEWPORT)
+                    .add_dynamic_state(VK_DYNAMIC_STATE_SCISSOR);
+
+                // Everything the device can set while recording is left out of the pipeline key
+                const auto& features = device.lock()->get_enabled_features();
+                if (features.extended_dynamic_state)
+                {
+                    pipeline_builder
+                        ->add_dynamic_state(VK_DYNAMIC_STATE_CULL_MODE_EXT)
+                        .add_dynamic_state(VK_DYNAMIC_STATE_FRONT_FACE_EXT)
+                        .add_dynamic_state(VK_DYNAMIC_STATE_PRIMITIVE_TOPOLOGY_EXT)
+                        .add_dynamic_state(VK_DYNAMIC_STATE_DEPTH_TEST_ENABLE_EXT)
+                        .add_dynamic_state(VK_DYNAMIC_STATE_DEPTH_WRITE_ENABLE_EXT)
+                        .add_dynamic_state(VK_DYNAMIC_STATE_DEPTH_COMPARE_OP_EXT);
+                }
+                if (features.extended_dynamic_state2)
+                {
+                    pipeline_builder->add_dynamic_state(VK_DYNAMIC_STATE_PRIMITIVE_RESTART_ENABLE_EXT);
+                }
+                if (features.extended_dynamic_state3)
+                {
+                    pipeline_builder
+                        ->add_dynamic_state(VK_DYNAMIC_STATE_POLYGON_MODE_EXT)
+                        .add_dynamic_state(VK_DYNAMIC_STATE_COLOR_BLEND_ENABLE_EXT);
+                }
 
-                return true;
+                graphics_pipeline = find_or_build_pipeline_();
+
+                return graphics_pipeline != nullptr;
+            }
+
+            std::vector<std::shared_ptr<class pipeline>> view::release_program() noexcept
+            {
+                std::vector<std::shared_ptr<class pipeline>> released{};
+
+                // The links compile against the libraries handed out below, which are destroyed once the GPU is done
+                finish_pipeline_links();
+
+                for (auto&& pipeline : pipelines)
+                {
+                    released.push_back(pipeline.second);
+                }
+                pipelines.clear();
+
+                for (auto&& cache : pipeline_libraries)
+                {
+                    for (auto&& library : cache)
+                    {
+                        released.push_back(library.second);
+                    }
+                    cache.clear();
+                }
+
+                graphics_pipeline = nullptr;
+                program = {};
+                pipeline_builder->clear_program();
+
+                return released;
+            }
+
+            void view::release_buffer(const class buffer& released) noexcept
+            {
+                if (auto vertex_buffer = buffer.lock(); vertex_buffer && vertex_buffer->handle() == released.handle())
+                {
+                    logger::warn("Vertex buffer destroyed while bound to a framebuffer");
+                    buffer.reset();
+                }
+
+                if (index_buffer && index_buffer->handle() == released.handle())
+                {
+                    logger::warn("Index buffer destroyed while bound to a framebuffer");
+                    index_buffer = nullptr;
+                }
+            }
+
+            void view::set_render_state(const struct dynamic_state& state) noexcept
+            {
+                render_state_captured = render_state_captured && render_state == state;
+                render_state = state;
+
+                if (pipelines.empty())
+                {
+                    // No program yet. The state is picked up when it is created
+                    return;
+                }
+
+                auto pipeline = find_or_build_pipeline_();
+                if (pipeline)
+                {
+                    graphics_pipeline = pipeline;
+                }
+            }
+
+            pipeline::libraries_keys view::pipeline_part_keys_(const struct dynamic_state& state) const noexcept
+            {
+                const auto& features = device.lock()->get_enabled_features();
+                pipeline::libraries_keys keys{};
+
+                u32& vertex_input = keys[static_cast<u32>(pipeline::library_part::vertex_input)];
+                u32& pre_rasterization = keys[static_cast<u32>(pipeline::library_part::pre_rasterization)];
+                u32& fragment_shader = keys[static_cast<u32>(pipeline::library_part::fragment_shader)];
+                u32& fragment_output = keys[static_cast<u32>(pipeline::library_part::fragment_output)];
+
+                if (features.extended_dynamic_state)
+                {
+                    // Dynamic topology must stay within the class the pipeline was built with
+                    vertex_input = state.topology == VK_PRIMITIVE_TOPOLOGY_POINT_LIST ? 0
+                                 : state.topology <= VK_PRIMITIVE_TOPOLOGY_LINE_STRIP ? 1
+                                 : 2;
+                }
+                else
+                {
+                    vertex_input = state.topology;
+                    pre_rasterization = state.cull_mode | (state.front_face << 2);
+                    fragment_shader = state.depth_test | (state.depth_write << 1) | (state.depth_compare << 2);
+                }
+
+                if (!features.extended_dynamic_state2)
+                {
+                    vertex_input |= state.primitive_restart << 4;
+                }
+
+                if (!features.extended_dynamic_state3)
+                {
+                    pre_rasterization |= state.polygon_mode << 3;
+                    fragment_output = state.blend;
+                }
+
+                return keys;
+            }
+
+            u32 view::pipeline_key_(const struct dynamic_state& state) const noexcept
+            {
+                const auto keys = pipeline_part_keys_(state);
+
+                // Every part key fits in a byte
+                u32 key = 0;
+                for (u32 i = 0; i < keys.size(); i++)
+                {
+                    key |= (keys[i] & 0xff) << (i * 8);
+                }
+
+                return key;
+            }
+
+            std::shared_ptr<class pipeline> view::find_or_build_pipeline_() noexcept
+            {
+                const u32 key = pipeline_key_(render_state);
+
+                const auto pipeline_it = pipelines.find(key);
+                if (pipeline_it != pipelines.end())
+                {
+                    return pipeline_it->second;
+                }
+
+                pipeline_builder->set_dynamic_state_values(render_state);
+
+                if (device.lock()->get_enabled_features().graphics_pipeline_library)
+                {
+                    return link_pipeline_(key);
+                }
+
+                auto pipeline_opt = pipeline_builder->build();
+                if (!pipeline_opt.has_value())
+                {
+                    logger::error("Failed to build graphics pipeline for state key {}", key);
+                    return nullptr;
+                }
+
+                logger::info("Built graphics pipeline {} for state key {}", pipelines.size(), key);
+                pipelines.insert(std::make_pair(key, pipeline_opt.value()));
+
+                return pipeline_opt.value();
+            }
+
+            std::shared_ptr<class pipeline> view::link_pipeline_(const u32 key) noexcept
+            {
+                const auto part_keys = pipeline_part_keys_(render_state);
+
+                // Only parts whose state changed are compiled. The rest are reused from earlier links
+                pipeline::libraries parts{};
+                for (u32 i = 0; i < parts.size(); i++)
+                {
+                    auto& cache = pipeline_libraries[i];
+                    const auto library_it = cache.find(part_keys[i]);
+                    if (library_it != cache.end())
+                    {
+                        parts[i] = library_it->second;
+                        continue;
+                    }
+
+                    auto library_opt = pipeline_builder->build_library(static_cast<pipeline::library_part>(i));
+                    if (!library_opt.has_value())
+                    {
+                        return nullptr;
+                    }
+
+                    parts[i] = library_opt.value();
+                    cache.insert(std::make_pair(part_keys[i], parts[i]));
+                }
+
+                auto fast_opt = pipeline::link(device, parts, false, allocation_callbacks);
+                if (!fast_opt.has_value())
+                {
+                    return nullptr;
+                }
+
+                logger::info("Fast-linked graphics pipeline for state key {}", key);
+                pipelines.insert(std::make_pair(key, fast_opt.value()));
+
+                std::weak_ptr<const class device> link_device = device;
+                VkAllocationCallbacks* callbacks = allocation_callbacks;
+                pending_links.push_back(pending_link{
+                    .key = key,
+                    .result = std::async(std::launch::async, [link_device, parts, callbacks]() {
+                        return pipeline::link(link_device, parts, true, callbacks);
+                    }),
+                });
+
+                return fast_opt.value();
+            }
+
+            void view::finish_pipeline_links() noexcept
+            {
+                for (auto&& link : pending_links)
+                {
+                    // Never bound, so nothing in flight can reference it
+                    auto optimized_opt = link.result.get();
+                    if (optimized_opt.has_value())
+                    {
+                        optimized_opt.value()->destroy();
+                    }
+                }
+                pending_links.clear();
+            }
+
+            void view::update_pipeline_links_() noexcept
+            {
+                for (auto it = pending_links.begin(); it != pending_links.end();)
+                {
+                    if (it->result.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+                    {
+                        ++it;
+                        continue;
+                    }
+
+                    auto optimized_opt = it->result.get();
+                    if (optimized_opt.has_value())
+                    {
+                        auto& slot = pipelines[it->key];
+                        if (graphics_pipeline == slot)
+                        {
+                            graphics_pipeline = optimized_opt.value();
+                        }
+
+                        // Command buffers still in flight may reference the fast-linked pipeline
+                        retired_pipelines.push_back(retired_pipeline{
+                            .serial = cmd_handler.submitted_serial(),
+                            .pipeline = slot,
+                        });
+                        slot = optimized_opt.value();
+
+                        logger::info("Swapped in optimized graphics pipeline for state key {}", it->key);
+                    }
+
+                    it = pending_links.erase(it);
+                }
+
+                const u64 completed = cmd_handler.completed_serial();
+                std::erase_if(retired_pipelines, [completed](retired_pipeline& retired) {
+                    if (retired.serial > completed)
+                    {
+                        return false;
+                    }
+
+                    retired.pipeline->destroy();
+                    return true;
+                });
             }
 
             void view::destroy_framebuffers_() noexcept
@@ -259,6 +923,11 @@ namespace blade
             bool view::create_framebuffers() noexcept
             {
                 framebuffers.clear();
+                if (!depth_target && !create_depth_target_())
+                {
+                    return false;
+                }
+
                 usize num_images = 1;
                 if (swapchain.has_value())
                 {
@@ -268,17 +937,27 @@ namespace blade
                 for (usize i = 0; i < num_images; i++)
                 {
                     logger::info("Creating Vulkan Framebuffer {}", i);
-                    std::array<VkImageView, 1> attachments = {
-                        swapchain.value().get()->get_image_view(i)
-                    };
+                    std::vector<VkImageView> attachments{};
+                    if (swapchain.has_value())
+                    {
+                        attachments.push_back(swapchain.value().get()->get_image_view(i));
+                    }
+                    else
+                    {
+                        for (const auto& target : offscreen_targets)
+                        {
+                            attachments.push_back(target->view());
+                        }
+                    }
+                    attachments.push_back(depth_target->view());
 
                     VkFramebufferCreateInfo framebuffer_info{
                         .sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO,
                         .renderPass = renderpass->handle(),
                         .attachmentCount = static_cast<u32>(attachments.size()),
                         .pAttachments = attachments.data(),
-                        .width = swapchain.value().get()->get_extent().width,
-                        .height = swapchain.value().get()->get_extent().height,
+                        .width = get_extent().width,
+                        .height = get_extent().height,
                         .layers = 1
                     };
 
@@ -306,95 +985,275 @@ namespace blade
                 return true;
             }
 
-            void view::frame() noexcept
+            std::optional<view::recorded_frame> view::record_frame() noexcept
             {
-                const u32 fence_count = 1;
-                const VkBool32 wait_all = VK_TRUE;
-                const u64 timeout = UINT64_MAX;
+                update_pipeline_links_();
+                const u64 completed_serial = cmd_handler.completed_serial();
+                release_retired_targets_(completed_serial);
+                secondary_pools.release(completed_serial);
+
+                // Draws queued for a frame that is skipped are dropped with it
+                recording_draws.clear();
+                std::swap(recording_draws, draws);
+                recording_push_captures.clear();
+                std::swap(recording_push_captures, push_captures);
+                push_constants.restart_captures();
+                recording_draw_states.clear();
+                std::swap(recording_draw_states, draw_states);
+                render_state_captured = false;
+
+                // Only the last size of a burst of resize events is used
+                if (resize_requests->pending.exchange(false, std::memory_order_acquire))
+                {
+                    cached_width = resize_requests->width.load(std::memory_order_relaxed);
+                    cached_height = resize_requests->height.load(std::memory_order_relaxed);
+                }
+
+                // Minimized windows have nothing to render into
+                if (cached_width == 0 || cached_height == 0)
+                {
+                    return std::nullopt;
+                }
+
+                // Resizes are handled before anything is acquired, so no image or command buffer is left dangling
+                if (cached_width != cached_width_prev || cached_height != cached_height_prev || swapchain_out_of_date)
+                {
+                    const bool recreated = swapchain.has_value()
+                        ? recreate_swapchain_(cached_width, cached_height)
+                        : recreate_offscreen_targets_(cached_width, cached_height);
+
+                    cached_width_prev = cached_width;
+                    cached_height_prev = cached_height;
+                    swapchain_out_of_date = !recreated && swapchain.has_value();
 
+                    if (!recreated)
+                    {
+                        return std::nullopt;
+                    }
+                }
+
+                pace_frame_();
+
+                // The command buffer comes first: an acquired image must be presented, so nothing may fail after it
                 VkCommandBuffer cb = cmd_handler.acquire_command_buffer();
 
                 // If no valid buffers -> return
                 // TODO: move this into command_pool API?
                 if (cb == VK_NULL_HANDLE)
                 {
-                    return;
+                    return std::nullopt;
+                }
+
+                if (swapchain.has_value())
+                {
+                    auto acquired = swapchain.value()->acquire_image(image_available_semaphore);
+                    if (!acquired.has_value())
+                    {
+                        // Nothing was acquired, so the semaphore is unsignaled and the frame can be skipped
+                        cmd_handler.release_command_buffer(cb);
+                        swapchain_out_of_date = true;
+                        return std::nullopt;
+                    }
+
+                    // The image is acquired and must still be presented. The swapchain is rebuilt next frame
+                    swapchain_out_of_date = acquired->suboptimal;
+                    current_image_index = acquired->index;
                 }
 
                 class command_buffer command_buffer(cb);
                 cmd_handler.wait_for_command_buffer(cb);
-                cmd_handler.reset_command_buffer_fence(cb);
 
+                command_buffer.reset();
+                record_commands(command_buffer, recording_draws);
 
-                if (swapchain.has_value())
+                // Offscreen targets have no image to acquire or present
+                return recorded_frame{
+                    .command_buffer = command_buffer.handle(),
+                    .wait_semaphore = swapchain.has_value() ? image_available_semaphore : VK_NULL_HANDLE,
+                    .signal_semaphore = swapchain.has_value() ? render_finished_semaphore : VK_NULL_HANDLE,
+                };
+            }
+
+            void view::submitted(const recorded_frame& frame, class submit_batch* batch) noexcept
+            {
+                const u64 batch_serial = batch != nullptr ? batch->submitted_serial() : 0;
+                const u64 serial = cmd_handler.mark_submitted(frame.command_buffer, batch, batch_serial);
+                secondary_pools.submit(serial);
+                readbacks.submit(serial);
+                pacer.frame_submitted();
+
+                cmd_handler.update();
+
+                previous_frame = last_frame;
+                last_frame = paced_frame{ .serial = serial };
+
+                // A failed batch never consumed the acquire's semaphore nor signaled the present's, so hand the image back empty
+                if (swapchain.has_value() && (batch != nullptr || release_image_(frame)))
                 {
-                    auto idx = swapchain.value()->get_image_index(image_available_semaphore);
+                    present_(frame);
+                }
+            }
 
-                    if (cached_width != cached_width_prev || cached_height != cached_height_prev || !idx.has_value())
-                    {
-                        logger::error("Image index has no value!");
-                        recreate_swapchain_(cached_width, cached_height);
-                        cached_width_prev = cached_width;
-                        cached_height_prev = cached_height;
-                        return;
-                    }
+            bool view::release_image_(const recorded_frame& frame) const noexcept
+            {
+                const VkPipelineStageFlags wait_stage = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+                const VkSubmitInfo submit_info{
+                    .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+                    .waitSemaphoreCount = 1,
+                    .pWaitSemaphores = &frame.wait_semaphore,
+                    .pWaitDstStageMask = &wait_stage,
+                    .commandBufferCount = 0,
+                    .signalSemaphoreCount = 1,
+                    .pSignalSemaphores = &frame.signal_semaphore,
+                };
 
-                    current_image_index = idx.value();
-                    // logger::trace("Image index: {}", current_image_index);
+                const VkResult result = vkQueueSubmit(device.lock()->get_queue(queue_type::graphics).value(), 1, &submit_info, VK_NULL_HANDLE);
+                if (result != VK_SUCCESS)
+                {
+                    logger::error("Failed to release swapchain image after a failed submit: {}", error_string(result));
+                    return false;
                 }
 
-                cached_width_prev = cached_width;
-                cached_height_prev = cached_height;
+                return true;
+            }
 
-                const std::vector<VkSemaphore> signal_semaphores = {render_finished_semaphore};
-                const std::vector<VkSemaphore> wait_semaphores = {image_available_semaphore};
+            void view::resolve_readbacks() noexcept
+            {
+                readbacks.resolve(cmd_handler.completed_serial());
+            }
 
-                command_buffer.reset();
-                record_commands(command_buffer);
-                std::array<VkCommandBuffer, 1> command_buffers = {command_buffer.handle()};
-
-                VkResult result = cmd_handler.submit_buffer(
-                    command_buffer.handle()
-                    , device.lock()->get_queue(queue_type::graphics).value()
-                    , wait_semaphores.data()
-                    , static_cast<u32>(wait_semaphores.size())
-                    , signal_semaphores.data()
-                    , static_cast<u32>(signal_semaphores.size())
-                    , VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT
-                );
-                // TODO check result
+            void view::present_(const recorded_frame& frame) noexcept
+            {
+                std::array<VkSwapchainKHR, 1> swapchains = {swapchain.value()->handle()};
 
-                cmd_handler.update();
+                // Tagged presents can be waited on until they are displayed
+                VkPresentIdKHR present_ids{
+                    .sType = VK_STRUCTURE_TYPE_PRESENT_ID_KHR,
+                    .swapchainCount = static_cast<u32>(swapchains.size()),
+                    .pPresentIds = &last_frame.present_id,
+                };
 
-                if (swapchain.has_value())
+                const bool tag_present = device.lock()->get_enabled_features().present_wait;
+                if (tag_present)
                 {
-                    std::array<VkSwapchainKHR, 1> swapchains = {swapchain.value()->handle()};
+                    last_frame.present_id = ++present_id;
+                }
+
+                VkPresentInfoKHR present_info{
+                    .sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR,
+                    .pNext = tag_present ? &present_ids : nullptr,
+                    .waitSemaphoreCount = 1,
+                    .pWaitSemaphores = &frame.signal_semaphore,
+                    .swapchainCount = static_cast<u32>(swapchains.size()),
+                    .pSwapchains = swapchains.data(),
+                    .pImageIndices = &current_image_index
+                };
 
-                    VkPresentInfoKHR present_info{
-                        .sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR,
-                        .waitSemaphoreCount = static_cast<u32>(signal_semaphores.size()),
-                        .pWaitSemaphores = signal_semaphores.data(),
-                        .swapchainCount = static_cast<u32>(swapchains.size()),
-                        .pSwapchains = swapchains.data(),
-                        .pImageIndices = &current_image_index
+                const VkResult present_result = vkQueuePresentKHR(
+                    device.lock()->get_queue(queue_type::graphics).value(), &present_info);
+
+                if (present_result == VK_SUBOPTIMAL_KHR || present_result == VK_ERROR_OUT_OF_DATE_KHR)
+                {
+                    swapchain_out_of_date = true;
+                }
+                else if (present_result != VK_SUCCESS)
+                {
+                    logger::error("Failed to present: {}", error_string(present_result));
+                }
+            }
+
+            void view::set_frame_pacing(present_mode mode, u32 image_count, f32 max_frame_rate, bool low_latency) noexcept
+            {
+                if (swapchain.has_value() && (mode != preferred_present_mode || image_count != min_image_count))
+                {
+                    swapchain_out_of_date = true;
+                }
+
+                preferred_present_mode = mode;
+                min_image_count = image_count;
+                pacer.set_max_frame_rate(max_frame_rate);
+                pacer.set_low_latency(low_latency);
+            }
+
+            void view::pace_frame_() noexcept
+            {
+                // Waiting on the frame before the last one leaves exactly one frame queued on the GPU
+                if (pacer.low_latency() && previous_frame.serial != 0)
+                {
+                    constexpr u64 timeout = 100'000'000;
+
+                    auto device_ptr = device.lock();
+                    const auto wait_for_present = device_ptr->get_wait_for_present_command();
+
+                    const bool by_present = wait_for_present != nullptr && swapchain.has_value() && previous_frame.present_id >= first_present_id;
+                    auto wait_completed = [&](u64 wait_timeout) {
+                        if (by_present)
+                        {
+                            const VkResult result = wait_for_present(
+                                device_ptr->handle()
+                                , swapchain.value()->handle()
+                                , previous_frame.present_id
+                                , wait_timeout
+                            );
+                            return result == VK_SUCCESS || result == VK_SUBOPTIMAL_KHR;
+                        }
+
+                        return cmd_handler.wait_for_serial(previous_frame.serial, wait_timeout);
                     };
 
-                    const VkResult present_result = vkQueuePresentKHR(
-                        device.lock()->get_queue(queue_type::graphics).value(), &present_info);
+                    // Inside a task the wait is polled between other tasks instead of holding a worker in the driver
+                    const bool completed = core::fibers::in_fiber()
+                        ? core::fibers::shared().poll([&]() { return wait_completed(0); }, std::chrono::nanoseconds(timeout))
+                        : wait_completed(timeout);
+
+                    if (completed)
+                    {
+                        pacer.frame_completed(frame_pacer::clock::now());
+                    }
+
+                    previous_frame = {};
                 }
+
+                pacer.wait_for_frame_start();
             }
 
             void view::destroy() noexcept
             {
+                // The device is idle by now, so every submitted copy resolves. Requests that never ran are dropped
+                readbacks.resolve(cmd_handler.completed_serial());
+                readbacks.cancel_queued();
+                readbacks.destroy();
+
+                release_retired_targets_(std::numeric_limits<u64>::max());
+
                 cmd_handler.destroy();
+                secondary_pools.destroy();
 
-                if (graphics_pipeline)
+                logger::info("Destroying graphics pipelines...");
+                finish_pipeline_links();
+
+                for (auto&& retired : retired_pipelines)
                 {
-                    logger::info("Destroying graphics pipeline...");
-                    graphics_pipeline->destroy();
-                    graphics_pipeline = nullptr;
-                    logger::info("Destroyed.");
+                    retired.pipeline->destroy();
+                }
+                retired_pipelines.clear();
+
+                for (auto&& pipeline : pipelines)
+                {
+                    pipeline.second->destroy();
                 }
+                pipelines.clear();
+                graphics_pipeline = nullptr;
+
+                for (auto&& cache : pipeline_libraries)
+                {
+                    for (auto&& library : cache)
+                    {
+                        library.second->destroy();
+                    }
+                    cache.clear();
+                }
+                logger::info("Destroyed.");
 
                 if (renderpass)
                 {
@@ -414,11 +1273,23 @@ namespace blade
                 //                    vkDestroyFramebuffer(device.lock()->handle(), framebuffer, allocation_callbacks);
                 //                }
 
+                destroy_offscreen_targets_();
+
+                if (depth_target)
+                {
+                    depth_target->destroy();
+                    depth_target = nullptr;
+                }
+
                 if (swapchain.has_value())
                 {
                     swapchain.value()->destroy();
                 }
-                surface->destroy();
+
+                if (surface)
+                {
+                    surface->destroy();
+                }
             }
         } // vk namespace
     } // gfx namespace
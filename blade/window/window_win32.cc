@@ -138,6 +138,8 @@ namespace blade
             DispatchMessageA(&msg);
         }
 
+        _post_resize();
+        events::flush();
         return;
     }
 
@@ -160,9 +162,27 @@ namespace blade
 
     void window::_handle_resize(struct width width, struct height height)
     {
+        // Bursts of resizes, such as a drag, collapse into one event with the final size at the end of the pump
         _width = width.w;
         _height = height.h;
-        events::dispatch(events::window_resize(width, height, *this));
+        _resize_pending = true;
+    }
+
+    void window::_post_resize()
+    {
+        if (!_resize_pending)
+        {
+            return;
+        }
+
+        _resize_pending = false;
+
+        // A full queue would drop the final size, so it goes straight to the handlers instead
+        const events::window_resize<window> resized(width(_width), height(_height), *this);
+        if (!events::post(resized))
+        {
+            events::dispatch(resized);
+        }
     }
 
     //
@@ -0,0 +1,118 @@
+#ifndef BLADE_CORE_ALLOCATOR_H
+#define BLADE_CORE_ALLOCATOR_H
+
+#include "core/types.h"
+
+#include <cstddef>
+#include <vector>
+
+namespace blade
+{
+    namespace core
+    {
+        /// @brief Subsystem an allocation is charged to
+        enum class memory_tag : u8
+        {
+            general,
+            gfx,
+            /// @brief Host memory the graphics driver allocates through the engine
+            driver,
+            resources,
+            events,
+            logger,
+            containers,
+            frame,
+            /// @brief Stacks of the fiber pool
+            fibers,
+
+            count
+        };
+
+        [[nodiscard]] const char* memory_tag_name(memory_tag tag) noexcept;
+
+        /// @brief Allocation totals of one tag across every allocator
+        struct memory_stats
+        {
+            usize live_bytes { 0 };
+            usize peak_bytes { 0 };
+            /// @brief Allocations not yet freed
+            usize count { 0 };
+            /// @brief Allocations made since startup, freed or not. Flat across frames that allocate nothing
+            u64 total { 0 };
+        };
+
+        /// @brief Current totals of a tag
+        [[nodiscard]] memory_stats query_memory(memory_tag tag) noexcept;
+
+        /**
+         * @brief Source of engine memory
+         *
+         * Every allocation is charged to a tag, and the allocator remembers it, so `deallocate` only needs the
+         * pointer. Implementations report to the shared per-tag totals through `track_allocate` and `track_free`.
+         */
+        class allocator
+        {
+            public:
+                virtual ~allocator() noexcept = default;
+
+                /**
+                 * @param alignment Power of two
+                 * @return `nullptr` if the memory could not be provided
+                 */
+                [[nodiscard]] virtual void* allocate(usize size, usize alignment, memory_tag tag) noexcept = 0;
+
+                /// @brief Free memory returned by `allocate` on this allocator. `nullptr` is ignored
+                virtual void deallocate(void* memory) noexcept = 0;
+
+                /// @brief The allocator containers use when none is given. Backed by global `operator new`
+                [[nodiscard]] static allocator& heap() noexcept;
+
+            protected:
+                static void track_allocate(memory_tag tag, usize size) noexcept;
+                static void track_free(memory_tag tag, usize size) noexcept;
+        };
+
+        /// @brief Standard allocator adapter that charges a container's memory to a tag
+        template <typename T>
+        struct std_allocator
+        {
+            using value_type = T;
+
+            [[nodiscard]] std_allocator() noexcept
+                : source { &allocator::heap() }
+            {}
+
+            [[nodiscard]] std_allocator(allocator& source, memory_tag tag) noexcept
+                : source { &source }
+                , tag { tag }
+            {}
+
+            template <typename U>
+            [[nodiscard]] std_allocator(const std_allocator<U>& other) noexcept
+                : source { other.source }
+                , tag { other.tag }
+            {}
+
+            [[nodiscard]] T* allocate(usize count)
+            {
+                return static_cast<T*>(source->allocate(count * sizeof(T), alignof(T), tag));
+            }
+
+            void deallocate(T* memory, usize) noexcept
+            {
+                source->deallocate(memory);
+            }
+
+            template <typename U>
+            bool operator==(const std_allocator<U>& other) const noexcept { return source == other.source; }
+
+            allocator* source { nullptr };
+            memory_tag tag { memory_tag::general };
+        };
+
+        template <typename T>
+        using tagged_vector = std::vector<T, std_allocator<T>>;
+    } // core namespace
+} // blade namespace
+
+#endif // BLADE_CORE_ALLOCATOR_H
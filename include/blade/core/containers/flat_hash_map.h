@@ -0,0 +1,627 @@
+#ifndef BLADE_CORE_CONTAINERS_FLAT_HASH_MAP_H
+#define BLADE_CORE_CONTAINERS_FLAT_HASH_MAP_H
+
+#include "core/allocator.h"
+#include "core/types.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <utility>
+
+#if defined(__SSE2__) || defined(_M_X64)
+    #include <emmintrin.h>
+    #define BLADE_FLAT_HASH_MAP_SSE2 1
+#endif
+
+namespace blade
+{
+    namespace core
+    {
+        namespace detail
+        {
+            /**
+             * @brief One control byte per slot: the low 7 bits of the hash for a full slot, or a marker
+             *
+             * Markers have the top bit set, so full slots are exactly the non-negative bytes.
+             */
+            enum class slot_control : i8
+            {
+                empty = -128,
+                deleted = -2,
+            };
+
+            /// @brief Matching slots of a group, one bit per slot, or one bit per byte for the 64-bit fallback
+            template <typename Bits, u32 Shift>
+            class slot_mask
+            {
+                public:
+                    [[nodiscard]] explicit slot_mask(Bits bits) noexcept : _bits { bits } {}
+
+                    [[nodiscard]] bool any() const noexcept { return _bits != 0; }
+                    [[nodiscard]] u32 lowest() const noexcept { return static_cast<u32>(std::countr_zero(_bits)) >> Shift; }
+                    [[nodiscard]] u32 highest() const noexcept { return static_cast<u32>(std::bit_width(_bits) - 1) >> Shift; }
+
+                    /// @brief Visit matches lowest first
+                    slot_mask& operator++() noexcept { _bits &= _bits - 1; return *this; }
+                    [[nodiscard]] u32 operator*() const noexcept { return lowest(); }
+                    [[nodiscard]] slot_mask begin() const noexcept { return *this; }
+                    [[nodiscard]] slot_mask end() const noexcept { return slot_mask{ 0 }; }
+                    [[nodiscard]] bool operator!=(const slot_mask& other) const noexcept { return _bits != other._bits; }
+
+                private:
+                    Bits _bits { 0 };
+            };
+
+#if defined(BLADE_FLAT_HASH_MAP_SSE2)
+            /// @brief 16 control bytes compared at once with SSE2
+            class slot_group
+            {
+                public:
+                    static constexpr usize width = 16;
+                    using mask = slot_mask<u32, 0>;
+
+                    [[nodiscard]] explicit slot_group(const i8* control) noexcept
+                        : _control { _mm_loadu_si128(reinterpret_cast<const __m128i*>(control)) }
+                    {}
+
+                    [[nodiscard]] mask match(i8 hash) const noexcept
+                    {
+                        return mask{ static_cast<u32>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(hash), _control))) };
+                    }
+
+                    [[nodiscard]] mask match_empty() const noexcept
+                    {
+                        return match(static_cast<i8>(slot_control::empty));
+                    }
+
+                    /// @brief Markers are the only bytes below -1
+                    [[nodiscard]] mask match_free() const noexcept
+                    {
+                        return mask{ static_cast<u32>(_mm_movemask_epi8(_mm_cmpgt_epi8(_mm_set1_epi8(-1), _control))) };
+                    }
+
+                private:
+                    __m128i _control;
+            };
+#else
+            /// @brief 8 control bytes compared at once inside a 64-bit word
+            class slot_group
+            {
+                public:
+                    static constexpr usize width = 8;
+                    using mask = slot_mask<u64, 3>;
+
+                    [[nodiscard]] explicit slot_group(const i8* control) noexcept
+                    {
+                        if constexpr (std::endian::native == std::endian::little)
+                        {
+                            std::memcpy(&_control, control, sizeof(_control));
+                        }
+                        else
+                        {
+                            // Slot 0 in the low byte on every target
+                            for (usize i = 0; i < width; i++)
+                            {
+                                _control |= static_cast<u64>(static_cast<u8>(control[i])) << (i * 8);
+                            }
+                        }
+                    }
+
+                    /// @brief May report a full slot right after a real match. Callers compare keys anyway
+                    [[nodiscard]] mask match(i8 hash) const noexcept
+                    {
+                        const u64 x = _control ^ (lsbs * static_cast<u8>(hash));
+                        return mask{ (x - lsbs) & ~x & msbs };
+                    }
+
+                    [[nodiscard]] mask match_empty() const noexcept
+                    {
+                        // Empty is the only marker whose bit 6 is clear
+                        return mask{ _control & ~(_control << 6) & msbs };
+                    }
+
+                    [[nodiscard]] mask match_free() const noexcept
+                    {
+                        return mask{ _control & ~(_control << 7) & msbs };
+                    }
+
+                private:
+                    static constexpr u64 lsbs = 0x0101010101010101ull;
+                    static constexpr u64 msbs = 0x8080808080808080ull;
+
+                    u64 _control { 0 };
+            };
+#endif
+
+            /// @brief Spreads weak hashes, like the identity hash of integers, over every bit
+            [[nodiscard]] inline usize mix_hash(usize hash) noexcept
+            {
+                const u64 product = static_cast<u64>(hash) * 0x9E3779B97F4A7C15ull;
+                return static_cast<usize>(product ^ (product >> 32));
+            }
+        } // detail namespace
+
+        /**
+         * @brief Open-addressing hash map in the style of SwissTable
+         *
+         * Entries live in one flat array next to an array of control bytes that hold 7 bits of each entry's
+         * hash. Lookups compare a whole group of control bytes against the hash at once and only touch the
+         * entries whose bytes match, so a miss rarely reads an entry at all. Erased slots become tombstones
+         * unless no probe can pass through them, and are reclaimed on the next rehash.
+         *
+         * The interface follows `std::unordered_map` for the operations the engine uses. Unlike it, inserting
+         * may move entries, so iterators and references are invalidated by any insertion.
+         */
+        template <typename K, typename V, typename Hash = std::hash<K>, typename Equal = std::equal_to<K>>
+        class flat_hash_map
+        {
+            using group = detail::slot_group;
+
+            public:
+                using key_type = K;
+                using mapped_type = V;
+                using value_type = std::pair<const K, V>;
+                using size_type = usize;
+
+                template <bool Const>
+                class basic_iterator
+                {
+                    public:
+                        using iterator_category = std::forward_iterator_tag;
+                        using value_type = flat_hash_map::value_type;
+                        using difference_type = std::ptrdiff_t;
+                        using reference = std::conditional_t<Const, const value_type&, value_type&>;
+                        using pointer = std::conditional_t<Const, const value_type*, value_type*>;
+
+                        [[nodiscard]] basic_iterator() noexcept = default;
+
+                        /// @brief Iterators convert to const iterators
+                        template <bool OtherConst> requires (Const && !OtherConst)
+                        [[nodiscard]] basic_iterator(const basic_iterator<OtherConst>& other) noexcept
+                            : _map { other._map }
+                            , _index { other._index }
+                        {}
+
+                        [[nodiscard]] reference operator*() const noexcept { return *_map->slot_(_index); }
+                        [[nodiscard]] pointer operator->() const noexcept { return _map->slot_(_index); }
+
+                        basic_iterator& operator++() noexcept
+                        {
+                            _index = _map->next_full_(_index + 1);
+                            return *this;
+                        }
+
+                        basic_iterator operator++(int) noexcept
+                        {
+                            basic_iterator previous = *this;
+                            ++*this;
+                            return previous;
+                        }
+
+                        [[nodiscard]] bool operator==(const basic_iterator& other) const noexcept { return _index == other._index; }
+
+                    private:
+                        friend class flat_hash_map;
+                        template <bool> friend class basic_iterator;
+
+                        [[nodiscard]] basic_iterator(const flat_hash_map* map, usize index) noexcept
+                            : _map { const_cast<flat_hash_map*>(map) }
+                            , _index { index }
+                        {}
+
+                        flat_hash_map* _map { nullptr };
+                        usize _index { 0 };
+                };
+
+                using iterator = basic_iterator<false>;
+                using const_iterator = basic_iterator<true>;
+
+                [[nodiscard]] flat_hash_map() noexcept = default;
+
+                [[nodiscard]] explicit flat_hash_map(allocator& source, memory_tag tag = memory_tag::containers) noexcept
+                    : _source { &source }
+                    , _tag { tag }
+                {}
+
+                flat_hash_map(const flat_hash_map& other) noexcept
+                    : _source { other._source }
+                    , _tag { other._tag }
+                {
+                    reserve(other._size);
+                    for (const auto& entry : other)
+                    {
+                        insert(entry);
+                    }
+                }
+
+                flat_hash_map(flat_hash_map&& other) noexcept
+                    : _source { other._source }
+                    , _tag { other._tag }
+                    , _control { std::exchange(other._control, nullptr) }
+                    , _slots { std::exchange(other._slots, nullptr) }
+                    , _capacity { std::exchange(other._capacity, 0) }
+                    , _size { std::exchange(other._size, 0) }
+                    , _growth_left { std::exchange(other._growth_left, 0) }
+                {}
+
+                flat_hash_map& operator=(const flat_hash_map& other) noexcept
+                {
+                    if (this != &other)
+                    {
+                        clear();
+                        reserve(other._size);
+                        for (const auto& entry : other)
+                        {
+                            insert(entry);
+                        }
+                    }
+
+                    return *this;
+                }
+
+                flat_hash_map& operator=(flat_hash_map&& other) noexcept
+                {
+                    if (this != &other)
+                    {
+                        destroy_();
+                        _source = other._source;
+                        _tag = other._tag;
+                        _control = std::exchange(other._control, nullptr);
+                        _slots = std::exchange(other._slots, nullptr);
+                        _capacity = std::exchange(other._capacity, 0);
+                        _size = std::exchange(other._size, 0);
+                        _growth_left = std::exchange(other._growth_left, 0);
+                    }
+
+                    return *this;
+                }
+
+                ~flat_hash_map() noexcept
+                {
+                    destroy_();
+                }
+
+                [[nodiscard]] iterator begin() noexcept { return iterator{ this, next_full_(0) }; }
+                [[nodiscard]] iterator end() noexcept { return iterator{ this, _capacity }; }
+                [[nodiscard]] const_iterator begin() const noexcept { return const_iterator{ this, next_full_(0) }; }
+                [[nodiscard]] const_iterator end() const noexcept { return const_iterator{ this, _capacity }; }
+
+                [[nodiscard]] usize size() const noexcept { return _size; }
+                [[nodiscard]] bool empty() const noexcept { return _size == 0; }
+                [[nodiscard]] usize capacity() const noexcept { return _capacity; }
+
+                [[nodiscard]] iterator find(const K& key) noexcept
+                {
+                    return iterator{ this, find_index_(key, hash_(key)) };
+                }
+
+                [[nodiscard]] const_iterator find(const K& key) const noexcept
+                {
+                    return const_iterator{ this, find_index_(key, hash_(key)) };
+                }
+
+                [[nodiscard]] bool contains(const K& key) const noexcept { return find(key) != end(); }
+
+                /// @brief Insert `V(args...)` under `key` unless the key is already there
+                template <typename... Args>
+                std::pair<iterator, bool> try_emplace(const K& key, Args&&... args) noexcept
+                {
+                    const usize hash = hash_(key);
+                    const usize found = find_index_(key, hash);
+                    if (found != _capacity)
+                    {
+                        return { iterator{ this, found }, false };
+                    }
+
+                    const usize index = prepare_insert_(hash);
+                    std::construct_at(slot_(index), std::piecewise_construct, std::forward_as_tuple(key), std::forward_as_tuple(std::forward<Args>(args)...));
+                    return { iterator{ this, index }, true };
+                }
+
+                std::pair<iterator, bool> insert(const value_type& entry) noexcept
+                {
+                    return try_emplace(entry.first, entry.second);
+                }
+
+                std::pair<iterator, bool> insert(std::pair<K, V>&& entry) noexcept
+                {
+                    return try_emplace(entry.first, std::move(entry.second));
+                }
+
+                template <typename M>
+                std::pair<iterator, bool> insert_or_assign(const K& key, M&& value) noexcept
+                {
+                    auto [it, inserted] = try_emplace(key, std::forward<M>(value));
+                    if (!inserted)
+                    {
+                        it->second = std::forward<M>(value);
+                    }
+
+                    return { it, inserted };
+                }
+
+                V& operator[](const K& key) noexcept
+                {
+                    return try_emplace(key).first->second;
+                }
+
+                /// @return The iterator after the erased entry
+                iterator erase(const_iterator position) noexcept
+                {
+                    erase_index_(position._index);
+                    return iterator{ this, next_full_(position._index + 1) };
+                }
+
+                /// @return Entries erased, `0` or `1`
+                usize erase(const K& key) noexcept
+                {
+                    const usize index = find_index_(key, hash_(key));
+                    if (index == _capacity)
+                    {
+                        return 0;
+                    }
+
+                    erase_index_(index);
+                    return 1;
+                }
+
+                /// @brief Destroy every entry but keep the storage
+                void clear() noexcept
+                {
+                    for (usize i = 0; i < _capacity; i++)
+                    {
+                        if (is_full_(_control[i]))
+                        {
+                            std::destroy_at(slot_(i));
+                        }
+                    }
+
+                    if (_capacity > 0)
+                    {
+                        std::memset(_control, static_cast<i8>(detail::slot_control::empty), _capacity + group::width);
+                    }
+
+                    _size = 0;
+                    _growth_left = max_load_(_capacity);
+                }
+
+                /// @brief Make room for `count` entries without rehashing
+                void reserve(usize count) noexcept
+                {
+                    if (count > max_load_(_capacity))
+                    {
+                        usize capacity = group::width;
+                        while (max_load_(capacity) < count)
+                        {
+                            capacity *= 2;
+                        }
+
+                        rehash_(capacity);
+                    }
+                }
+
+            private:
+                [[nodiscard]] static bool is_full_(i8 control) noexcept { return control >= 0; }
+
+                /// @brief Entries a table holds before it grows: seven eighths of its slots
+                [[nodiscard]] static usize max_load_(usize capacity) noexcept { return capacity - capacity / 8; }
+
+                [[nodiscard]] usize hash_(const K& key) const noexcept { return detail::mix_hash(Hash{}(key)); }
+                [[nodiscard]] static i8 short_hash_(usize hash) noexcept { return static_cast<i8>(hash & 0x7F); }
+
+                [[nodiscard]] value_type* slot_(usize index) const noexcept
+                {
+                    return std::launder(reinterpret_cast<value_type*>(_slots) + index);
+                }
+
+                [[nodiscard]] usize next_full_(usize index) const noexcept
+                {
+                    while (index < _capacity && !is_full_(_control[index]))
+                    {
+                        index++;
+                    }
+
+                    return index;
+                }
+
+                /**
+                 * @brief Set a slot's control byte and its copy past the end
+                 *
+                 * The first group's bytes are mirrored after the last slot, so a group starting near the end reads
+                 * the wrapped slots without a second load.
+                 */
+                void set_control_(usize index, i8 control) noexcept
+                {
+                    _control[index] = control;
+                    if (index < group::width)
+                    {
+                        _control[_capacity + index] = control;
+                    }
+                }
+
+                /**
+                 * @brief Probe groups from the hash's home slot, stepping one group further each time
+                 *
+                 * With a power-of-two number of groups the triangular steps visit every group once.
+                 */
+                template <typename F>
+                usize probe_(usize hash, F&& visit) const noexcept
+                {
+                    const usize mask = _capacity - 1;
+                    usize offset = (hash >> 7) & mask;
+                    for (usize step = group::width;; step += group::width)
+                    {
+                        const usize found = visit(group{ _control + offset }, offset);
+                        if (found != npos_)
+                        {
+                            return found;
+                        }
+
+                        offset = (offset + step) & mask;
+                    }
+                }
+
+                [[nodiscard]] usize find_index_(const K& key, usize hash) const noexcept
+                {
+                    if (_capacity == 0)
+                    {
+                        return 0;
+                    }
+
+                    const usize mask = _capacity - 1;
+                    return probe_(hash, [&](const group& candidates, usize offset) {
+                        for (const u32 i : candidates.match(short_hash_(hash)))
+                        {
+                            const usize index = (offset + i) & mask;
+                            if (Equal{}(slot_(index)->first, key))
+                            {
+                                return index;
+                            }
+                        }
+
+                        // An empty slot ends every probe that could have reached the key
+                        return candidates.match_empty().any() ? _capacity : npos_;
+                    });
+                }
+
+                [[nodiscard]] usize find_free_(usize hash) const noexcept
+                {
+                    const usize mask = _capacity - 1;
+                    return probe_(hash, [&](const group& candidates, usize offset) {
+                        const auto free = candidates.match_free();
+                        return free.any() ? (offset + free.lowest()) & mask : npos_;
+                    });
+                }
+
+                /// @brief Claim a free slot for a new entry with `hash`, growing first if the table is full
+                usize prepare_insert_(usize hash) noexcept
+                {
+                    usize index = _capacity > 0 ? find_free_(hash) : 0;
+
+                    // Reusing a tombstone costs no growth, so only an empty slot counts against the load
+                    if (_capacity == 0 || (_growth_left == 0 && _control[index] == static_cast<i8>(detail::slot_control::empty)))
+                    {
+                        // Mostly tombstones: rehashing in place reclaims them. Otherwise double
+                        rehash_(_size * 2 < max_load_(_capacity) ? _capacity : std::max(_capacity * 2, group::width));
+                        index = find_free_(hash);
+                    }
+
+                    if (_control[index] == static_cast<i8>(detail::slot_control::empty))
+                    {
+                        _growth_left--;
+                    }
+
+                    set_control_(index, short_hash_(hash));
+                    _size++;
+                    return index;
+                }
+
+                void erase_index_(usize index) noexcept
+                {
+                    std::destroy_at(slot_(index));
+                    _size--;
+
+                    // A slot can go back to empty when no window of a group's width around it is full: then no
+                    // probe ever had to step past it
+                    const usize mask = _capacity - 1;
+                    const auto empty_after = group{ _control + index }.match_empty();
+                    const auto empty_before = group{ _control + ((index - group::width) & mask) }.match_empty();
+
+                    const usize after = empty_after.any() ? empty_after.lowest() : group::width;
+                    const usize before = empty_before.any() ? group::width - 1 - empty_before.highest() : group::width;
+
+                    if (after + before < group::width)
+                    {
+                        set_control_(index, static_cast<i8>(detail::slot_control::empty));
+                        _growth_left++;
+                    }
+                    else
+                    {
+                        set_control_(index, static_cast<i8>(detail::slot_control::deleted));
+                    }
+                }
+
+                void rehash_(usize capacity) noexcept
+                {
+                    i8* old_control = _control;
+                    std::byte* old_slots = _slots;
+                    const usize old_capacity = _capacity;
+
+                    allocate_(capacity);
+
+                    for (usize i = 0; i < old_capacity; i++)
+                    {
+                        if (!is_full_(old_control[i]))
+                        {
+                            continue;
+                        }
+
+                        auto* entry = std::launder(reinterpret_cast<value_type*>(old_slots) + i);
+                        const usize hash = hash_(entry->first);
+                        const usize index = find_free_(hash);
+                        set_control_(index, short_hash_(hash));
+                        std::construct_at(slot_(index), std::move(*entry));
+                        std::destroy_at(entry);
+                    }
+
+                    _growth_left = max_load_(_capacity) - _size;
+
+                    if (old_control != nullptr)
+                    {
+                        _source->deallocate(old_control);
+                    }
+                }
+
+                /// @brief Control bytes and slots share one block, control bytes first
+                void allocate_(usize capacity) noexcept
+                {
+                    const usize control_size = capacity + group::width;
+                    const usize slots_offset = (control_size + alignof(value_type) - 1) & ~(alignof(value_type) - 1);
+                    const usize alignment = std::max(alignof(value_type), alignof(std::max_align_t));
+
+                    auto* block = static_cast<std::byte*>(_source->allocate(slots_offset + capacity * sizeof(value_type), alignment, _tag));
+                    _control = reinterpret_cast<i8*>(block);
+                    _slots = block + slots_offset;
+                    _capacity = capacity;
+
+                    std::memset(_control, static_cast<i8>(detail::slot_control::empty), control_size);
+                }
+
+                void destroy_() noexcept
+                {
+                    if (_control == nullptr)
+                    {
+                        return;
+                    }
+
+                    clear();
+                    _source->deallocate(_control);
+                    _control = nullptr;
+                    _slots = nullptr;
+                    _capacity = 0;
+                    _growth_left = 0;
+                }
+
+            private:
+                static constexpr usize npos_ = ~usize{ 0 };
+
+                allocator* _source { &allocator::heap() };
+                memory_tag _tag { memory_tag::containers };
+
+                i8* _control { nullptr };
+                std::byte* _slots { nullptr };
+                usize _capacity { 0 };
+                usize _size { 0 };
+                /// @brief Empty slots that can still be filled before the table must grow
+                usize _growth_left { 0 };
+        };
+    } // core namespace
+} // blade namespace
+
+#endif // BLADE_CORE_CONTAINERS_FLAT_HASH_MAP_H
@@ -1,10 +1,303 @@
 #ifndef BLADE_CORE_CONTAINERS_FREE_LIST_H
 #define BLADE_CORE_CONTAINERS_FREE_LIST_H
 
+#include "core/allocator.h"
+#include "core/types.h"
+
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+
 namespace blade
 {
     namespace core
     {
+        /**
+         * @brief Pool of fixed-size objects carved out of chunks, with freed slots kept on an intrusive list
+         *
+         * Chunks come from the given allocator and are never moved or returned until the pool is destroyed, so pointers stay valid for the life
+         * of the object even when the pool itself is moved. A free slot stores the link to the next free slot
+         * in its own storage, so the list costs no memory. Builds without `NDEBUG` fill freed slots with
+         * `poison_byte` to make use after free easy to spot.
+         *
+         * Not thread-safe. See `concurrent_free_list` for pools shared between threads.
+         */
+        template <typename T, usize ChunkSize = 64>
+        class free_list
+        {
+            public:
+                static constexpr u8 poison_byte = 0xdd;
+
+                [[nodiscard]] free_list() noexcept = default;
+
+                [[nodiscard]] explicit free_list(allocator& source, memory_tag tag = memory_tag::containers) noexcept
+                    : _source { &source }
+                    , _tag { tag }
+                {}
+
+                ~free_list() noexcept
+                {
+                    release_chunks_();
+                }
+
+                free_list(free_list&& other) noexcept
+                    : _source { other._source }
+                    , _tag { other._tag }
+                    , _chunks { std::move(other._chunks) }
+                    , _free { std::exchange(other._free, nullptr) }
+                    , _live { std::exchange(other._live, 0) }
+                {}
+
+                free_list& operator=(free_list&& other) noexcept
+                {
+                    release_chunks_();
+                    _source = other._source;
+                    _tag = other._tag;
+                    _chunks = std::move(other._chunks);
+                    _free = std::exchange(other._free, nullptr);
+                    _live = std::exchange(other._live, 0);
+                    return *this;
+                }
+
+                free_list(const free_list&) = delete;
+                free_list& operator=(const free_list&) = delete;
+
+                /**
+                 * @brief Construct an object in a free slot, adding a chunk if there is none
+                 * @note Objects still alive when the pool is destroyed are not destructed
+                 */
+                template <typename... Args>
+                [[nodiscard]] T* create(Args&&... args) noexcept
+                {
+                    slot* free = pop_();
+                    _live++;
+                    return std::construct_at(reinterpret_cast<T*>(free->storage), std::forward<Args>(args)...);
+                }
+
+                /// @brief Destruct an object created by this pool and give its slot back
+                void destroy(T* object) noexcept
+                {
+                    if (object == nullptr)
+                    {
+                        return;
+                    }
+
+                    std::destroy_at(object);
+                    _live--;
+                    push_(reinterpret_cast<slot*>(object));
+                }
+
+                /// @brief Objects currently alive
+                [[nodiscard]] usize size() const noexcept { return _live; }
+
+                [[nodiscard]] usize capacity() const noexcept { return _chunks.size() * ChunkSize; }
+
+            private:
+                template <typename, usize>
+                friend class concurrent_free_list;
+
+                union slot
+                {
+                    slot* next;
+                    alignas(T) std::byte storage[sizeof(T)];
+                };
+
+                slot* pop_() noexcept
+                {
+                    if (_free == nullptr)
+                    {
+                        add_chunk_();
+                    }
+
+                    slot* free = _free;
+                    _free = free->next;
+                    return free;
+                }
+
+                void push_(slot* freed) noexcept
+                {
+#ifndef NDEBUG
+                    std::memset(freed->storage, poison_byte, sizeof(slot));
+#endif
+                    freed->next = _free;
+                    _free = freed;
+                }
+
+                void add_chunk_() noexcept
+                {
+                    auto* chunk = static_cast<slot*>(_source->allocate(sizeof(slot) * ChunkSize, alignof(slot), _tag));
+
+                    // Linked back to front so the first slot of the chunk is handed out first
+                    for (usize i = ChunkSize; i > 0; i--)
+                    {
+                        chunk[i - 1].next = _free;
+                        _free = &chunk[i - 1];
+                    }
+
+                    _chunks.push_back(chunk);
+                }
+
+                void release_chunks_() noexcept
+                {
+                    for (slot* chunk : _chunks)
+                    {
+                        _source->deallocate(chunk);
+                    }
+                    _chunks.clear();
+                }
+
+            private:
+                allocator* _source { &allocator::heap() };
+                memory_tag _tag { memory_tag::containers };
+                std::vector<slot*> _chunks {};
+                slot* _free { nullptr };
+                usize _live { 0 };
+        };
+
+        /**
+         * @brief A `free_list` that any thread can allocate from
+         *
+         * Threads either go through the pool directly, taking its lock for every call, or through a
+         * `thread_cache` that takes slots from the pool in batches and only locks to refill or flush.
+         */
+        template <typename T, usize ChunkSize = 64>
+        class concurrent_free_list
+        {
+            public:
+                using slot = typename free_list<T, ChunkSize>::slot;
+
+                [[nodiscard]] concurrent_free_list() noexcept = default;
+
+                [[nodiscard]] explicit concurrent_free_list(allocator& source, memory_tag tag = memory_tag::containers) noexcept
+                    : _pool { source, tag }
+                {}
+
+                template <typename... Args>
+                [[nodiscard]] T* create(Args&&... args) noexcept
+                {
+                    std::lock_guard lock(_mutex);
+                    return _pool.create(std::forward<Args>(args)...);
+                }
+
+                void destroy(T* object) noexcept
+                {
+                    std::lock_guard lock(_mutex);
+                    _pool.destroy(object);
+                }
+
+                /// @brief Objects alive, counting the slots thread caches are holding
+                [[nodiscard]] usize size() const noexcept
+                {
+                    std::lock_guard lock(_mutex);
+                    return _pool.size();
+                }
+
+                /**
+                 * @brief Slots held by one thread, so most creates and destroys skip the pool's lock
+                 * @note A cache belongs to one thread. Slots it still holds go back to the pool when it is destroyed
+                 */
+                class thread_cache
+                {
+                    public:
+                        static constexpr usize batch_size = ChunkSize / 2 > 0 ? ChunkSize / 2 : 1;
+
+                        [[nodiscard]] explicit thread_cache(concurrent_free_list& pool) noexcept
+                            : _pool { pool }
+                        {}
+
+                        ~thread_cache() noexcept
+                        {
+                            flush_(_count);
+                        }
+
+                        thread_cache(const thread_cache&) = delete;
+                        thread_cache& operator=(const thread_cache&) = delete;
+
+                        template <typename... Args>
+                        [[nodiscard]] T* create(Args&&... args) noexcept
+                        {
+                            if (_free == nullptr)
+                            {
+                                refill_();
+                            }
+
+                            slot* free = _free;
+                            _free = free->next;
+                            _count--;
+                            return std::construct_at(reinterpret_cast<T*>(free->storage), std::forward<Args>(args)...);
+                        }
+
+                        /// @brief Destroy an object from the same pool, whichever thread created it
+                        void destroy(T* object) noexcept
+                        {
+                            if (object == nullptr)
+                            {
+                                return;
+                            }
+
+                            std::destroy_at(object);
+                            auto* freed = reinterpret_cast<slot*>(object);
+#ifndef NDEBUG
+                            std::memset(freed->storage, free_list<T, ChunkSize>::poison_byte, sizeof(slot));
+#endif
+                            freed->next = _free;
+                            _free = freed;
+                            _count++;
+
+                            // Hand half back once the cache holds two batches, so one thread cannot hoard the pool
+                            if (_count >= batch_size * 2)
+                            {
+                                flush_(batch_size);
+                            }
+                        }
+
+                    private:
+                        void refill_() noexcept
+                        {
+                            std::lock_guard lock(_pool._mutex);
+                            for (usize i = 0; i < batch_size; i++)
+                            {
+                                slot* free = _pool._pool.pop_();
+                                free->next = _free;
+                                _free = free;
+                            }
+                            _count += batch_size;
+                            _pool._pool._live += batch_size;
+                        }
+
+                        void flush_(usize count) noexcept
+                        {
+                            if (count == 0)
+                            {
+                                return;
+                            }
+
+                            std::lock_guard lock(_pool._mutex);
+                            for (usize i = 0; i < count; i++)
+                            {
+                                slot* freed = _free;
+                                _free = freed->next;
+                                freed->next = _pool._pool._free;
+                                _pool._pool._free = freed;
+                            }
+                            _count -= count;
+                            _pool._pool._live -= count;
+                        }
+
+                    private:
+                        concurrent_free_list& _pool;
+                        slot* _free { nullptr };
+                        usize _count { 0 };
+                };
+
+            private:
+                free_list<T, ChunkSize> _pool {};
+                mutable std::mutex _mutex {};
+        };
     } // core namespace
 } // blade namespace
 
@@ -0,0 +1,148 @@
+#ifndef BLADE_CORE_CONTAINERS_MPSC_QUEUE_H
+#define BLADE_CORE_CONTAINERS_MPSC_QUEUE_H
+
+#include "core/types.h"
+
+#include <atomic>
+#include <span>
+#include <type_traits>
+
+namespace blade
+{
+    namespace core
+    {
+        /// @brief Link an item needs to be queued in an `mpsc_queue`
+        struct mpsc_node
+        {
+            std::atomic<mpsc_node*> next { nullptr };
+        };
+
+        /**
+         * @brief Unbounded intrusive queue from any number of producers to one consumer
+         *
+         * Items derive from `mpsc_node` and carry their own link, so pushing never allocates. A push is one
+         * exchange on the shared end of the queue, whatever the number of items, and the consumer never
+         * writes anything producers read except through the stub node.
+         *
+         * The queue does not own its items: they stay the caller's to free once popped, and items still
+         * queued when it is destroyed are left as they are.
+         */
+        template <typename T>
+        class mpsc_queue
+        {
+            static_assert(std::is_base_of_v<mpsc_node, T>, "Queued items derive from mpsc_node");
+
+            public:
+                [[nodiscard]] mpsc_queue() noexcept = default;
+
+                mpsc_queue(const mpsc_queue&) = delete;
+                mpsc_queue& operator=(const mpsc_queue&) = delete;
+
+                /// @brief Queue an item. Any thread
+                void push(T* item) noexcept
+                {
+                    push_chain_(item, item);
+                }
+
+                /// @brief Queue items in order with a single exchange. Any thread
+                void push_batch(std::span<T* const> items) noexcept
+                {
+                    if (items.empty())
+                    {
+                        return;
+                    }
+
+                    for (usize i = 0; i + 1 < items.size(); i++)
+                    {
+                        items[i]->next.store(items[i + 1], std::memory_order_relaxed);
+                    }
+
+                    push_chain_(items.front(), items.back());
+                }
+
+                /**
+                 * @brief Take the oldest item. Consumer only
+                 * @return `nullptr` when the queue is empty, or when the next item is still being linked in by its producer
+                 */
+                [[nodiscard]] T* pop() noexcept
+                {
+                    mpsc_node* tail = _tail;
+                    mpsc_node* next = tail->next.load(std::memory_order_acquire);
+
+                    if (tail == &_stub)
+                    {
+                        if (next == nullptr)
+                        {
+                            return nullptr;
+                        }
+
+                        _tail = next;
+                        tail = next;
+                        next = next->next.load(std::memory_order_acquire);
+                    }
+
+                    if (next != nullptr)
+                    {
+                        _tail = next;
+                        return static_cast<T*>(tail);
+                    }
+
+                    // The last item can only be handed out once something is behind it, so the stub goes in
+                    if (tail != _head.load(std::memory_order_acquire))
+                    {
+                        return nullptr;
+                    }
+
+                    push_chain_(&_stub, &_stub);
+
+                    next = tail->next.load(std::memory_order_acquire);
+                    if (next != nullptr)
+                    {
+                        _tail = next;
+                        return static_cast<T*>(tail);
+                    }
+
+                    return nullptr;
+                }
+
+                /// @brief Take up to `items.size()` items, oldest first. Consumer only
+                /// @return Items popped into the front of `items`
+                usize pop_batch(std::span<T*> items) noexcept
+                {
+                    usize count = 0;
+                    while (count < items.size())
+                    {
+                        T* item = pop();
+                        if (item == nullptr)
+                        {
+                            break;
+                        }
+
+                        items[count++] = item;
+                    }
+
+                    return count;
+                }
+
+            private:
+                void push_chain_(mpsc_node* first, mpsc_node* last) noexcept
+                {
+                    last->next.store(nullptr, std::memory_order_relaxed);
+
+                    // Until the link below lands the consumer sees the queue end at `previous`
+                    mpsc_node* previous = _head.exchange(last, std::memory_order_acq_rel);
+                    previous->next.store(first, std::memory_order_release);
+                }
+
+            private:
+                /// @brief Producer side: the newest node
+                alignas(cache_line_size) std::atomic<mpsc_node*> _head { &_stub };
+
+                /// @brief Consumer side: the oldest node, and the placeholder that keeps the list from ever being empty
+                alignas(cache_line_size) mpsc_node* _tail { &_stub };
+                mpsc_node _stub {};
+        };
+    } // core namespace
+} // blade namespace
+
+#endif // BLADE_CORE_CONTAINERS_MPSC_QUEUE_H
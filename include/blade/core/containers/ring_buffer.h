@@ -0,0 +1,359 @@
+#ifndef BLADE_CORE_CONTAINERS_RING_BUFFER_H
+#define BLADE_CORE_CONTAINERS_RING_BUFFER_H
+
+#include "core/allocator.h"
+#include "core/types.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <span>
+#include <utility>
+
+namespace blade
+{
+    namespace core
+    {
+        namespace detail
+        {
+            [[nodiscard]] inline usize ring_capacity(usize requested) noexcept
+            {
+                usize capacity = 2;
+                while (capacity < requested)
+                {
+                    capacity *= 2;
+                }
+
+                return capacity;
+            }
+        } // detail namespace
+
+        /**
+         * @brief Bounded queue from one producer thread to one consumer thread
+         *
+         * Each side owns its index and keeps a cached copy of the other's, so it only touches the other side's
+         * cache line once the cached copy says the ring is full or empty. Batches publish every item with a
+         * single release store.
+         */
+        template <typename T>
+        class spsc_ring
+        {
+            public:
+                /// @param capacity Rounded up to a power of two
+                [[nodiscard]] explicit spsc_ring(usize capacity, allocator& source = allocator::heap(), memory_tag tag = memory_tag::containers) noexcept
+                    : _capacity { detail::ring_capacity(capacity) }
+                    , _source { &source }
+                {
+                    _slots = static_cast<T*>(_source->allocate(_capacity * sizeof(T), alignof(T), tag));
+                }
+
+                ~spsc_ring() noexcept
+                {
+                    const usize tail = _tail.load(std::memory_order_relaxed);
+                    for (usize i = _head.load(std::memory_order_relaxed); i != tail; i++)
+                    {
+                        std::destroy_at(slot_(i));
+                    }
+
+                    _source->deallocate(_slots);
+                }
+
+                spsc_ring(const spsc_ring&) = delete;
+                spsc_ring& operator=(const spsc_ring&) = delete;
+
+                /// @brief Construct an item at the back. Producer only. `false` if the ring is full
+                template <typename... Args>
+                [[nodiscard]] bool try_emplace(Args&&... args) noexcept
+                {
+                    const usize tail = _tail.load(std::memory_order_relaxed);
+                    if (free_slots_(tail, 1) == 0)
+                    {
+                        return false;
+                    }
+
+                    std::construct_at(slot_(tail), std::forward<Args>(args)...);
+                    _tail.store(tail + 1, std::memory_order_release);
+                    return true;
+                }
+
+                [[nodiscard]] bool try_push(const T& item) noexcept { return try_emplace(item); }
+                [[nodiscard]] bool try_push(T&& item) noexcept { return try_emplace(std::move(item)); }
+
+                /// @brief Move as many items in as fit. Producer only. Items not taken are left untouched
+                /// @return Items pushed, from the front of `items`
+                usize push_batch(std::span<T> items) noexcept
+                {
+                    const usize tail = _tail.load(std::memory_order_relaxed);
+                    const usize count = free_slots_(tail, items.size());
+                    for (usize i = 0; i < count; i++)
+                    {
+                        std::construct_at(slot_(tail + i), std::move(items[i]));
+                    }
+
+                    _tail.store(tail + count, std::memory_order_release);
+                    return count;
+                }
+
+                /// @brief Move the front item out. Consumer only. `false` if the ring is empty
+                [[nodiscard]] bool try_pop(T& item) noexcept
+                {
+                    return pop_batch(std::span<T>(&item, 1)) == 1;
+                }
+
+                /// @brief Move up to `items.size()` items out, oldest first. Consumer only
+                /// @return Items popped into the front of `items`
+                usize pop_batch(std::span<T> items) noexcept
+                {
+                    const usize head = _head.load(std::memory_order_relaxed);
+                    usize available = _tail_cache - head;
+                    if (available < items.size())
+                    {
+                        _tail_cache = _tail.load(std::memory_order_acquire);
+                        available = _tail_cache - head;
+                    }
+
+                    const usize count = std::min(available, items.size());
+                    for (usize i = 0; i < count; i++)
+                    {
+                        T* slot = slot_(head + i);
+                        items[i] = std::move(*slot);
+                        std::destroy_at(slot);
+                    }
+
+                    _head.store(head + count, std::memory_order_release);
+                    return count;
+                }
+
+                /// @brief Items queued at some recent point. Exact only while neither side is running
+                [[nodiscard]] usize size() const noexcept
+                {
+                    return _tail.load(std::memory_order_acquire) - _head.load(std::memory_order_acquire);
+                }
+
+                [[nodiscard]] bool is_empty() const noexcept { return size() == 0; }
+                [[nodiscard]] usize capacity() const noexcept { return _capacity; }
+
+            private:
+                [[nodiscard]] T* slot_(usize index) const noexcept { return _slots + (index & (_capacity - 1)); }
+
+                /// @brief Free slots past `tail`, up to `wanted`. Only reads the consumer's index when the cache falls short
+                usize free_slots_(usize tail, usize wanted) noexcept
+                {
+                    usize free = _capacity - (tail - _head_cache);
+                    if (free < wanted)
+                    {
+                        _head_cache = _head.load(std::memory_order_acquire);
+                        free = _capacity - (tail - _head_cache);
+                    }
+
+                    return std::min(free, wanted);
+                }
+
+            private:
+                /// @brief Consumer side: where it reads next and the last producer index it saw
+                alignas(cache_line_size) std::atomic<usize> _head { 0 };
+                usize _tail_cache { 0 };
+
+                /// @brief Producer side: where it writes next and the last consumer index it saw
+                alignas(cache_line_size) std::atomic<usize> _tail { 0 };
+                usize _head_cache { 0 };
+
+                alignas(cache_line_size) usize _capacity { 0 };
+                allocator* _source { nullptr };
+                T* _slots { nullptr };
+        };
+
+        /**
+         * @brief Bounded queue any number of threads push to and pop from
+         *
+         * Every cell carries a sequence number saying whether it is free for the current lap of producers or
+         * holds an item for the current lap of consumers, so a thread claims a cell with one compare-exchange
+         * on the shared index and never waits for another thread to finish its copy. Batches claim a run of
+         * consecutive ready cells with a single compare-exchange.
+         */
+        template <typename T>
+        class mpmc_ring
+        {
+            public:
+                /// @param capacity Rounded up to a power of two
+                [[nodiscard]] explicit mpmc_ring(usize capacity, allocator& source = allocator::heap(), memory_tag tag = memory_tag::containers) noexcept
+                    : _capacity { detail::ring_capacity(capacity) }
+                    , _source { &source }
+                {
+                    _cells = static_cast<cell*>(_source->allocate(_capacity * sizeof(cell), alignof(cell), tag));
+                    for (usize i = 0; i < _capacity; i++)
+                    {
+                        std::construct_at(&_cells[i])->sequence.store(i, std::memory_order_relaxed);
+                    }
+                }
+
+                ~mpmc_ring() noexcept
+                {
+                    const usize tail = _tail.load(std::memory_order_relaxed);
+                    for (usize i = _head.load(std::memory_order_relaxed); i != tail; i++)
+                    {
+                        std::destroy_at(cell_(i).item());
+                    }
+
+                    std::destroy_n(_cells, _capacity);
+                    _source->deallocate(_cells);
+                }
+
+                mpmc_ring(const mpmc_ring&) = delete;
+                mpmc_ring& operator=(const mpmc_ring&) = delete;
+
+                /// @brief Construct an item at the back. `false` if the ring is full
+                template <typename... Args>
+                [[nodiscard]] bool try_emplace(Args&&... args) noexcept
+                {
+                    usize position = 0;
+                    if (claim_(_tail, 0, 1, position) == 0)
+                    {
+                        return false;
+                    }
+
+                    cell& claimed = cell_(position);
+                    std::construct_at(claimed.item(), std::forward<Args>(args)...);
+                    claimed.sequence.store(position + 1, std::memory_order_release);
+                    return true;
+                }
+
+                [[nodiscard]] bool try_push(const T& item) noexcept { return try_emplace(item); }
+                [[nodiscard]] bool try_push(T&& item) noexcept { return try_emplace(std::move(item)); }
+
+                /// @brief Move as many items in as there are free cells in a row. Items not taken are left untouched
+                /// @return Items pushed, from the front of `items`
+                usize push_batch(std::span<T> items) noexcept
+                {
+                    usize position = 0;
+                    const usize count = claim_(_tail, 0, items.size(), position);
+                    for (usize i = 0; i < count; i++)
+                    {
+                        cell& claimed = cell_(position + i);
+                        std::construct_at(claimed.item(), std::move(items[i]));
+                        claimed.sequence.store(position + i + 1, std::memory_order_release);
+                    }
+
+                    return count;
+                }
+
+                /// @brief Move the front item out. `false` if the ring is empty
+                [[nodiscard]] bool try_pop(T& item) noexcept
+                {
+                    return pop_batch(std::span<T>(&item, 1)) == 1;
+                }
+
+                /// @brief Move out up to `items.size()` items that are ready in a row, oldest first
+                /// @return Items popped into the front of `items`
+                usize pop_batch(std::span<T> items) noexcept
+                {
+                    usize popped = 0;
+                    return consume(items.size(), [&items, &popped](T& item) {
+                        items[popped++] = std::move(item);
+                    });
+                }
+
+                /**
+                 * @brief Hand up to `wanted` items that are ready in a row to `visit`, oldest first, then destroy them
+                 *
+                 * Items are visited where they sit, so this also works for types that cannot be assigned. The
+                 * cells stay claimed until their item is visited, so producers may see the ring as full meanwhile.
+                 *
+                 * @return Items consumed
+                 */
+                template <typename F>
+                usize consume(usize wanted, F&& visit) noexcept
+                {
+                    usize position = 0;
+                    const usize count = claim_(_head, 1, wanted, position);
+                    for (usize i = 0; i < count; i++)
+                    {
+                        cell& claimed = cell_(position + i);
+                        visit(*claimed.item());
+                        std::destroy_at(claimed.item());
+
+                        // Free for the producers of the next lap
+                        claimed.sequence.store(position + i + _capacity, std::memory_order_release);
+                    }
+
+                    return count;
+                }
+
+                /// @brief Items queued at some recent point
+                [[nodiscard]] usize size() const noexcept
+                {
+                    const usize head = _head.load(std::memory_order_acquire);
+                    const usize tail = _tail.load(std::memory_order_acquire);
+                    return tail > head ? tail - head : 0;
+                }
+
+                [[nodiscard]] bool is_empty() const noexcept { return size() == 0; }
+                [[nodiscard]] usize capacity() const noexcept { return _capacity; }
+
+            private:
+                struct cell
+                {
+                    std::atomic<usize> sequence { 0 };
+                    alignas(T) std::byte storage[sizeof(T)];
+
+                    [[nodiscard]] T* item() noexcept { return std::launder(reinterpret_cast<T*>(storage)); }
+                };
+
+                [[nodiscard]] cell& cell_(usize index) const noexcept { return _cells[index & (_capacity - 1)]; }
+
+                /**
+                 * @brief Claim up to `wanted` consecutive cells at `index`
+                 *
+                 * A cell at position `p` is ready when its sequence is `p + lag`: `0` for producers looking for
+                 * free cells, `1` for consumers looking for items. Cells are only checked before the claim, which
+                 * is safe because another thread can only change them by claiming them first.
+                 *
+                 * @return Cells claimed, starting at `position`
+                 */
+                usize claim_(std::atomic<usize>& index, usize lag, usize wanted, usize& position) noexcept
+                {
+                    position = index.load(std::memory_order_relaxed);
+                    while (wanted > 0)
+                    {
+                        usize ready = 0;
+                        while (ready < wanted && cell_(position + ready).sequence.load(std::memory_order_acquire) == position + ready + lag)
+                        {
+                            ready++;
+                        }
+
+                        if (ready == 0)
+                        {
+                            // Behind the index means a lap behind: full for producers, empty for consumers
+                            const usize sequence = cell_(position).sequence.load(std::memory_order_acquire);
+                            if (static_cast<std::ptrdiff_t>(sequence - (position + lag)) < 0)
+                            {
+                                return 0;
+                            }
+
+                            position = index.load(std::memory_order_relaxed);
+                            continue;
+                        }
+
+                        if (index.compare_exchange_weak(position, position + ready, std::memory_order_relaxed, std::memory_order_relaxed))
+                        {
+                            return ready;
+                        }
+                    }
+
+                    return 0;
+                }
+
+            private:
+                alignas(cache_line_size) std::atomic<usize> _head { 0 };
+                alignas(cache_line_size) std::atomic<usize> _tail { 0 };
+
+                alignas(cache_line_size) usize _capacity { 0 };
+                allocator* _source { nullptr };
+                cell* _cells { nullptr };
+        };
+    } // core namespace
+} // blade namespace
+
+#endif // BLADE_CORE_CONTAINERS_RING_BUFFER_H
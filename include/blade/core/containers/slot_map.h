@@ -0,0 +1,338 @@
+#ifndef BLADE_CORE_CONTAINERS_SLOT_MAP_H
+#define BLADE_CORE_CONTAINERS_SLOT_MAP_H
+
+#include "core/allocator.h"
+#include "core/logger.h"
+#include "core/types.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <limits>
+#include <memory>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace blade
+{
+    namespace core
+    {
+        /**
+         * @brief Index and generation of a slot packed into 32 bits
+         *
+         * The low 20 bits index the slot and the high 12 bits count how often it has been reused. A stale id keeps
+         * the generation it was created with, so it stops resolving once its slot is erased.
+         */
+        struct slot_id
+        {
+            static constexpr u32 index_bits = 20;
+            static constexpr u32 generation_bits = 32 - index_bits;
+            static constexpr u32 max_index = (1u << index_bits) - 1;
+            static constexpr u32 generation_mask = (1u << generation_bits) - 1;
+            static constexpr u32 null_value = std::numeric_limits<u32>::max();
+
+            u32 value { null_value };
+
+            [[nodiscard]] static constexpr slot_id make(u32 index, u32 generation) noexcept
+            {
+                return slot_id{ .value = ((generation & generation_mask) << index_bits) | (index & max_index) };
+            }
+
+            [[nodiscard]] constexpr u32 index() const noexcept { return value & max_index; }
+            [[nodiscard]] constexpr u32 generation() const noexcept { return value >> index_bits; }
+            [[nodiscard]] constexpr bool is_null() const noexcept { return value == null_value; }
+
+            constexpr bool operator==(const slot_id&) const noexcept = default;
+        };
+
+        /**
+         * @brief Values stored densely and addressed through generational ids
+         *
+         * Lookups are two array reads and iteration walks a packed vector of live values. Erasing moves the last
+         * value into the hole, so pointers into the map are only valid until the next insert or erase.
+         *
+         * `reserve` is lock-free and may run on any thread, which lets callers hand out an id before the value
+         * exists, as long as the map's allocator is thread-safe. Everything else belongs to a single owning thread.
+         */
+        template <typename T>
+        class slot_map
+        {
+            public:
+                [[nodiscard]] slot_map() noexcept = default;
+
+                [[nodiscard]] explicit slot_map(allocator& source, memory_tag tag = memory_tag::containers) noexcept
+                    : _source { &source }
+                    , _tag { tag }
+                    , _values { std_allocator<T>(source, tag) }
+                    , _ids { std_allocator<slot_id>(source, tag) }
+                {}
+
+                ~slot_map() noexcept
+                {
+                    for (auto& page : _pages)
+                    {
+                        destroy_page_(page.load(std::memory_order_relaxed));
+                    }
+                }
+
+                slot_map(const slot_map&) = delete;
+                slot_map& operator=(const slot_map&) = delete;
+
+                /**
+                 * @brief Claim a slot without storing a value in it yet
+                 * @note Lock-free and safe from any thread. Freed slots are reused before new ones are opened
+                 * @return A null id once every index is in use
+                 */
+                [[nodiscard]] slot_id reserve() noexcept
+                {
+                    u64 head = _free_head.load(std::memory_order_acquire);
+                    while (static_cast<u32>(head) != no_slot)
+                    {
+                        const u32 index = static_cast<u32>(head);
+                        const u64 next = (head & tag_mask) + tag_step + slot_at_(index).next_free.load(std::memory_order_relaxed);
+                        if (_free_head.compare_exchange_weak(head, next, std::memory_order_acquire, std::memory_order_acquire))
+                        {
+                            return slot_id::make(index, slot_at_(index).generation.load(std::memory_order_relaxed));
+                        }
+                    }
+
+                    const u32 index = _next_index.fetch_add(1, std::memory_order_relaxed);
+                    if (index > slot_id::max_index)
+                    {
+                        logger::error("Slot map is full");
+                        return {};
+                    }
+
+                    ensure_page_(index / page_size);
+                    return slot_id::make(index, 0);
+                }
+
+                /**
+                 * @brief Store a value in a slot returned by `reserve`
+                 * @return The stored value. `nullptr` if the id is stale or the slot already holds a value
+                 */
+                T* insert(slot_id id, T value) noexcept
+                {
+                    if (!is_reserved_(id))
+                    {
+                        logger::error("Slot map insert into slot {} which was not reserved", id.index());
+                        return nullptr;
+                    }
+
+                    slot_at_(id.index()).dense = static_cast<u32>(_values.size());
+                    _values.push_back(std::move(value));
+                    _ids.push_back(id);
+
+                    return &_values.back();
+                }
+
+                /// @brief Reserve a slot and store the value in one step
+                slot_id emplace(T value) noexcept
+                {
+                    const slot_id id = reserve();
+                    if (id.is_null())
+                    {
+                        return id;
+                    }
+
+                    insert(id, std::move(value));
+                    return id;
+                }
+
+                /**
+                 * @brief Free a slot, dropping its value if it has one
+                 * @note Reserved slots that were never filled can be erased too
+                 * @return `false` if the id is stale
+                 */
+                bool erase(slot_id id) noexcept
+                {
+                    if (!is_current_(id))
+                    {
+                        return false;
+                    }
+
+                    slot& erased = slot_at_(id.index());
+                    if (erased.dense != no_slot)
+                    {
+                        // The last value fills the hole so the values stay packed
+                        const u32 hole = erased.dense;
+                        const u32 last = static_cast<u32>(_values.size()) - 1;
+                        if (hole != last)
+                        {
+                            // Rebuilt in place so values only need to be move constructible
+                            std::destroy_at(&_values[hole]);
+                            std::construct_at(&_values[hole], std::move(_values[last]));
+                            _ids[hole] = _ids[last];
+                            slot_at_(_ids[hole].index()).dense = hole;
+                        }
+                        _values.pop_back();
+                        _ids.pop_back();
+                        erased.dense = no_slot;
+                    }
+
+                    erased.generation.store((id.generation() + 1) & slot_id::generation_mask, std::memory_order_relaxed);
+                    push_free_(id.index());
+
+                    return true;
+                }
+
+                /// @brief The value of a live slot. `nullptr` for null, stale or still-reserved ids
+                [[nodiscard]] T* get(slot_id id) noexcept
+                {
+                    const u32 dense = dense_index_(id);
+                    return dense == no_slot ? nullptr : &_values[dense];
+                }
+
+                [[nodiscard]] const T* get(slot_id id) const noexcept
+                {
+                    const u32 dense = dense_index_(id);
+                    return dense == no_slot ? nullptr : &_values[dense];
+                }
+
+                [[nodiscard]] bool contains(slot_id id) const noexcept { return dense_index_(id) != no_slot; }
+
+                /// @brief Drop every value and free every slot. Outstanding ids become stale
+                void clear() noexcept
+                {
+                    while (!_ids.empty())
+                    {
+                        erase(_ids.back());
+                    }
+                }
+
+                /// @brief Live values in no particular order
+                [[nodiscard]] std::span<T> values() noexcept { return _values; }
+                [[nodiscard]] std::span<const T> values() const noexcept { return _values; }
+
+                /// @brief Ids of the live values, in the same order as `values`
+                [[nodiscard]] std::span<const slot_id> ids() const noexcept { return _ids; }
+
+                [[nodiscard]] usize size() const noexcept { return _values.size(); }
+                [[nodiscard]] bool is_empty() const noexcept { return _values.empty(); }
+
+                auto begin() noexcept { return _values.begin(); }
+                auto end() noexcept { return _values.end(); }
+                auto begin() const noexcept { return _values.begin(); }
+                auto end() const noexcept { return _values.end(); }
+
+            private:
+                static constexpr u32 no_slot = std::numeric_limits<u32>::max();
+                static constexpr u32 page_size = 1024;
+                static constexpr u32 max_pages = (slot_id::max_index + 1) / page_size;
+
+                // The free list head carries a tag in its upper half so a slot popped and pushed again between a
+                // load and a compare-exchange does not look unchanged
+                static constexpr u64 tag_step = u64{ 1 } << 32;
+                static constexpr u64 tag_mask = ~u64{ 0 } << 32;
+
+                struct slot
+                {
+                    std::atomic<u32> generation { 0 };
+                    std::atomic<u32> next_free { no_slot };
+                    u32 dense { no_slot };
+                };
+
+                /// @brief Slots live in pages that never move, so `reserve` can read them while the owner adds pages
+                struct page
+                {
+                    std::array<slot, page_size> slots {};
+                };
+
+                slot& slot_at_(u32 index) noexcept
+                {
+                    return _pages[index / page_size].load(std::memory_order_acquire)->slots[index % page_size];
+                }
+
+                const slot& slot_at_(u32 index) const noexcept
+                {
+                    return _pages[index / page_size].load(std::memory_order_acquire)->slots[index % page_size];
+                }
+
+                void ensure_page_(u32 page_index) noexcept
+                {
+                    if (_pages[page_index].load(std::memory_order_acquire) != nullptr)
+                    {
+                        return;
+                    }
+
+                    page* created = std::construct_at(static_cast<page*>(_source->allocate(sizeof(page), alignof(page), _tag)));
+                    page* expected = nullptr;
+                    if (!_pages[page_index].compare_exchange_strong(expected, created, std::memory_order_acq_rel))
+                    {
+                        destroy_page_(created);
+                    }
+                }
+
+                void destroy_page_(page* destroyed) noexcept
+                {
+                    if (destroyed != nullptr)
+                    {
+                        std::destroy_at(destroyed);
+                        _source->deallocate(destroyed);
+                    }
+                }
+
+                void push_free_(u32 index) noexcept
+                {
+                    u64 head = _free_head.load(std::memory_order_relaxed);
+                    do
+                    {
+                        slot_at_(index).next_free.store(static_cast<u32>(head), std::memory_order_relaxed);
+                    }
+                    while (!_free_head.compare_exchange_weak(head, (head & tag_mask) + tag_step + index, std::memory_order_release, std::memory_order_relaxed));
+                }
+
+                [[nodiscard]] bool is_opened_(slot_id id) const noexcept
+                {
+                    return !id.is_null() && id.index() < std::min(_next_index.load(std::memory_order_relaxed), slot_id::max_index + 1)
+                        && _pages[id.index() / page_size].load(std::memory_order_acquire) != nullptr;
+                }
+
+                [[nodiscard]] bool is_current_(slot_id id) const noexcept
+                {
+                    return is_opened_(id) && slot_at_(id.index()).generation.load(std::memory_order_relaxed) == id.generation();
+                }
+
+                [[nodiscard]] bool is_reserved_(slot_id id) const noexcept
+                {
+                    return is_current_(id) && slot_at_(id.index()).dense == no_slot;
+                }
+
+                [[nodiscard]] u32 dense_index_(slot_id id) const noexcept
+                {
+                    if (!is_opened_(id))
+                    {
+                        return no_slot;
+                    }
+
+                    const slot& found = slot_at_(id.index());
+                    if (found.generation.load(std::memory_order_relaxed) != id.generation())
+                    {
+#ifndef NDEBUG
+                        logger::error("Slot {} used after it was freed (generation {}, now {})"
+                                      , id.index()
+                                      , id.generation()
+                                      , found.generation.load(std::memory_order_relaxed));
+#endif
+                        return no_slot;
+                    }
+
+                    return found.dense;
+                }
+
+            private:
+                allocator* _source { &allocator::heap() };
+                memory_tag _tag { memory_tag::containers };
+
+                std::array<std::atomic<page*>, max_pages> _pages {};
+                std::atomic<u64> _free_head { no_slot };
+                std::atomic<u32> _next_index { 0 };
+
+                tagged_vector<T> _values { std_allocator<T>(allocator::heap(), memory_tag::containers) };
+                tagged_vector<slot_id> _ids { std_allocator<slot_id>(allocator::heap(), memory_tag::containers) };
+        };
+    } // core namespace
+} // blade namespace
+
+#endif // BLADE_CORE_CONTAINERS_SLOT_MAP_H
@@ -0,0 +1,255 @@
+#ifndef BLADE_CORE_CONTAINERS_SMALL_VECTOR_H
+#define BLADE_CORE_CONTAINERS_SMALL_VECTOR_H
+
+#include "core/allocator.h"
+#include "core/types.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <initializer_list>
+#include <memory>
+#include <new>
+#include <utility>
+
+namespace blade
+{
+    namespace core
+    {
+        /**
+         * @brief Vector that keeps its first `N` items inline and only allocates once it outgrows them
+         *
+         * Meant for lists that are almost always short, like the create-info arrays of a builder, where a heap
+         * allocation per list costs more than the items themselves. Past `N` it behaves like `std::vector`,
+         * with storage from the given allocator.
+         *
+         * @note Moving a vector that still uses its inline storage moves the items, so pointers into it do not
+         *       survive the move as they would with `std::vector`
+         */
+        template <typename T, usize N>
+        class small_vector
+        {
+            static_assert(N > 0, "Use std::vector without inline storage");
+
+            public:
+                using value_type = T;
+                using size_type = usize;
+                using iterator = T*;
+                using const_iterator = const T*;
+
+                [[nodiscard]] small_vector() noexcept = default;
+
+                [[nodiscard]] explicit small_vector(allocator& source, memory_tag tag = memory_tag::containers) noexcept
+                    : _source { &source }
+                    , _tag { tag }
+                {}
+
+                [[nodiscard]] small_vector(std::initializer_list<T> items) noexcept
+                {
+                    append_(items.begin(), items.end());
+                }
+
+                [[nodiscard]] small_vector(usize count, const T& value) noexcept
+                {
+                    resize(count, value);
+                }
+
+                small_vector(const small_vector& other) noexcept
+                    : _source { other._source }
+                    , _tag { other._tag }
+                {
+                    append_(other.begin(), other.end());
+                }
+
+                small_vector(small_vector&& other) noexcept
+                    : _source { other._source }
+                    , _tag { other._tag }
+                {
+                    take_(std::move(other));
+                }
+
+                small_vector& operator=(const small_vector& other) noexcept
+                {
+                    if (this != &other)
+                    {
+                        clear();
+                        append_(other.begin(), other.end());
+                    }
+
+                    return *this;
+                }
+
+                small_vector& operator=(small_vector&& other) noexcept
+                {
+                    if (this != &other)
+                    {
+                        clear();
+                        release_();
+                        _source = other._source;
+                        _tag = other._tag;
+                        take_(std::move(other));
+                    }
+
+                    return *this;
+                }
+
+                ~small_vector() noexcept
+                {
+                    clear();
+                    release_();
+                }
+
+                template <typename... Args>
+                T& emplace_back(Args&&... args) noexcept
+                {
+                    if (_size == _capacity)
+                    {
+                        // The arguments may refer to an item that growing moves, so the new one is built first
+                        T item(std::forward<Args>(args)...);
+                        grow_(_capacity * 2);
+                        return *std::construct_at(_data + _size++, std::move(item));
+                    }
+
+                    return *std::construct_at(_data + _size++, std::forward<Args>(args)...);
+                }
+
+                void push_back(const T& item) noexcept { emplace_back(item); }
+                void push_back(T&& item) noexcept { emplace_back(std::move(item)); }
+
+                void pop_back() noexcept
+                {
+                    std::destroy_at(_data + --_size);
+                }
+
+                /// @brief Remove the item at `position`, keeping the order of the rest
+                iterator erase(const_iterator position) noexcept
+                {
+                    T* erased = _data + (position - _data);
+                    std::move(erased + 1, end(), erased);
+                    pop_back();
+                    return erased;
+                }
+
+                void clear() noexcept
+                {
+                    std::destroy_n(_data, _size);
+                    _size = 0;
+                }
+
+                void reserve(usize capacity) noexcept
+                {
+                    if (capacity > _capacity)
+                    {
+                        grow_(capacity);
+                    }
+                }
+
+                void resize(usize size, const T& value = T{}) noexcept
+                {
+                    while (_size > size)
+                    {
+                        pop_back();
+                    }
+
+                    reserve(size);
+                    while (_size < size)
+                    {
+                        std::construct_at(_data + _size++, value);
+                    }
+                }
+
+                [[nodiscard]] T& operator[](usize index) noexcept { return _data[index]; }
+                [[nodiscard]] const T& operator[](usize index) const noexcept { return _data[index]; }
+
+                [[nodiscard]] T& front() noexcept { return _data[0]; }
+                [[nodiscard]] const T& front() const noexcept { return _data[0]; }
+                [[nodiscard]] T& back() noexcept { return _data[_size - 1]; }
+                [[nodiscard]] const T& back() const noexcept { return _data[_size - 1]; }
+
+                [[nodiscard]] T* data() noexcept { return _data; }
+                [[nodiscard]] const T* data() const noexcept { return _data; }
+
+                [[nodiscard]] iterator begin() noexcept { return _data; }
+                [[nodiscard]] iterator end() noexcept { return _data + _size; }
+                [[nodiscard]] const_iterator begin() const noexcept { return _data; }
+                [[nodiscard]] const_iterator end() const noexcept { return _data + _size; }
+
+                [[nodiscard]] usize size() const noexcept { return _size; }
+                [[nodiscard]] usize capacity() const noexcept { return _capacity; }
+                [[nodiscard]] bool empty() const noexcept { return _size == 0; }
+
+                /// @brief Whether the items still live in the inline storage
+                [[nodiscard]] bool is_inline() const noexcept { return _data == inline_data_(); }
+
+            private:
+                [[nodiscard]] T* inline_data_() noexcept { return reinterpret_cast<T*>(_inline); }
+                [[nodiscard]] const T* inline_data_() const noexcept { return reinterpret_cast<const T*>(_inline); }
+
+                template <typename It>
+                void append_(It first, It last) noexcept
+                {
+                    reserve(_size + static_cast<usize>(last - first));
+                    for (; first != last; ++first)
+                    {
+                        std::construct_at(_data + _size++, *first);
+                    }
+                }
+
+                void grow_(usize capacity) noexcept
+                {
+                    T* grown = static_cast<T*>(_source->allocate(capacity * sizeof(T), alignof(T), _tag));
+                    std::uninitialized_move_n(_data, _size, grown);
+                    std::destroy_n(_data, _size);
+
+                    release_();
+                    _data = grown;
+                    _capacity = capacity;
+                }
+
+                /// @brief Give back heap storage. Items must already be destroyed or moved out
+                void release_() noexcept
+                {
+                    if (!is_inline())
+                    {
+                        _source->deallocate(_data);
+                    }
+
+                    _data = inline_data_();
+                    _capacity = N;
+                }
+
+                /// @brief Steal heap storage, or move the items one by one when they are inline. Storage must be inline and empty
+                void take_(small_vector&& other) noexcept
+                {
+                    if (other.is_inline())
+                    {
+                        std::uninitialized_move_n(other._data, other._size, _data);
+                        _size = other._size;
+                        other.clear();
+                        return;
+                    }
+
+                    _data = std::exchange(other._data, other.inline_data_());
+                    _capacity = std::exchange(other._capacity, N);
+                    _size = std::exchange(other._size, 0);
+                }
+
+            private:
+                allocator* _source { &allocator::heap() };
+                memory_tag _tag { memory_tag::containers };
+
+                T* _data { inline_data_() };
+                usize _size { 0 };
+                usize _capacity { N };
+
+                alignas(T) std::byte _inline[N * sizeof(T)];
+        };
+
+        template <typename T, usize N>
+        [[nodiscard]] bool operator==(const small_vector<T, N>& left, const small_vector<T, N>& right) noexcept
+        {
+            return std::equal(left.begin(), left.end(), right.begin(), right.end());
+        }
+    } // core namespace
+} // blade namespace
+
+#endif // BLADE_CORE_CONTAINERS_SMALL_VECTOR_H
@@ -0,0 +1,156 @@
+#ifndef BLADE_CORE_CONTAINERS_WORK_STEALING_DEQUE_H
+#define BLADE_CORE_CONTAINERS_WORK_STEALING_DEQUE_H
+
+#include "core/types.h"
+
+#include <atomic>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+namespace blade
+{
+    namespace core
+    {
+        /**
+         * @brief Chase-Lev deque: the owning thread pushes and pops at the bottom, any thread steals from the top
+         *
+         * The owner works newest first, which keeps its caches warm, while thieves take the oldest items, which
+         * in recursive workloads are the largest. Only the last item is contended. When the ring fills up it is
+         * copied into one twice the size, and the old rings are kept until the deque is destroyed because a
+         * thief may still be reading one.
+         */
+        template <typename T>
+        class work_stealing_deque
+        {
+            static_assert(std::is_trivially_copyable_v<T>, "Items are read by thieves that may lose the race for them");
+
+            public:
+                [[nodiscard]] explicit work_stealing_deque(usize capacity = 256) noexcept
+                {
+                    usize rounded = 1;
+                    while (rounded < capacity)
+                    {
+                        rounded *= 2;
+                    }
+
+                    _rings.push_back(std::make_unique<ring>(rounded));
+                    _ring.store(_rings.back().get(), std::memory_order_relaxed);
+                }
+
+                work_stealing_deque(const work_stealing_deque&) = delete;
+                work_stealing_deque& operator=(const work_stealing_deque&) = delete;
+
+                /// @brief Add an item at the bottom. Owner only
+                void push(T item) noexcept
+                {
+                    const i64 bottom = _bottom.load(std::memory_order_relaxed);
+                    const i64 top = _top.load(std::memory_order_acquire);
+                    ring* current = _ring.load(std::memory_order_relaxed);
+
+                    if (bottom - top >= static_cast<i64>(current->capacity))
+                    {
+                        current = grow_(current, top, bottom);
+                    }
+
+                    current->put(bottom, item);
+                    _bottom.store(bottom + 1, std::memory_order_release);
+                }
+
+                /// @brief Take the newest item. Owner only
+                [[nodiscard]] bool pop(T& item) noexcept
+                {
+                    const i64 bottom = _bottom.load(std::memory_order_relaxed) - 1;
+                    ring* current = _ring.load(std::memory_order_relaxed);
+
+                    // Claiming the bottom slot has to be visible before reading the top, or a thief could take it too
+                    _bottom.store(bottom, std::memory_order_seq_cst);
+                    i64 top = _top.load(std::memory_order_seq_cst);
+
+                    if (top > bottom)
+                    {
+                        _bottom.store(bottom + 1, std::memory_order_relaxed);
+                        return false;
+                    }
+
+                    item = current->get(bottom);
+                    if (top < bottom)
+                    {
+                        return true;
+                    }
+
+                    // Last item: whoever moves the top first gets it
+                    const bool won = _top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+                    _bottom.store(bottom + 1, std::memory_order_relaxed);
+                    return won;
+                }
+
+                /// @brief Take the oldest item. Any thread. Fails when empty or when another thread got there first
+                [[nodiscard]] bool steal(T& item) noexcept
+                {
+                    i64 top = _top.load(std::memory_order_seq_cst);
+                    const i64 bottom = _bottom.load(std::memory_order_seq_cst);
+                    if (top >= bottom)
+                    {
+                        return false;
+                    }
+
+                    item = _ring.load(std::memory_order_acquire)->get(top);
+                    return _top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+                }
+
+                /// @brief Items in the deque at some recent point. Exact only on the owning thread with no thieves
+                [[nodiscard]] usize size() const noexcept
+                {
+                    const i64 bottom = _bottom.load(std::memory_order_relaxed);
+                    const i64 top = _top.load(std::memory_order_relaxed);
+                    return bottom > top ? static_cast<usize>(bottom - top) : 0;
+                }
+
+                [[nodiscard]] bool is_empty() const noexcept { return size() == 0; }
+
+            private:
+                struct ring
+                {
+                    [[nodiscard]] explicit ring(usize capacity) noexcept
+                        : capacity { capacity }
+                        , items { std::make_unique<std::atomic<T>[]>(capacity) }
+                    {}
+
+                    [[nodiscard]] T get(i64 index) const noexcept
+                    {
+                        return items[static_cast<usize>(index) & (capacity - 1)].load(std::memory_order_relaxed);
+                    }
+
+                    void put(i64 index, T item) noexcept
+                    {
+                        items[static_cast<usize>(index) & (capacity - 1)].store(item, std::memory_order_relaxed);
+                    }
+
+                    usize capacity { 0 };
+                    std::unique_ptr<std::atomic<T>[]> items { nullptr };
+                };
+
+                ring* grow_(ring* current, i64 top, i64 bottom) noexcept
+                {
+                    _rings.push_back(std::make_unique<ring>(current->capacity * 2));
+                    ring* grown = _rings.back().get();
+                    for (i64 i = top; i < bottom; i++)
+                    {
+                        grown->put(i, current->get(i));
+                    }
+
+                    _ring.store(grown, std::memory_order_release);
+                    return grown;
+                }
+
+            private:
+                alignas(cache_line_size) std::atomic<i64> _top { 0 };
+                alignas(cache_line_size) std::atomic<i64> _bottom { 0 };
+                std::atomic<ring*> _ring { nullptr };
+                std::vector<std::unique_ptr<ring>> _rings {};
+        };
+    } // core namespace
+} // blade namespace
+
+#endif // BLADE_CORE_CONTAINERS_WORK_STEALING_DEQUE_H
@@ -7,15 +7,25 @@
  *
  * This interface is designed to be extensible allowing for user-defined
  * events. 
+ *
+ * Events are either dispatched straight away on the emitting thread, or
+ * posted from any thread into a per-type queue and delivered in batches
+ * the next time the queues are flushed.
  */
 
 #ifndef BLADE_CORE_EVENT_H
 #define BLADE_CORE_EVENT_H
 
+#include "core/allocator.h"
+#include "core/containers/ring_buffer.h"
 #include "core/types.h"
 
+#include <algorithm>
+#include <atomic>
 #include <functional>
+#include <mutex>
 #include <type_traits>
+#include <utility>
 #include <vector>
 
 namespace blade
@@ -26,6 +36,9 @@ namespace blade
         struct event
         {
             using event_callback = std::function<bool(const T&)>;
+
+            /// @brief Events of this type that can be posted before a flush. Events may shadow it
+            static constexpr usize queue_capacity = 256;
         };
 
         template <typename T>
@@ -52,51 +65,274 @@ namespace blade
 
         struct window_close : public event<window_close> {};
 
+        /**
+         * @brief Keeps a handler subscribed for as long as it lives
+         *
+         * @note A dispatch already running on another thread can still call the handler once after it is unsubscribed
+         */
+        class subscription
+        {
+            public:
+                [[nodiscard]] subscription() noexcept = default;
+
+                [[nodiscard]] subscription(void (*unsubscribe)(u64), u64 id) noexcept
+                    : _unsubscribe { unsubscribe }
+                    , _id { id }
+                {}
+
+                subscription(subscription&& other) noexcept
+                    : _unsubscribe { std::exchange(other._unsubscribe, nullptr) }
+                    , _id { std::exchange(other._id, 0) }
+                {}
+
+                subscription& operator=(subscription&& other) noexcept
+                {
+                    if (this != &other)
+                    {
+                        reset();
+                        _unsubscribe = std::exchange(other._unsubscribe, nullptr);
+                        _id = std::exchange(other._id, 0);
+                    }
+
+                    return *this;
+                }
+
+                subscription(const subscription&) = delete;
+                subscription& operator=(const subscription&) = delete;
+
+                ~subscription() noexcept
+                {
+                    reset();
+                }
+
+                /// @brief Unsubscribe now rather than when the token is destroyed
+                void reset() noexcept
+                {
+                    if (_unsubscribe != nullptr)
+                    {
+                        std::exchange(_unsubscribe, nullptr)(_id);
+                    }
+                }
+
+                [[nodiscard]] bool is_active() const noexcept { return _unsubscribe != nullptr; }
+
+            private:
+                void (*_unsubscribe)(u64) { nullptr };
+                u64 _id { 0 };
+        };
+
         namespace detail
         {
+            /// @brief Type-erased queue of posted events, so every queue can be flushed without naming its type
+            class queue_base
+            {
+                public:
+                    virtual void flush() noexcept = 0;
+
+                    queue_base* next { nullptr };
+
+                protected:
+                    ~queue_base() = default;
+
+                    /// @brief Add the queue to the ones `events::flush` visits. Queues are never removed
+                    void register_() noexcept;
+            };
+
             template <IsEvent EventType>
             class event_bus
             {
+                using callback_type = typename event<EventType>::event_callback;
+
                 public:
-                    /// @brief Subscribe a handler to events of type T
-                    static void subscribe(typename EventType::event_callback handler)
+                    /// @brief Subscribe a handler to events of type T. Handlers with a higher priority run first
+                    [[nodiscard]] static subscription subscribe(callback_type function, i32 priority) noexcept
                     {
-                        _handlers.push_back(handler);
+                        handlers& state = handlers_();
+                        std::lock_guard<std::mutex> lock { state.write_lock };
+
+                        const u64 id = ++state.last_id;
+                        auto* list = new handler_list(*state.current.load(std::memory_order_relaxed));
+
+                        // After every handler of the same priority, so equal priorities keep subscription order
+                        const auto position = std::find_if(list->begin(), list->end(), [priority](const handler& h) {
+                            return h.priority < priority;
+                        });
+                        list->insert(position, handler { id, priority, std::move(function) });
+
+                        publish_(state, list);
+                        return subscription(&event_bus::unsubscribe_, id);
                     }
 
-                    /// @brief Dispatch events for all handlers of T event type
-                    static void dispatch(const EventType& event)
+                    /// @brief Dispatch events for all handlers of T event type on the calling thread
+                    static void dispatch(const EventType& event) noexcept
                     {
-                        for (const auto& handler : _handlers)
+                        handlers& state = handlers_();
+
+                        // Counted before the list is read, so a subscriber that sees no readers knows nobody holds the old list
+                        state.readers.fetch_add(1, std::memory_order_seq_cst);
+                        for (const handler& h : *state.current.load(std::memory_order_seq_cst))
                         {
-                            handler(event);
+                            h.callback(event);
                         }
+
+                        state.readers.fetch_sub(1, std::memory_order_release);
                     }
+
+                    /// @brief Queue an event for the next flush. Any thread. Only the first post of a type allocates, for the queue itself
+                    /// @return `false` if the queue is full and the event was dropped
+                    template <typename... Args>
+                    static bool post(Args&&... args) noexcept
+                    {
+                        return queue_().events.try_emplace(std::forward<Args>(args)...);
+                    }
+
+                    /// @brief Dispatch the events queued so far. Events posted by the handlers wait for the next flush
+                    static void flush() noexcept
+                    {
+                        queue_().flush();
+                    }
+
                 private:
-                    static std::vector<typename event<EventType>::event_callback> _handlers;
-            };
+                    struct handler
+                    {
+                        u64 id { 0 };
+                        i32 priority { 0 };
+                        callback_type callback {};
+                    };
+
+                    using handler_list = std::vector<handler>;
 
-            template <IsEvent T>
-            std::vector<typename event<T>::event_callback> event_bus<T>::_handlers; 
+                    /**
+                     * @brief Subscribed handlers
+                     *
+                     * Dispatch reads an immutable list and subscribing swaps in a copy, so emitting never waits on
+                     * a subscriber. Replaced lists are freed once no dispatch is running. Never destroyed, so tokens
+                     * that outlive static destruction stay safe to release.
+                     */
+                    struct handlers
+                    {
+                        std::atomic<const handler_list*> current { new handler_list() };
+                        std::atomic<u32> readers { 0 };
+
+                        std::mutex write_lock {};
+                        std::vector<const handler_list*> retired {};
+                        u64 last_id { 0 };
+                    };
+
+                    class queue final : public queue_base
+                    {
+                        public:
+                            queue() noexcept
+                                : events { EventType::queue_capacity, core::allocator::heap(), core::memory_tag::events }
+                            {
+                                register_();
+                            }
+
+                            void flush() noexcept override
+                            {
+                                // Batches keep producers from finding the ring full while a long batch is handled
+                                constexpr usize batch_size = 32;
+
+                                usize remaining = events.size();
+                                while (remaining > 0)
+                                {
+                                    const usize count = events.consume(std::min(remaining, batch_size), [](EventType& event) {
+                                        dispatch(event);
+                                    });
+
+                                    if (count == 0)
+                                    {
+                                        break;
+                                    }
+
+                                    remaining -= count;
+                                }
+                            }
+
+                            core::mpmc_ring<EventType> events;
+                    };
+
+                    [[nodiscard]] static handlers& handlers_() noexcept
+                    {
+                        static handlers* state = new handlers();
+                        return *state;
+                    }
+
+                    [[nodiscard]] static queue& queue_() noexcept
+                    {
+                        static queue* posted = new queue();
+                        return *posted;
+                    }
+
+                    static void unsubscribe_(u64 id) noexcept
+                    {
+                        handlers& state = handlers_();
+                        std::lock_guard<std::mutex> lock { state.write_lock };
+
+                        auto* list = new handler_list(*state.current.load(std::memory_order_relaxed));
+                        std::erase_if(*list, [id](const handler& h) { return h.id == id; });
+
+                        publish_(state, list);
+                    }
+
+                    /// @brief Swap in a new list and free the replaced ones if no dispatch can still be reading them. Holds the write lock
+                    static void publish_(handlers& state, const handler_list* list) noexcept
+                    {
+                        state.retired.push_back(state.current.exchange(list, std::memory_order_seq_cst));
+                        if (state.readers.load(std::memory_order_seq_cst) != 0)
+                        {
+                            return;
+                        }
+
+                        for (const handler_list* retired : state.retired)
+                        {
+                            delete retired;
+                        }
+
+                        state.retired.clear();
+                    }
+            };
         } // detail namespace
 
         /// @brief Register a handler to process events of this type
         /// @tparam T Type of event to register callback to handle
         /// @param handler The handler to register
+        /// @param priority Handlers with a higher priority see each event first
+        /// @return Token that unsubscribes the handler when destroyed
         template <IsEvent T>
-        void subscribe(const typename event<T>::event_callback& handler)
+        [[nodiscard]] subscription subscribe(const typename event<T>::event_callback& handler, i32 priority = 0) noexcept
         {
-            detail::event_bus<T>::subscribe(handler);
+            return detail::event_bus<T>::subscribe(handler, priority);
         }
 
         /// @brief Dispatch this event to be processed by registered handlers
         /// @tparam T Type of the Event
         /// @param event Event data to process
         template <IsEvent T>
-        void dispatch(const T& event)
+        void dispatch(const T& event) noexcept
         {
             detail::event_bus<T>::dispatch(event);
         }
+
+        /// @brief Queue this event to be dispatched at the next flush. Safe from any thread
+        /// @tparam T Type of the Event
+        /// @param event Event data to process
+        /// @return `false` if too many events of this type are already queued and the event was dropped
+        template <IsEvent T>
+        bool post(T event) noexcept
+        {
+            return detail::event_bus<T>::post(std::move(event));
+        }
+
+        /// @brief Dispatch the queued events of one type on the calling thread
+        template <IsEvent T>
+        void flush() noexcept
+        {
+            detail::event_bus<T>::flush();
+        }
+
+        /// @brief Dispatch every queued event on the calling thread
+        void flush() noexcept;
     } // events namespace
 } // blade namespace
 
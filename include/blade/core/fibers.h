@@ -0,0 +1,240 @@
+#ifndef BLADE_CORE_FIBERS_H
+#define BLADE_CORE_FIBERS_H
+
+#include "core/allocator.h"
+#include "core/containers/free_list.h"
+#include "core/jobs.h"
+#include "core/types.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace blade
+{
+    namespace core
+    {
+        class fibers;
+
+        namespace detail
+        {
+            struct fiber;
+        } // detail namespace
+
+        /**
+         * @brief Number of fiber tasks still running under it
+         *
+         * Works like `job_counter`, except that a task waiting on it is parked instead of holding its worker,
+         * and is queued to resume once the counter reaches zero.
+         */
+        class fiber_counter
+        {
+            public:
+                [[nodiscard]] fiber_counter() noexcept = default;
+
+                fiber_counter(const fiber_counter&) = delete;
+                fiber_counter& operator=(const fiber_counter&) = delete;
+
+                [[nodiscard]] bool is_done() const noexcept { return _waiters.load(std::memory_order_acquire) == nullptr; }
+                [[nodiscard]] u32 pending() const noexcept { return _pending.load(std::memory_order_relaxed); }
+
+            private:
+                friend class fibers;
+
+                std::atomic<u32> _pending { 0 };
+
+                /**
+                 * @brief Fibers parked on this counter, linked through the fibers themselves
+                 *
+                 * `nullptr` once the counter is done. Clearing it is the last thing the final task does with the
+                 * counter, so a waiter that sees it cleared may destroy the counter right away.
+                 */
+                std::atomic<detail::fiber*> _waiters { nullptr };
+        };
+
+        /**
+         * @brief Tasks that can suspend, running on a fixed pool of fibers over `jobs`
+         *
+         * A spawned task is queued as a job. The worker that picks it up takes a free fiber and switches onto
+         * it, and when the task waits on a counter that is still pending or yields, the fiber switches back and
+         * the worker moves on to other jobs. The parked fiber is queued again once it can continue, and resumes
+         * on whichever worker takes it, so a task may change threads at every wait.
+         *
+         * Tasks never block a worker while they wait, which lets long chains of dependent work, such as the
+         * stages of several frames in flight, share the workers without one frame stalling another.
+         *
+         * @note Thread-local state read before a wait may belong to a different thread after it
+         */
+        class fibers
+        {
+            public:
+                static constexpr u32 default_fiber_count = 64;
+                static constexpr usize default_stack_size = 256 * 1024;
+
+                /**
+                 * @param workers Scheduler the tasks run on
+                 * @param fiber_count Tasks that can be started at once. Others wait in the queue for a free fiber
+                 * @param stack_size Bytes of stack per fiber
+                 */
+                [[nodiscard]] explicit fibers(
+                    jobs& workers
+                    , u32 fiber_count = default_fiber_count
+                    , usize stack_size = default_stack_size
+                    , allocator& source = allocator::heap()
+                ) noexcept;
+                ~fibers() noexcept;
+
+                fibers(const fibers&) = delete;
+                fibers& operator=(const fibers&) = delete;
+
+                /// @brief Run `function` as a task. `counter` tracks it until it returns
+                template <typename F>
+                void spawn(fiber_counter& counter, F&& function) noexcept
+                {
+                    if (counter._pending.fetch_add(1, std::memory_order_relaxed) == 0)
+                    {
+                        open_(counter);
+                    }
+                    start_(create_task_(&counter, std::forward<F>(function)));
+                }
+
+                /// @brief Run `function` as a task with nothing waiting on it
+                template <typename F>
+                void spawn(F&& function) noexcept
+                {
+                    start_(create_task_(nullptr, std::forward<F>(function)));
+                }
+
+                /**
+                 * @brief Return once `counter` reaches zero
+                 *
+                 * Inside a task the fiber is parked until then. On any other thread the caller runs queued jobs
+                 * while it waits, like `jobs::wait`.
+                 */
+                void wait(fiber_counter& counter) noexcept;
+
+                /// @brief Let the queued jobs run before the calling task continues. Does nothing outside a task
+                void yield() noexcept;
+
+                /**
+                 * @brief Call `ready` until it returns `true` or `timeout` passes, yielding in between
+                 *
+                 * For waits the driver would otherwise block on, such as fences: `ready` should check without
+                 * waiting. Outside a task the calling thread yields to the OS instead.
+                 *
+                 * @return Whether `ready` returned `true` in time
+                 */
+                template <typename F>
+                bool poll(F&& ready, std::chrono::nanoseconds timeout) noexcept
+                {
+                    const auto deadline = std::chrono::steady_clock::now() + timeout;
+                    while (!ready())
+                    {
+                        if (std::chrono::steady_clock::now() >= deadline)
+                        {
+                            return false;
+                        }
+
+                        yield_or_sleep_();
+                    }
+
+                    return true;
+                }
+
+                /// @brief Whether the calling code runs inside a task of any scheduler
+                [[nodiscard]] static bool in_fiber() noexcept;
+
+                /// @brief Fibers shared by the engine, on top of `jobs::shared()` and started on first use
+                [[nodiscard]] static fibers& shared() noexcept;
+
+            private:
+                struct task
+                {
+                    static constexpr usize storage_size = 48;
+
+                    void (*run)(task&) { nullptr };
+                    fiber_counter* counter { nullptr };
+
+                    /// @brief The callable, or a pointer to it when it does not fit
+                    alignas(std::max_align_t) std::byte storage[storage_size];
+                };
+
+                using task_pool = concurrent_free_list<task, 128>;
+
+                template <typename F>
+                task* create_task_(fiber_counter* counter, F&& function) noexcept
+                {
+                    using callable = std::decay_t<F>;
+
+                    task* created = _task_pool.create();
+                    created->counter = counter;
+
+                    if constexpr (sizeof(callable) <= task::storage_size && alignof(callable) <= alignof(std::max_align_t))
+                    {
+                        std::construct_at(reinterpret_cast<callable*>(created->storage), std::forward<F>(function));
+                        created->run = [](task& self) {
+                            auto* stored = std::launder(reinterpret_cast<callable*>(self.storage));
+                            (*stored)();
+                            std::destroy_at(stored);
+                        };
+                    }
+                    else
+                    {
+                        std::construct_at(reinterpret_cast<callable**>(created->storage), new callable(std::forward<F>(function)));
+                        created->run = [](task& self) {
+                            callable* boxed = *std::launder(reinterpret_cast<callable**>(self.storage));
+                            (*boxed)();
+                            delete boxed;
+                        };
+                    }
+
+                    return created;
+                }
+
+                /// @brief Mark `counter` pending again when its first task is spawned. Waits out a last task still finishing on it
+                static void open_(fiber_counter& counter) noexcept;
+
+                void start_(task* started) noexcept;
+
+                /// @brief Job that takes a free fiber for `started`, or queues itself again if there is none
+                void run_task_(task* started) noexcept;
+                void resume_(detail::fiber* resumed) noexcept;
+
+                /// @brief Switch the calling thread onto `target` and handle whatever made it switch back
+                void switch_to_(detail::fiber* target) noexcept;
+                void after_switch_(detail::fiber* suspended) noexcept;
+
+                /// @brief Park the calling task until it is resumed
+                void suspend_() noexcept;
+
+                /// @brief Decrement `counter` and queue the fibers parked on it if it reached zero
+                void finish_(fiber_counter& counter) noexcept;
+
+                /// @brief Park `waiter` on `counter`, or queue it right away if the counter is already done
+                void park_(detail::fiber* waiter, fiber_counter& counter) noexcept;
+
+                void yield_or_sleep_() noexcept;
+
+                [[noreturn]] static void fiber_main_(detail::fiber* self) noexcept;
+
+            private:
+                jobs* _jobs { nullptr };
+                allocator* _source { nullptr };
+                usize _stack_size { 0 };
+
+                task_pool _task_pool {};
+
+                std::vector<std::unique_ptr<detail::fiber>> _fibers {};
+
+                std::mutex _free_mutex {};
+                std::vector<detail::fiber*> _free {};
+        };
+    } // core namespace
+} // blade namespace
+
+#endif // BLADE_CORE_FIBERS_H
@@ -0,0 +1,218 @@
+#ifndef BLADE_CORE_FRAME_ARENA_H
+#define BLADE_CORE_FRAME_ARENA_H
+
+#include "core/allocator.h"
+#include "core/types.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace blade
+{
+    namespace core
+    {
+        /**
+         * @brief Bump allocator for temporaries that die with the frame
+         *
+         * Allocating moves an offset and freeing does nothing. When a block runs out, a larger one is chained on,
+         * and the next reset folds the chain into one block of the combined size. After a few frames every
+         * allocation fits the first block, and a frame costs no heap allocations at all. Blocks come from the
+         * given allocator and are charged to `memory_tag::frame`.
+         *
+         * Each thread has its own arena through `local`. `begin_frame` starts a new frame for every thread at
+         * once: a thread's arena rewinds the first time that thread asks for it afterwards. Memory from the
+         * arena must not be kept past the frame it was allocated in.
+         */
+        class frame_arena
+        {
+            public:
+                static constexpr usize default_block_size = 64 * 1024;
+
+                /// @brief The first block is taken on the first allocation, so threads that never allocate cost nothing
+                [[nodiscard]] explicit frame_arena(usize block_size = default_block_size, allocator& source = allocator::heap()) noexcept
+                    : _source { source }
+                    , _block_size { block_size }
+                {}
+
+                ~frame_arena() noexcept
+                {
+                    release_blocks_();
+                }
+
+                frame_arena(const frame_arena&) = delete;
+                frame_arena& operator=(const frame_arena&) = delete;
+
+                /// @brief Get `size` bytes aligned to `alignment`, which must be a power of two
+                [[nodiscard]] void* allocate(usize size, usize alignment = alignof(std::max_align_t)) noexcept
+                {
+                    if (void* memory = bump_(size, alignment))
+                    {
+                        return memory;
+                    }
+
+                    const usize grown = _blocks.empty() ? _block_size : _blocks.back().size * 2;
+                    add_block_(std::max(size + alignment, grown));
+                    return bump_(size, alignment);
+                }
+
+                template <typename T>
+                [[nodiscard]] T* allocate(usize count) noexcept
+                {
+                    return static_cast<T*>(allocate(count * sizeof(T), alignof(T)));
+                }
+
+                /// @brief Release everything allocated so far
+                void reset() noexcept
+                {
+                    if (_blocks.size() > 1)
+                    {
+                        // The frame needed the whole chain, so the next one gets it as a single block
+                        const usize total = _capacity;
+                        release_blocks_();
+                        add_block_(total);
+                    }
+
+                    _offset = 0;
+                    _used = 0;
+                }
+
+                /// @brief Bytes handed out since the last reset, including alignment padding
+                [[nodiscard]] usize used() const noexcept { return _used; }
+
+                [[nodiscard]] usize capacity() const noexcept { return _capacity; }
+
+                /// @brief Blocks taken from the heap over the arena's lifetime. Stops growing once frames fit the first block
+                [[nodiscard]] u64 block_allocations() const noexcept { return _block_allocations; }
+
+                /**
+                 * @brief Arena of the calling thread, rewound if a frame has begun since the thread last used it
+                 *
+                 * Out of line so every call looks the thread up again: a fiber task that waits may resume on another
+                 * thread, and must not keep using the arena of the one it left. Memory it took before the wait stays
+                 * valid, but a container on that arena must not grow after it.
+                 */
+                [[nodiscard]] static frame_arena& local() noexcept;
+
+                /// @brief Start a new frame. Every thread's arena rewinds on its next `local` call
+                static void begin_frame() noexcept
+                {
+                    _epoch.fetch_add(1, std::memory_order_acq_rel);
+                }
+
+            private:
+                struct block
+                {
+                    std::byte* data { nullptr };
+                    usize size { 0 };
+                };
+
+                void* bump_(usize size, usize alignment) noexcept
+                {
+                    if (_blocks.empty())
+                    {
+                        return nullptr;
+                    }
+
+                    block& current = _blocks.back();
+                    const auto base = reinterpret_cast<std::uintptr_t>(current.data);
+                    const std::uintptr_t aligned = (base + _offset + alignment - 1) & ~(static_cast<std::uintptr_t>(alignment) - 1);
+                    const usize end = static_cast<usize>(aligned - base) + size;
+                    if (end > current.size)
+                    {
+                        return nullptr;
+                    }
+
+                    _used += end - _offset;
+                    _offset = end;
+                    return reinterpret_cast<void*>(aligned);
+                }
+
+                void add_block_(usize size) noexcept
+                {
+                    auto* data = static_cast<std::byte*>(_source.allocate(size, alignof(std::max_align_t), memory_tag::frame));
+                    if (data == nullptr)
+                    {
+                        return;
+                    }
+
+                    // Room for a long chain up front, so growing the arena in a frame is one heap allocation, not two
+                    constexpr usize reserved_blocks = 8;
+                    if (_blocks.capacity() == 0)
+                    {
+                        _blocks.reserve(reserved_blocks);
+                    }
+
+                    _blocks.push_back(block{
+                        .data = data,
+                        .size = size,
+                    });
+                    _capacity += size;
+                    _offset = 0;
+                    _block_allocations++;
+                }
+
+                void release_blocks_() noexcept
+                {
+                    for (const block& released : _blocks)
+                    {
+                        _source.deallocate(released.data);
+                    }
+                    _blocks.clear();
+                    _capacity = 0;
+                }
+
+            private:
+                allocator& _source;
+                std::vector<block> _blocks {};
+                usize _block_size { default_block_size };
+                usize _offset { 0 };
+                usize _used { 0 };
+                usize _capacity { 0 };
+                u64 _block_allocations { 0 };
+
+                static inline std::atomic<u64> _epoch { 0 };
+        };
+
+        /// @brief Standard allocator drawing from a frame arena. Deallocation is a no-op
+        template <typename T>
+        struct arena_allocator
+        {
+            using value_type = T;
+
+            [[nodiscard]] arena_allocator(frame_arena& arena) noexcept
+                : arena { &arena }
+            {}
+
+            template <typename U>
+            [[nodiscard]] arena_allocator(const arena_allocator<U>& other) noexcept
+                : arena { other.arena }
+            {}
+
+            [[nodiscard]] T* allocate(usize count) noexcept { return arena->allocate<T>(count); }
+            void deallocate(T*, usize) noexcept {}
+
+            template <typename U>
+            bool operator==(const arena_allocator<U>& other) const noexcept { return arena == other.arena; }
+
+            frame_arena* arena { nullptr };
+        };
+
+        template <typename T>
+        using frame_vector = std::vector<T, arena_allocator<T>>;
+
+        /// @brief Vector on the calling thread's frame arena with room for `capacity` elements
+        template <typename T>
+        [[nodiscard]] frame_vector<T> make_frame_vector(usize capacity = 0) noexcept
+        {
+            frame_vector<T> vector{ arena_allocator<T>(frame_arena::local()) };
+            vector.reserve(capacity);
+            return vector;
+        }
+    } // core namespace
+} // blade namespace
+
+#endif // BLADE_CORE_FRAME_ARENA_H
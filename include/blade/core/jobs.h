@@ -0,0 +1,232 @@
+#ifndef BLADE_CORE_JOBS_H
+#define BLADE_CORE_JOBS_H
+
+#include "core/containers/free_list.h"
+#include "core/containers/work_stealing_deque.h"
+#include "core/types.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace blade
+{
+    namespace core
+    {
+        /**
+         * @brief Number of jobs still running under it
+         *
+         * Every job spawned with a counter adds one and takes it away when it finishes. `jobs::wait` on the
+         * counter returns once it drops to zero, so a counter works as a wait group for a batch of jobs.
+         */
+        class job_counter
+        {
+            public:
+                [[nodiscard]] job_counter() noexcept = default;
+
+                job_counter(const job_counter&) = delete;
+                job_counter& operator=(const job_counter&) = delete;
+
+                [[nodiscard]] bool is_done() const noexcept { return _pending.load(std::memory_order_acquire) == 0; }
+                [[nodiscard]] u32 pending() const noexcept { return _pending.load(std::memory_order_relaxed); }
+
+            private:
+                friend class jobs;
+
+                std::atomic<u32> _pending { 0 };
+        };
+
+        /**
+         * @brief Work-stealing job scheduler
+         *
+         * Each worker thread owns a Chase-Lev deque. Jobs spawned on a worker go to its own deque and are run
+         * newest first, and idle workers steal the oldest jobs of the others. Jobs spawned from other threads
+         * go through a shared queue. Workers with nothing to do spin briefly and then sleep until a job is
+         * spawned.
+         *
+         * Waiting never blocks: the waiting thread runs other jobs until its counter reaches zero, so jobs may
+         * spawn and wait on further jobs from inside the pool.
+         */
+        class jobs
+        {
+            public:
+                /// @param worker_count Background threads. `0` picks one per core, leaving one for the calling thread
+                [[nodiscard]] explicit jobs(u32 worker_count = 0) noexcept;
+                ~jobs() noexcept;
+
+                jobs(const jobs&) = delete;
+                jobs& operator=(const jobs&) = delete;
+
+                /// @brief Run `function` on some worker. `counter` tracks it until it returns
+                template <typename F>
+                void spawn(job_counter& counter, F&& function) noexcept
+                {
+                    counter._pending.fetch_add(1, std::memory_order_relaxed);
+                    submit_(make_job_(&counter, std::forward<F>(function)));
+                }
+
+                /// @brief Run `function` on some worker with nothing waiting on it
+                template <typename F>
+                void spawn(F&& function) noexcept
+                {
+                    submit_(make_job_(nullptr, std::forward<F>(function)));
+                }
+
+                /**
+                 * @brief Run `function` after the jobs already queued
+                 * @note Goes through the shared queue even from a worker, so a job that re-queues itself does not
+                 *       starve the rest of its worker's deque
+                 */
+                template <typename F>
+                void defer(F&& function) noexcept
+                {
+                    inject_(make_job_(nullptr, std::forward<F>(function)));
+                }
+
+                /// @brief Run other jobs until `counter` reaches zero
+                void wait(const job_counter& counter) noexcept;
+
+                /// @brief Run one queued job on the calling thread. `false` if there was none
+                bool run_one() noexcept;
+
+                /**
+                 * @brief Call `body(first, last)` over chunks of `[begin, end)` in parallel and wait for all of them
+                 *
+                 * The range is split in halves recursively, so thieves take the largest pieces first. Chunks shrink
+                 * to about eight per thread so uneven work still balances, but never below `min_grain` indices.
+                 */
+                template <typename F>
+                void parallel_for(usize begin, usize end, F&& body, usize min_grain = 1) noexcept
+                {
+                    if (begin >= end)
+                    {
+                        return;
+                    }
+
+                    const usize chunks = static_cast<usize>(thread_count()) * 8;
+                    const usize grain = std::max({ min_grain, (end - begin) / chunks, usize{ 1 } });
+
+                    job_counter counter{};
+                    split_range_(counter, begin, end, grain, body);
+                    wait(counter);
+                }
+
+                /// @brief Background workers plus the calling thread
+                [[nodiscard]] u32 thread_count() const noexcept { return static_cast<u32>(_workers.size()) + 1; }
+
+                /// @brief Scheduler shared by the engine, started on first use
+                [[nodiscard]] static jobs& shared() noexcept;
+
+            private:
+                struct job
+                {
+                    static constexpr usize storage_size = 48;
+
+                    void (*run)(job&) { nullptr };
+                    job_counter* counter { nullptr };
+
+                    /// @brief The callable, or a pointer to it when it does not fit
+                    alignas(std::max_align_t) std::byte storage[storage_size];
+                };
+
+                using job_pool = concurrent_free_list<job, 256>;
+
+                struct worker
+                {
+                    work_stealing_deque<job*> deque {};
+                    std::optional<job_pool::thread_cache> cache { std::nullopt };
+                    std::thread thread {};
+                };
+
+                template <typename F>
+                job* make_job_(job_counter* counter, F&& function) noexcept
+                {
+                    using callable = std::decay_t<F>;
+
+                    job* created = allocate_job_();
+                    created->counter = counter;
+
+                    if constexpr (sizeof(callable) <= job::storage_size && alignof(callable) <= alignof(std::max_align_t))
+                    {
+                        std::construct_at(reinterpret_cast<callable*>(created->storage), std::forward<F>(function));
+                        created->run = [](job& self) {
+                            auto* stored = std::launder(reinterpret_cast<callable*>(self.storage));
+                            (*stored)();
+                            std::destroy_at(stored);
+                        };
+                    }
+                    else
+                    {
+                        // Large captures are boxed. Keep them small to stay off the heap
+                        std::construct_at(reinterpret_cast<callable**>(created->storage), new callable(std::forward<F>(function)));
+                        created->run = [](job& self) {
+                            callable* boxed = *std::launder(reinterpret_cast<callable**>(self.storage));
+                            (*boxed)();
+                            delete boxed;
+                        };
+                    }
+
+                    return created;
+                }
+
+                template <typename F>
+                void split_range_(job_counter& counter, usize first, usize last, usize grain, F& body) noexcept
+                {
+                    // The upper half goes to the deque where thieves find it, and this thread keeps splitting the lower
+                    while (last - first > grain)
+                    {
+                        const usize middle = first + (last - first) / 2;
+                        spawn(counter, [this, &counter, middle, last, grain, &body]() {
+                            split_range_(counter, middle, last, grain, body);
+                        });
+                        last = middle;
+                    }
+
+                    body(first, last);
+                }
+
+                job* allocate_job_() noexcept;
+                void free_job_(job* finished) noexcept;
+
+                void submit_(job* submitted) noexcept;
+                void inject_(job* submitted) noexcept;
+                void grow_injected_() noexcept;
+                void signal_work_() noexcept;
+
+                /// @brief Own deque first, then the shared queue, then the other workers
+                job* find_job_() noexcept;
+                void execute_(job* found) noexcept;
+
+                void run_worker_(u32 index) noexcept;
+
+                /// @brief Worker of this scheduler running on the calling thread. `nullptr` for other threads
+                [[nodiscard]] worker* current_worker_() const noexcept;
+
+            private:
+                job_pool _job_pool {};
+
+                std::mutex _injected_mutex {};
+
+                /// @brief Ring of jobs from outside the pool. Only grows when full, so steady-state injection never allocates
+                std::vector<job*> _injected {};
+                usize _injected_head { 0 };
+                std::atomic<usize> _injected_count { 0 };
+
+                std::vector<std::unique_ptr<worker>> _workers {};
+
+                /// @brief Bumped on every spawn so sleeping workers notice new work
+                std::atomic<u32> _work_signal { 0 };
+                std::atomic<u32> _sleeping { 0 };
+                std::atomic<bool> _running { true };
+        };
+    } // core namespace
+} // blade namespace
+
+#endif // BLADE_CORE_JOBS_H
@@ -3,15 +3,67 @@
 
 #include "core/types.h"
 
+#include <utility>
+#include <vector>
+
 namespace blade
 {
     namespace core
     {
+        /**
+         * @brief A block of bytes handed to the engine
+         *
+         * A plain `memory{ .data, .size }` borrows data the caller keeps alive until the call using it returns.
+         * `copy`, `ref` and `take` create memory the engine can hold on to instead, and whoever consumes it calls
+         * `release` once the bytes are no longer needed, as the renderer's create calls do.
+         */
         struct memory
         {
+            /// @brief Called when borrowed memory is released
+            using release_fn = void (*)(void* data, void* user_data);
+
             void* data { nullptr };
             usize size { 0 };
+
+            /// @brief Tears the memory down on `release`. Set by `copy`, `ref` and `take`, `nullptr` for everything else
+            void (*releaser)(const memory*) { nullptr };
+
+            /// @brief Copy bytes into memory of its own, freed on `release`
+            [[nodiscard]] static const memory* copy(const void* data, usize size) noexcept;
+
+            /// @brief Borrow bytes without copying. `release` is called with `data` and `user_data` once they are consumed
+            [[nodiscard]] static const memory* ref(const void* data, usize size, release_fn release = nullptr, void* user_data = nullptr) noexcept;
+
+            /// @brief Adopt a vector's storage without copying it. The vector is destroyed on release
+            template <typename T>
+            [[nodiscard]] static const memory* take(std::vector<T>&& values) noexcept;
+
+            /// @brief Give memory back once its bytes are consumed. `nullptr` is ignored
+            static void release(const memory* memory) noexcept;
         };
+
+        namespace detail
+        {
+            template <typename T>
+            struct taken_memory : memory
+            {
+                std::vector<T> values {};
+            };
+        } // detail namespace
+
+        template <typename T>
+        const memory* memory::take(std::vector<T>&& values) noexcept
+        {
+            auto* taken = new detail::taken_memory<T>{};
+            taken->values = std::move(values);
+            taken->data = taken->values.data();
+            taken->size = taken->values.size() * sizeof(T);
+            taken->releaser = [](const memory* released) {
+                delete static_cast<const detail::taken_memory<T>*>(released);
+            };
+
+            return taken;
+        }
     } // core namespace
 } // blade namespace
 
@@ -0,0 +1,96 @@
+#ifndef BLADE_CORE_TLSF_ALLOCATOR_H
+#define BLADE_CORE_TLSF_ALLOCATOR_H
+
+#include "core/allocator.h"
+#include "core/types.h"
+
+#include <array>
+#include <mutex>
+#include <vector>
+
+namespace blade
+{
+    namespace core
+    {
+        /**
+         * @brief Two-level segregated fit allocator over large regions
+         *
+         * Free blocks are kept in lists bucketed by size: the first level splits sizes by power of two and the
+         * second splits each power of two into `second_level_count` ranges. Two bitmaps record which lists are
+         * non-empty, so finding a fitting block and returning one are a handful of bit scans, whatever the
+         * number of blocks. Freed blocks merge with free neighbours straight away.
+         *
+         * Regions are taken from the system `region_size` bytes at a time, or larger for allocations that do not
+         * fit one, and kept until the allocator is destroyed. Every call takes a lock, so one allocator can be
+         * shared between threads.
+         */
+        class tlsf_allocator final : public allocator
+        {
+            public:
+                static constexpr usize default_region_size = 64 * 1024 * 1024;
+
+                /// @brief The first region is taken on the first allocation
+                [[nodiscard]] explicit tlsf_allocator(usize region_size = default_region_size) noexcept;
+                ~tlsf_allocator() noexcept override;
+
+                tlsf_allocator(const tlsf_allocator&) = delete;
+                tlsf_allocator& operator=(const tlsf_allocator&) = delete;
+
+                [[nodiscard]] void* allocate(usize size, usize alignment, memory_tag tag) noexcept override;
+                void deallocate(void* memory) noexcept override;
+
+                /// @brief Bytes of all regions taken so far
+                [[nodiscard]] usize capacity() const noexcept;
+
+                [[nodiscard]] usize region_count() const noexcept;
+
+            private:
+                static constexpr u32 align_log2 = 4;
+                static constexpr usize align_size = usize{ 1 } << align_log2;
+                static constexpr u32 second_level_log2 = 5;
+                static constexpr u32 second_level_count = 1u << second_level_log2;
+                static constexpr u32 first_level_shift = second_level_log2 + align_log2;
+                static constexpr u32 first_level_max = 40;
+                static constexpr u32 first_level_count = first_level_max - first_level_shift + 1;
+                static constexpr usize small_block_size = usize{ 1 } << first_level_shift;
+
+                struct block;
+
+                struct list_index
+                {
+                    u32 first { 0 };
+                    u32 second { 0 };
+                };
+
+                [[nodiscard]] static list_index mapping_insert_(usize size) noexcept;
+
+                /// @brief Round a request up to the start of the next list, so any block found from there fits it
+                [[nodiscard]] static usize round_to_list_(usize size) noexcept;
+
+                [[nodiscard]] block* find_free_(list_index& index) const noexcept;
+                void insert_free_(block* free) noexcept;
+                void remove_free_(block* used) noexcept;
+
+                /// @brief Split the tail past `size` bytes of payload off into a free block
+                void trim_(block* used, usize size) noexcept;
+
+                /// @brief Split the first `gap` bytes off into a free block and return the rest
+                [[nodiscard]] block* trim_leading_(block* used, usize gap) noexcept;
+
+                [[nodiscard]] bool add_region_(usize payload) noexcept;
+
+            private:
+                usize _region_size { default_region_size };
+                std::vector<void*> _regions {};
+                usize _capacity { 0 };
+
+                u32 _first_level_bitmap { 0 };
+                std::array<u32, first_level_count> _second_level_bitmaps {};
+                std::array<std::array<block*, second_level_count>, first_level_count> _free_lists {};
+
+                mutable std::mutex _mutex {};
+        };
+    } // core namespace
+} // blade namespace
+
+#endif // BLADE_CORE_TLSF_ALLOCATOR_H
@@ -31,6 +31,9 @@ namespace blade
 
     using usize = std::size_t;
 
+    /// @brief Alignment that keeps data written by different threads on separate cache lines
+    inline constexpr usize cache_line_size = 64;
+
     /// @brief Struct type for width 
     struct width
     {
@@ -0,0 +1,201 @@
+#ifndef BLADE_GFX_COMMAND_STREAM_H
+#define BLADE_GFX_COMMAND_STREAM_H
+
+#include "core/core.h"
+#include "gfx/handle.h"
+#include "gfx/render_state.h"
+#include "gfx/renderer.h"
+#include "gfx/view.h"
+
+#include <cstring>
+#include <optional>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+namespace blade
+{
+    namespace gfx
+    {
+        /**
+         * @brief Frontend calls encoded as packed bytes for the render thread to replay
+         *
+         * Each command is an `op` byte, a payload size and the payload. Payloads are trivially copyable and are
+         * read back with `memcpy`, so the stream needs no alignment. Clearing keeps the capacity, so once a
+         * stream has grown to a frame's size, recording it allocates nothing.
+         */
+        class command_stream
+        {
+            public:
+                enum class op : u8
+                {
+                    set_viewport,
+                    set_render_state,
+                    set_vertex_buffer,
+                    set_index_buffer,
+                    draw,
+                    set_push_constants,
+                    set_frame_pacing,
+                    destroy_shader,
+                    destroy_view_program,
+                    destroy_buffer,
+                    frame
+                };
+
+                struct set_viewport_payload
+                {
+                    framebuffer_handle framebuffer {};
+                    f32 x { 0.f };
+                    f32 y { 0.f };
+                    u32 width { 0 };
+                    u32 height { 0 };
+                };
+
+                struct set_render_state_payload
+                {
+                    framebuffer_handle framebuffer {};
+                    render_state state {};
+                };
+
+                struct set_buffer_payload
+                {
+                    framebuffer_handle framebuffer {};
+                    buffer_handle buffer {};
+                };
+
+                struct draw_payload
+                {
+                    framebuffer_handle framebuffer {};
+                    draw_call call {};
+                };
+
+                struct set_frame_pacing_payload
+                {
+                    framebuffer_handle framebuffer {};
+                    frame_pacing pacing {};
+                };
+
+                struct destroy_shader_payload
+                {
+                    shader_handle shader {};
+                };
+
+                struct destroy_view_program_payload
+                {
+                    program_handle program {};
+                };
+
+                struct destroy_buffer_payload
+                {
+                    buffer_handle buffer {};
+                };
+
+                /// @brief Followed by `size` bytes of push constant data
+                struct set_push_constants_payload
+                {
+                    framebuffer_handle framebuffer {};
+                    u32 size { 0 };
+                    u32 offset { 0 };
+                };
+
+                /// @brief A decoded command. `payload` points into the stream
+                struct command
+                {
+                    op code { op::frame };
+                    std::span<const u8> payload {};
+
+                    template <typename T>
+                    [[nodiscard]] T as() const noexcept
+                    {
+                        static_assert(std::is_trivially_copyable_v<T>, "Command payloads must be trivially copyable");
+
+                        T value{};
+                        std::memcpy(&value, payload.data(), sizeof(T));
+                        return value;
+                    }
+
+                    /// @brief Bytes written after the fixed part of the payload
+                    template <typename T>
+                    [[nodiscard]] std::span<const u8> trailing() const noexcept
+                    {
+                        return payload.subspan(sizeof(T));
+                    }
+                };
+
+                [[nodiscard]] command_stream() noexcept
+                    : command_stream(default_capacity)
+                {}
+
+                [[nodiscard]] explicit command_stream(usize initial_capacity) noexcept
+                {
+                    _bytes.reserve(initial_capacity);
+                }
+
+                template <typename T>
+                void write(op code, const T& payload, const void* trailing = nullptr, u32 trailing_size = 0) noexcept
+                {
+                    static_assert(std::is_trivially_copyable_v<T>, "Command payloads must be trivially copyable");
+
+                    const u32 size = static_cast<u32>(sizeof(T)) + trailing_size;
+                    const usize offset = _bytes.size();
+                    _bytes.resize(offset + header_size + size);
+
+                    u8* out = _bytes.data() + offset;
+                    *out = static_cast<u8>(code);
+                    std::memcpy(out + sizeof(u8), &size, sizeof(u32));
+                    std::memcpy(out + header_size, &payload, sizeof(T));
+                    if (trailing_size > 0)
+                    {
+                        std::memcpy(out + header_size + sizeof(T), trailing, trailing_size);
+                    }
+                }
+
+                /// @brief Write a command that carries no payload
+                void write(op code) noexcept
+                {
+                    const u32 size = 0;
+                    const usize offset = _bytes.size();
+                    _bytes.resize(offset + header_size);
+
+                    _bytes[offset] = static_cast<u8>(code);
+                    std::memcpy(_bytes.data() + offset + sizeof(u8), &size, sizeof(u32));
+                }
+
+                /**
+                 * @brief Decode the command at `cursor` and move the cursor past it
+                 * @return `std::nullopt` at the end of the stream
+                 */
+                [[nodiscard]] std::optional<command> read(usize& cursor) const noexcept
+                {
+                    if (cursor + header_size > _bytes.size())
+                    {
+                        return std::nullopt;
+                    }
+
+                    u32 size = 0;
+                    std::memcpy(&size, _bytes.data() + cursor + sizeof(u8), sizeof(u32));
+
+                    const command decoded{
+                        .code = static_cast<op>(_bytes[cursor]),
+                        .payload = std::span<const u8>(_bytes.data() + cursor + header_size, size),
+                    };
+                    cursor += header_size + size;
+
+                    return decoded;
+                }
+
+                void clear() noexcept { _bytes.clear(); }
+
+                [[nodiscard]] bool is_empty() const noexcept { return _bytes.empty(); }
+                [[nodiscard]] usize size() const noexcept { return _bytes.size(); }
+
+            private:
+                static constexpr usize header_size = sizeof(u8) + sizeof(u32);
+                static constexpr usize default_capacity = 64 * 1024;
+
+                std::vector<u8> _bytes {};
+        };
+    } // gfx namespace
+} // blade namespace
+
+#endif // BLADE_GFX_COMMAND_STREAM_H
@@ -2,22 +2,27 @@
 #define BLADE_GFX_HANDLE_H
 
 #include "core/core.h"
+#include "core/containers/slot_map.h"
 #include <limits>
 
 namespace blade
 {
     namespace gfx
     {
-        const u16 BLADE_NULL_HANDLE = std::numeric_limits<u16>::max();
+        /// @brief Handles are a slot index and generation packed by `core::slot_id`
+        const u32 BLADE_NULL_HANDLE = core::slot_id::null_value;
+
+        /// @brief Index returned for resources that have no slot in the bindless descriptor arrays
+        const u32 BLADE_INVALID_BINDLESS_INDEX = std::numeric_limits<u32>::max();
     } // gfx namespace
 } // blade namespace
 #define MAKE_BLADE_HANDLE(_handle_name)                                                         \
     namespace blade::gfx                                                                        \
     {                                                                                           \
         struct _handle_name {                                                                   \
-            u16 index = BLADE_NULL_HANDLE;                                                      \
-            bool operator>(const _handle_name& h) const { return index > h.index; }             \
-            bool operator==(const _handle_name& h) const { return index == h.index; }           \
+            u32 id = BLADE_NULL_HANDLE;                                                         \
+            bool operator>(const _handle_name& h) const { return id > h.id; }                   \
+            bool operator==(const _handle_name& h) const { return id == h.id; }                 \
         };                                                                                      \
     }                                                                                           \
     namespace std                                                                               \
@@ -27,7 +32,7 @@ namespace blade
         {                                                                                       \
             std::size_t operator()(const ::blade::gfx::_handle_name h) const                    \
             {                                                                                   \
-                return std::hash<blade::u16>{}(h.index);                                        \
+                return std::hash<blade::u32>{}(h.id);                                           \
             }                                                                                   \
         };                                                                                      \
     }                                                                                           
@@ -11,6 +11,23 @@ namespace blade
             shader_handle vertex   { BLADE_NULL_HANDLE };
             shader_handle fragment { BLADE_NULL_HANDLE };
         };
+
+        /// @brief A block of push constant bytes that a program's shaders read
+        struct push_constant_range
+        {
+            /// @brief Shader stages that can read the range. Combine with `|`
+            enum stage : u32
+            {
+                vertex   = 1 << 0,
+                fragment = 1 << 1,
+
+                all      = vertex | fragment
+            };
+
+            u32 stages { stage::all };
+            u32 offset { 0 };
+            u32 size   { 0 };
+        };
     } // gfx namespace
 } // blade namespace
 
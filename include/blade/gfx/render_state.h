@@ -0,0 +1,61 @@
+#ifndef BLADE_GFX_RENDER_STATE_H
+#define BLADE_GFX_RENDER_STATE_H
+
+#include "core/core.h"
+
+namespace blade
+{
+    namespace gfx
+    {
+        /**
+         * @brief Fixed-function state used by a framebuffer's draws
+         *
+         * Backends that can change these values while recording do so without building a new pipeline.
+         * Otherwise each distinct state gets its own cached pipeline.
+         */
+        struct render_state
+        {
+            enum class cull
+            {
+                none,
+                front,
+                back
+            } cull_mode { cull::none };
+
+            enum class winding
+            {
+                clockwise,
+                counter_clockwise
+            } front_face { winding::clockwise };
+
+            enum class topology
+            {
+                point_list,
+                line_list,
+                line_strip,
+                triangle_list,
+                triangle_strip
+            } topology { topology::triangle_list };
+
+            enum class compare
+            {
+                never,
+                less,
+                equal,
+                less_or_equal,
+                greater,
+                not_equal,
+                greater_or_equal,
+                always
+            } depth_compare { compare::less };
+
+            bool primitive_restart { false };
+            bool depth_test        { false };
+            bool depth_write       { false };
+            bool blend             { false };
+            bool wireframe         { false };
+        };
+    } // gfx namespace
+} // blade namespace
+
+#endif // BLADE_GFX_RENDER_STATE_H
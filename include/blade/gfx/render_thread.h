@@ -0,0 +1,70 @@
+#ifndef BLADE_GFX_RENDER_THREAD_H
+#define BLADE_GFX_RENDER_THREAD_H
+
+#include "gfx/command_stream.h"
+#include "gfx/renderer.h"
+
+#include <array>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+namespace blade
+{
+    namespace gfx
+    {
+        /**
+         * @brief Replays the frontend's command stream on a thread of its own
+         *
+         * The frontend records frame N+1 into one stream while this thread executes frame N from the other.
+         * `kick` waits for frame N to finish, swaps the streams and wakes the thread. Calls that return a value
+         * run through `immediate`, which holds the backend lock so they never overlap a replay.
+         */
+        class render_thread
+        {
+            public:
+                [[nodiscard]] explicit render_thread(renderer_backend& backend) noexcept;
+                ~render_thread() noexcept;
+
+                render_thread(const render_thread&) = delete;
+                render_thread& operator=(const render_thread&) = delete;
+
+                /// @brief Stream the frontend is recording into. Only the frontend thread may use it
+                [[nodiscard]] command_stream& stream() noexcept { return _streams[_record_index]; }
+
+                /// @brief Hand the recorded stream to the render thread once it has finished the previous one
+                void kick() noexcept;
+
+                /// @brief Run `function` against the backend between replays
+                template <typename F>
+                auto immediate(F&& function) noexcept
+                {
+                    std::lock_guard lock(_backend_mutex);
+                    return std::forward<F>(function)(_backend);
+                }
+
+                /// @brief Execute everything recorded so far and join the thread
+                void stop() noexcept;
+
+            private:
+                void run_() noexcept;
+                void execute_(const command_stream& stream) noexcept;
+
+            private:
+                renderer_backend& _backend;
+                std::array<command_stream, 2> _streams {};
+                u32 _record_index { 0 };
+
+                std::mutex _backend_mutex {};
+                std::mutex _state_mutex {};
+                std::condition_variable _state_changed {};
+                bool _has_work { false };
+                bool _stopping { false };
+
+                std::thread _thread {};
+        };
+    } // gfx namespace
+} // blade namespace
+
+#endif // BLADE_GFX_RENDER_THREAD_H
@@ -9,9 +9,13 @@
 #include "core/core.h"
 #include "core/memory.h"
 #include "gfx/handle.h"
+#include "gfx/program.h"
+#include "gfx/render_state.h"
 #include "gfx/vertex.h"
 #include "gfx/view.h"
+#include <future>
 #include <memory>
+#include <type_traits>
 
 namespace blade
 {
@@ -22,11 +26,38 @@ namespace blade
             u32 width { 0 };
             u32 height { 0 };
 
+            /// @brief How finished frames reach the display
             enum class reset
             {
-                VSYNC
+                /// @brief Wait for vertical blank. Never tears
+                VSYNC,
+
+                /// @brief Like `VSYNC`, but late frames are shown immediately and may tear
+                VSYNC_RELAXED,
+
+                /// @brief Newer frames replace queued ones at vertical blank. No tearing and lower latency than `VSYNC`
+                MAILBOX,
+
+                /// @brief Show frames as soon as they are done. Lowest latency, but tears
+                IMMEDIATE
             } reset { resolution::reset::VSYNC };
         };
+
+        /// @brief Presentation and CPU pacing settings of a framebuffer
+        struct frame_pacing
+        {
+            /// @brief Present mode. Unsupported modes fall back to `VSYNC`
+            enum resolution::reset mode { resolution::reset::VSYNC };
+
+            /// @brief Minimum swapchain images. `0` picks one more than the surface minimum
+            u32 image_count { 0 };
+
+            /// @brief Frame rate cap. `0` leaves the rate to the present mode
+            f32 max_frame_rate { 0.f };
+
+            /** @brief Delay each frame's start until just before the GPU needs it, so input is sampled as late as possible */
+            bool low_latency { false };
+        };
         
         struct init_info
         {
@@ -43,9 +74,15 @@ namespace blade
             // Enable debug behavior
             bool enable_debug { false };
 
-            /** @brief Require a surface like a window to render to */
+            /** @brief Render without a surface. Framebuffers without window data render into device-local images */
             bool headless { false };
 
+            /** @brief Put buffers, images and samplers into update-after-bind descriptor arrays indexed through push constants */
+            bool bindless { false };
+
+            /** @brief Replay per-frame calls on a render thread one frame behind the caller. Calls that return a value still run in place */
+            bool use_render_thread { false };
+
             /** @brief Resolution information */
             struct resolution resolution {};
         };
@@ -60,54 +97,183 @@ namespace blade
                 virtual bool shutdown() noexcept = 0;
                 virtual void frame() noexcept = 0;
                 virtual framebuffer_handle create_framebuffer(framebuffer_create_info create_info) noexcept = 0;
-                virtual shader_handle create_shader(const std::vector<u8>& mem) noexcept = 0;
+                virtual shader_handle create_shader(const core::memory* code) noexcept = 0;
                 virtual program_handle create_view_program(const framebuffer_handle framebuffer, const shader_handle vertex, const shader_handle fragment) noexcept = 0;
                 virtual buffer_handle create_vertex_buffer(const core::memory* memory, const vertex_layout& layout) noexcept = 0;
                 virtual buffer_handle create_index_buffer(const core::memory* memory) noexcept = 0;
+                virtual void destroy_shader(const shader_handle handle) noexcept = 0;
+                virtual void destroy_view_program(const program_handle handle) noexcept = 0;
+                virtual void destroy_buffer(const buffer_handle handle) noexcept = 0;
                 virtual void set_viewport(const framebuffer_handle framebuffer, f32 x, f32 y, struct width width, struct height height) noexcept = 0;
-                virtual void attach_vertex_buffer(const buffer_handle handle) noexcept = 0;
-                virtual void set_vertex_buffer(const buffer_handle handle) noexcept = 0;
-                virtual void set_index_buffer(const buffer_handle handle) noexcept = 0;
+                virtual void set_render_state(const framebuffer_handle framebuffer, const render_state& state) noexcept = 0;
+                virtual bool read_framebuffer(const framebuffer_handle framebuffer, u32 target, readback_callback callback) noexcept = 0;
+                virtual void set_frame_pacing(const framebuffer_handle framebuffer, const frame_pacing& pacing) noexcept = 0;
+                virtual void draw(const framebuffer_handle framebuffer, const draw_call& call) noexcept = 0;
+                virtual void attach_vertex_buffer(const framebuffer_handle framebuffer, const buffer_handle handle) noexcept = 0;
+                virtual void set_vertex_buffer(const framebuffer_handle framebuffer, const buffer_handle handle) noexcept = 0;
+                virtual void set_index_buffer(const framebuffer_handle framebuffer, const buffer_handle handle) noexcept = 0;
+                virtual u32 get_bindless_index(const buffer_handle handle) noexcept = 0;
+                virtual bool declare_push_constants(const framebuffer_handle framebuffer, const push_constant_range range) noexcept = 0;
+                virtual void set_push_constants(const framebuffer_handle framebuffer, const void* data, u32 size, u32 offset) noexcept = 0;
 
                 virtual void submit() = 0;
             
             private:
         };
 
+        class render_thread;
+
         /// @brief User facing GFX interface
         class renderer
         {
             public:
                 [[nodiscard]] static std::unique_ptr<renderer> create(const init_info& init) noexcept;
 
+                ~renderer() noexcept;
+
                 void shutdown() noexcept;
 
                 [[nodiscard]] framebuffer_handle create_framebuffer(framebuffer_create_info create_info) noexcept;
 
+                /**
+                 * @brief Compile a shader module
+                 * @note Safe from any thread. The shader is usable by programs queued after it
+                 */
                 [[nodiscard]] shader_handle create_shader(const std::vector<u8>& mem) noexcept;
 
+                /**
+                 * @brief Compile a shader module from SPIR-V memory
+                 * @note Safe from any thread. `code` is released once the module is compiled
+                 */
+                [[nodiscard]] shader_handle create_shader(const core::memory* code) noexcept;
+
+                /**
+                 * @brief Build the framebuffer's pipeline from two shaders
+                 * @note Safe from any thread. The pipeline is built at the next frame boundary
+                 */
                 [[nodiscard]] program_handle create_view_program(const framebuffer_handle framebuffer, const shader_handle vertex, const shader_handle fragment) noexcept;
 
+                /**
+                 * @brief Upload vertex data to a device local buffer
+                 * @note Safe from any thread. `memory` is copied and released before returning, the GPU copy runs at the next frame boundary
+                 */
                 [[nodiscard]] buffer_handle create_vertex_buffer(const core::memory* memory, const vertex_layout& layout) noexcept;
 
+                /**
+                 * @brief Upload index data to a device local buffer
+                 * @note Safe from any thread. `memory` is copied and released before returning, the GPU copy runs at the next frame boundary
+                 */
                 [[nodiscard]] buffer_handle create_index_buffer(const core::memory* memory) const noexcept;
 
-                void set_index_buffer(const buffer_handle handle) const noexcept;
+                /**
+                 * @brief Release a shader. Its handle is invalid from here on
+                 * @note Programs built from the shader must be destroyed first
+                 */
+                void destroy_shader(const shader_handle handle) const noexcept;
 
-                void attach_vertex_buffer(const buffer_handle handle) const noexcept;
+                /**
+                 * @brief Release a program and the pipelines built from it. The framebuffer only clears until it gets a new program
+                 * @note The pipelines are freed once the frames that may use them have finished on the GPU
+                 */
+                void destroy_view_program(const program_handle handle) const noexcept;
 
-                void set_vertex_buffer(const buffer_handle handle) const noexcept;
+                /**
+                 * @brief Release a vertex or index buffer. Framebuffers still using it stop drawing with it
+                 * @note The memory is freed once the frames that may use it have finished on the GPU
+                 */
+                void destroy_buffer(const buffer_handle handle) const noexcept;
+
+                /// @brief Use the index buffer for the framebuffer's next draws
+                void set_index_buffer(const framebuffer_handle framebuffer, const buffer_handle handle) const noexcept;
+
+                /// @brief Make the vertex buffer's layout part of the framebuffer's vertex input
+                void attach_vertex_buffer(const framebuffer_handle framebuffer, const buffer_handle handle) const noexcept;
+
+                /// @brief Use the vertex buffer for the framebuffer's next draws
+                void set_vertex_buffer(const framebuffer_handle framebuffer, const buffer_handle handle) const noexcept;
 
                 void set_viewport(const framebuffer_handle framebuffer, f32 x, f32 y, struct width width, struct height height) const noexcept;
 
+                /**
+                 * @brief Queue a draw for the framebuffer's next frame
+                 * @note Large draw lists are recorded across worker threads. Framebuffers without queued draws keep their fixed test draws
+                 */
+                void draw(const framebuffer_handle framebuffer, const draw_call& call) const noexcept;
+
+                /**
+                 * @brief Set the cull, topology, depth and blend state for the framebuffer's next draws
+                 * @note Cheap when the device supports extended dynamic state. Otherwise the first use of a state builds a pipeline
+                 */
+                void set_render_state(const framebuffer_handle framebuffer, const render_state& state) const noexcept;
+
+                /**
+                 * @brief Copy a color target to host memory after the next frame without stalling rendering
+                 * @param target Index of the color target. Windowed framebuffers only have target 0
+                 * @param callback Runs during a later `present` once the GPU copy has finished. On the render thread if `use_render_thread` is set
+                 * @return `true` if the request was queued. `false` for invalid targets or a full staging ring
+                 */
+                bool read_framebuffer(const framebuffer_handle framebuffer, u32 target, readback_callback callback) const noexcept;
+
+                /**
+                 * @brief Same as the callback version, but the pixels are copied into an image the future owns
+                 * @note The future is ready after a later `present`. A refused request resolves to an empty image
+                 */
+                std::future<readback_image> read_framebuffer(const framebuffer_handle framebuffer, u32 target) const noexcept;
+
+                /**
+                 * @brief Change the present mode, swapchain image count, frame rate cap and latency mode of a framebuffer
+                 * @note Framebuffers start with the `init_info` resolution reset mode. A new mode or image count rebuilds the swapchain on the next frame
+                 */
+                void set_frame_pacing(const framebuffer_handle framebuffer, const frame_pacing& pacing) const noexcept;
+
+                /**
+                 * @brief Get the stable index of a buffer in the bindless storage buffer array
+                 * @note Hand it to a draw's shaders through `draw_call::bindless_indices`
+                 * @return The index shaders use to reach the buffer. `BLADE_INVALID_BINDLESS_INDEX` if bindless is disabled
+                 */
+                [[nodiscard]] u32 get_bindless_index(const buffer_handle handle) const noexcept;
+
+                /**
+                 * @brief Declare a push constant range for the framebuffer's program
+                 * @note Must be called before `create_view_program`. Bindless framebuffers reserve the first
+                 *       `max_bindless_indices` words for `draw_call::bindless_indices`, so ranges start after them
+                 * @return `true` if the range fits the device limits. `false` otherwise
+                 */
+                bool declare_push_constants(const framebuffer_handle framebuffer, const push_constant_range range) const noexcept;
+
+                /**
+                 * @brief Set push constant data read by the next draws of the framebuffer
+                 * @param offset Byte offset into the push constant block. Must fall inside a declared range
+                 */
+                template <typename T>
+                void set_push_constants(const framebuffer_handle framebuffer, const T& data, u32 offset = 0) const noexcept
+                {
+                    static_assert(std::is_trivially_copyable_v<T>, "Push constant data must be trivially copyable");
+                    static_assert(sizeof(T) % 4 == 0, "Push constant data size must be a multiple of 4");
+
+                    set_push_constants(framebuffer, &data, static_cast<u32>(sizeof(T)), offset);
+                }
+
+                /// @brief Untyped variant of `set_push_constants`. `size` and `offset` must be multiples of 4
+                void set_push_constants(const framebuffer_handle framebuffer, const void* data, u32 size, u32 offset) const noexcept;
+
                 void submit() noexcept;
 
+                /**
+                 * @brief Record every framebuffer, submit them together and present the windowed ones
+                 * @note Framebuffers record on worker threads in parallel. Calls for a framebuffer must not overlap `present`
+                 */
                 void present() noexcept;
 
             private:
-                [[nodiscard]] explicit renderer() {}
+                [[nodiscard]] explicit renderer() noexcept;
+
+                /// @brief Run a call that returns a value, between render thread replays if there is one
+                template <typename R, typename F>
+                R immediate_(R fallback, F&& function) const noexcept;
                 
                 std::unique_ptr<renderer_backend> _backend { nullptr };
+                std::unique_ptr<class render_thread> _render_thread { nullptr };
         };
     }
 }
@@ -1,8 +1,13 @@
 #ifndef BLADE_GFX_VIEW_H
 #define BLADE_GFX_VIEW_H
 
+#include <array>
+#include <functional>
 #include <optional>
+#include <vector>
 #include "core/core.h"
+#include "core/memory.h"
+#include "gfx/handle.h"
 
 #ifdef BLADE_PLATFORM_WINDOWS
 #define NOMINMAX
@@ -15,6 +20,15 @@ namespace blade
 {
     namespace gfx
     {
+        /// @brief Pixel formats for offscreen color targets
+        enum class texture_format
+        {
+            rgba8,
+            bgra8,
+            rgba16f,
+            rgba32f
+        };
+
         struct framebuffer_create_info
         {
             struct native_window_data
@@ -31,6 +45,58 @@ namespace blade
             std::optional<native_window_data> native_window_data;
             struct width width{0};
             struct height height{0};
+
+            /** @brief Number of device-local color targets used when there is no window. Ignored otherwise */
+            u32 color_targets { 1 };
+
+            /** @brief Format of the offscreen color targets */
+            texture_format format { texture_format::rgba8 };
+        };
+
+        /// @brief Resource indices one draw can hand its shaders in bindless mode
+        constexpr u32 max_bindless_indices = 4;
+
+        /// @brief One draw of a framebuffer's current vertex and index buffers
+        struct draw_call
+        {
+            u32 vertex_count   { 0 };
+
+            /// @brief Draw indexed from the framebuffer's index buffer when non-zero
+            u32 index_count    { 0 };
+            u32 instance_count { 1 };
+            u32 first_vertex   { 0 };
+            u32 first_index    { 0 };
+            i32 vertex_offset  { 0 };
+            u32 first_instance { 0 };
+
+            /// @brief Indices from `get_bindless_index`, pushed at offset 0 for this draw only. Ignored without bindless
+            std::array<u32, max_bindless_indices> bindless_indices {
+                BLADE_INVALID_BINDLESS_INDEX, BLADE_INVALID_BINDLESS_INDEX, BLADE_INVALID_BINDLESS_INDEX, BLADE_INVALID_BINDLESS_INDEX
+            };
+        };
+
+        /// @brief Tightly packed pixels of one color target copied back to host memory
+        struct readback
+        {
+            core::memory pixels {};
+            struct width width {0};
+            struct height height {0};
+            texture_format format { texture_format::rgba8 };
+        };
+
+        /**
+         * @brief Called once the copy has finished. The pixels are only valid during the call
+         * @note Requests dropped before reaching the GPU, like across a resize, are called with no pixels
+         */
+        using readback_callback = std::function<void(const readback&)>;
+
+        /// @brief Readback that owns its pixels, for callers that wait on a future instead
+        struct readback_image
+        {
+            std::vector<u8> pixels {};
+            struct width width {0};
+            struct height height {0};
+            texture_format format { texture_format::rgba8 };
         };
     } // gfx namespace
 } // blade namespace
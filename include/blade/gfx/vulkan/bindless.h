@@ -0,0 +1,137 @@
+#ifndef BLADE_GFX_VULKAN_BINDLESS_H
+#define BLADE_GFX_VULKAN_BINDLESS_H
+
+#include "gfx/handle.h"
+#include "gfx/view.h"
+#include "gfx/vulkan/common.h"
+#include "gfx/vulkan/device.h"
+
+#include <array>
+#include <memory>
+#include <optional>
+#include <vector>
+#include <vulkan/vulkan_core.h>
+
+namespace blade
+{
+    namespace gfx
+    {
+        namespace vk
+        {
+            /**
+             * @brief A single update-after-bind descriptor set holding every buffer, sampled image and sampler
+             *
+             * Resources registered with the set receive a stable index into their array that stays valid until
+             * the resource is released. Shaders receive these indices through push constants, so the set is
+             * bound once per command buffer instead of per draw.
+             */
+            class bindless_set
+            {
+                public:
+                    /// @brief Binding slots of the arrays inside the bindless descriptor set
+                    enum binding : u32
+                    {
+                        storage_buffers = 0,
+                        sampled_images  = 1,
+                        samplers        = 2,
+
+                        count
+                    };
+
+                    /// @brief Size of the index block reserved at offset 0 of every bindless pipeline layout's push constants
+                    static constexpr u32 push_constant_size = max_bindless_indices * sizeof(u32);
+
+                    struct builder
+                    {
+                        [[nodiscard]] explicit builder(std::weak_ptr<class device> device) noexcept
+                            : info { device }
+                        {}
+
+                        std::optional<std::shared_ptr<bindless_set>> build() const noexcept;
+
+                        builder& set_max_buffers(u32 count) noexcept;
+                        builder& set_max_sampled_images(u32 count) noexcept;
+                        builder& set_max_samplers(u32 count) noexcept;
+                        builder& set_allocation_callbacks(VkAllocationCallbacks* callbacks) noexcept;
+
+                        struct
+                        {
+                            std::weak_ptr<class device> device          {};
+                            u32 max_buffers                             { 1u << 16 };
+                            u32 max_sampled_images                      { 1u << 16 };
+                            u32 max_samplers                            { 1u << 10 };
+                            VkAllocationCallbacks* allocation_callbacks { nullptr };
+                        } info;
+                    };
+
+                    [[nodiscard]] explicit bindless_set(std::weak_ptr<class device> device, VkAllocationCallbacks* callbacks) noexcept
+                        : _device { device }
+                        , _allocation_callbacks { callbacks }
+                    {}
+
+                    /**
+                     * @brief Write a buffer into the storage buffer array
+                     * @return Stable index of the buffer or `std::nullopt` if the array is full
+                     */
+                    std::optional<u32> register_buffer(VkBuffer buffer, VkDeviceSize offset = 0, VkDeviceSize range = VK_WHOLE_SIZE) noexcept;
+
+                    /**
+                     * @brief Write an image view into the sampled image array
+                     * @return Stable index of the image or `std::nullopt` if the array is full
+                     */
+                    std::optional<u32> register_sampled_image(VkImageView view, VkImageLayout layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL) noexcept;
+
+                    /**
+                     * @brief Write a sampler into the sampler array
+                     * @return Stable index of the sampler or `std::nullopt` if the array is full
+                     */
+                    std::optional<u32> register_sampler(VkSampler sampler) noexcept;
+
+                    /**
+                     * @brief Return a slot to its array so it can be reused
+                     * @note The caller must ensure the GPU is done with the resource before the slot is rewritten
+                     */
+                    void release(enum binding binding, u32 index) noexcept;
+
+                    [[nodiscard]] VkDescriptorSetLayout layout() const noexcept { return _layout; }
+                    [[nodiscard]] VkDescriptorSet handle() const noexcept { return _set; }
+
+                    /// @brief The push constant bytes every bindless pipeline layout reserves for a draw's resource indices
+                    [[nodiscard]] static VkPushConstantRange push_constant_range() noexcept
+                    {
+                        return VkPushConstantRange{
+                            .stageFlags = VK_SHADER_STAGE_ALL_GRAPHICS,
+                            .offset = 0,
+                            .size = push_constant_size,
+                        };
+                    }
+
+                    void destroy() noexcept;
+
+                private:
+                    /// @brief Hands out stable array slots and recycles released ones
+                    struct slot_allocator
+                    {
+                        u32 capacity             { 0 };
+                        u32 next                 { 0 };
+                        std::vector<u32> free    {};
+
+                        std::optional<u32> acquire() noexcept;
+                        void release(u32 index) noexcept;
+                    };
+
+                    void write_(enum binding binding, u32 index, VkDescriptorType type, const VkDescriptorImageInfo* image_info, const VkDescriptorBufferInfo* buffer_info) const noexcept;
+
+                private:
+                    std::weak_ptr<class device> _device                        {};
+                    VkAllocationCallbacks* _allocation_callbacks               { nullptr };
+                    VkDescriptorSetLayout _layout                              { VK_NULL_HANDLE };
+                    VkDescriptorPool _pool                                     { VK_NULL_HANDLE };
+                    VkDescriptorSet _set                                       { VK_NULL_HANDLE };
+                    std::array<slot_allocator, binding::count> _slots          {};
+            };
+        } // vk namespace
+    } // gfx namespace
+} // blade namespace
+
+#endif // BLADE_GFX_VULKAN_BINDLESS_H
@@ -55,6 +55,18 @@ namespace blade
 
                     void map_memory(void* memory) noexcept;
 
+                    /**
+                     * @brief Map host visible memory for reading
+                     * @return Pointer to the buffer contents or `nullptr` on failure. Call `unmap` when done
+                     */
+                    [[nodiscard]] const void* map() noexcept;
+                    void unmap() noexcept;
+
+                    /// @brief Make device writes visible to a mapping of non-coherent memory
+                    void invalidate() noexcept;
+
+                    [[nodiscard]] VkMemoryRequirements memory_requirements() const noexcept;
+
                     [[nodiscard]] u32 size() const noexcept { return _size; }
 
                 private:
@@ -2,10 +2,12 @@
 #define BLADE_GFX_VULKAN_COMMAND_POOL_H
 #include "gfx/vulkan/common.h"
 #include "gfx/vulkan/device.h"
+#include "gfx/vulkan/pipeline.h"
 #include "gfx/vulkan/renderpass.h"
 #include <optional>
 #include <limits>
 #include <memory>
+#include <span>
 #include <vector>
 #include <vulkan/vulkan_core.h>
 
@@ -24,6 +26,9 @@ namespace blade
 
                     class recording;
                     std::optional<command_buffer::recording> begin(VkCommandBufferUsageFlags flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT) noexcept;
+
+                    /// @brief Begin a secondary buffer that continues `rp` in the primary buffer executing it
+                    std::optional<command_buffer::recording> begin_secondary(std::weak_ptr<renderpass> rp, VkFramebuffer framebuffer, VkCommandBufferUsageFlags flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT) noexcept;
                     void reset() const noexcept;
                     void submit(const std::vector<VkSemaphore>& semaphores) const noexcept;
                     void end() noexcept;
@@ -51,9 +56,13 @@ namespace blade
                                         recording& rec
                                         , std::weak_ptr<renderpass> rp
                                         , VkFramebuffer framebuffer
-                                        , const std::vector<VkClearValue>& clear_values
+                                        , std::span<const VkClearValue> clear_values
                                         , VkRect2D render_area
+                                        , VkSubpassContents contents = VK_SUBPASS_CONTENTS_INLINE
                                     ) noexcept;
+
+                                    /// @brief Record into a renderpass begun by the primary buffer. `end` leaves it to the primary
+                                    record_renderpass(recording& rec, std::weak_ptr<renderpass> rp) noexcept;
                                     
                                     ~record_renderpass() noexcept;
 
@@ -66,15 +75,24 @@ namespace blade
                                     void bind_vertex_buffers(VkBuffer* buffers) const noexcept;
                                     void bind_index_buffers(VkBuffer buffers, VkDeviceSize size) const noexcept;
                                     void bind_pipeline(VkPipelineBindPoint bind_point, VkPipeline pipeline) const noexcept;
+                                    void bind_descriptor_set(VkPipelineBindPoint bind_point, VkPipelineLayout layout, u32 first_set, VkDescriptorSet set) const noexcept;
+                                    void push_constants(VkPipelineLayout layout, VkShaderStageFlags stages, u32 offset, u32 size, const void* data) const noexcept;
                                     void set_viewport(VkViewport viewport) const noexcept;
                                     void set_scissor(VkRect2D scissor) const noexcept;
+
+                                    /// @brief Set every state that has a loaded command. States without one are baked into the pipeline
+                                    void set_dynamic_state(const device::dynamic_state_commands& commands, const struct dynamic_state& state, u32 color_attachment_count = 1) const noexcept;
                                     void draw(u32 vertex_count, u32 instance_count, u32 first_vertex, u32 first_instance) const noexcept;
                                     void draw_indexed(u32 index_count, u32 instance_count, u32 first_index, i32 vertex_offset, u32 first_instance) const noexcept;
+
+                                    /// @brief Run secondary buffers. The pass must have begun with secondary contents
+                                    void execute_commands(std::span<const VkCommandBuffer> buffers) const noexcept;
                                     bool end() noexcept;
                                 private:
                                     recording& _recording;
                                     std::weak_ptr<renderpass> _renderpass {};
                                     bool _active                          { false };
+                                    bool _inherited                       { false };
                             };
 
                             class record_transfer
@@ -83,6 +101,18 @@ namespace blade
                                     [[nodiscard]] record_transfer(recording& rec) noexcept;
 
                                     void copy_buffers(VkBuffer scr, VkBuffer dst, const VkDeviceSize size) const noexcept;
+                                    void copy_image_to_buffer(VkImage src, VkImageLayout layout, VkBuffer dst, VkExtent2D extent) const noexcept;
+
+                                    /// @brief Move a color image between layouts once the source stage's accesses are done
+                                    void transition_image(
+                                        VkImage image
+                                        , VkImageLayout from
+                                        , VkImageLayout to
+                                        , VkPipelineStageFlags src_stage
+                                        , VkAccessFlags src_access
+                                        , VkPipelineStageFlags dst_stage
+                                        , VkAccessFlags dst_access
+                                    ) const noexcept;
                                     bool end() noexcept;
                                 private:
                                     recording& _recording;
@@ -90,7 +120,10 @@ namespace blade
 
                             static std::optional<recording> create(command_buffer& cb, VkCommandBufferBeginInfo begin_info) noexcept;
 
-                            [[nodiscard]] record_renderpass begin_renderpass(std::weak_ptr<renderpass> rp, VkFramebuffer framebuffer, const std::vector<VkClearValue>& clear_values, VkRect2D render_area) noexcept;
+                            [[nodiscard]] record_renderpass begin_renderpass(std::weak_ptr<renderpass> rp, VkFramebuffer framebuffer, std::span<const VkClearValue> clear_values, VkRect2D render_area, VkSubpassContents contents = VK_SUBPASS_CONTENTS_INLINE) noexcept;
+
+                            /// @brief Record draws of a secondary buffer begun with `begin_secondary`
+                            [[nodiscard]] record_renderpass continue_renderpass(std::weak_ptr<renderpass> rp) noexcept;
                             [[nodiscard]] record_transfer begin_transfer() noexcept;
 
                         private:
@@ -119,7 +152,7 @@ namespace blade
                      * @param num_buffers The number of buffers to allocate
                      * @return `true` on success. `false` otherwise (typically attempting to create buffers after creating some before)
                      */
-                    std::vector<VkCommandBuffer> allocate_buffers(const u32 num_buffers) noexcept;
+                    std::vector<VkCommandBuffer> allocate_buffers(const u32 num_buffers, VkCommandBufferLevel level = VK_COMMAND_BUFFER_LEVEL_PRIMARY) noexcept;
 
                     std::optional<command_buffer> allocate_single() noexcept;
 
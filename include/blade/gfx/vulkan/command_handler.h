@@ -1,7 +1,11 @@
 #ifndef BLADE_GFX_VULKAN_COMMAND_HANDLER_H
 #define BLADE_GFX_VULKAN_COMMAND_HANDLER_H
+#include "core/containers/flat_hash_map.h"
+#include "core/containers/free_list.h"
 #include "gfx/vulkan/common.h"
 #include "gfx/vulkan/command.h"
+#include <utility>
+#include <vector>
 
 namespace blade
 {
@@ -12,7 +16,7 @@ namespace blade
             class command_handler
             {
             public:
-                [[nodiscard]] explicit command_handler(std::weak_ptr<class device> device, queue_type queue) noexcept;
+                [[nodiscard]] explicit command_handler(std::weak_ptr<class device> device, queue_type queue, VkAllocationCallbacks* callbacks = nullptr) noexcept;
 
                 /**
                  * @brief Submit a command buffer after being recorded
@@ -27,6 +31,14 @@ namespace blade
                     , VkPipelineStageFlags wait_stage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT
                 ) const noexcept;
 
+                /**
+                 * @brief Record that a command buffer went out in a batch submitted elsewhere
+                 * @param batch The batch it went out in, stamped with `batch_serial`. `nullptr` if the submission
+                 *        failed, in which case the buffer never reached the queue and is recycled right away
+                 * @return The serial stamped on the submission
+                 */
+                u64 mark_submitted(VkCommandBuffer buffer, class submit_batch* batch, u64 batch_serial) noexcept;
+
                 /**
                  * @brief Update the command buffers and free list
                  */
@@ -38,6 +50,11 @@ namespace blade
                  */
                 VkCommandBuffer acquire_command_buffer() noexcept;
 
+                /**
+                 * @brief Return an acquired command buffer that was never submitted to the free list
+                 */
+                void release_command_buffer(VkCommandBuffer buffer) noexcept;
+
                 /**
                  * @brief Wait on a command buffer to be ready
                  */
@@ -48,6 +65,23 @@ namespace blade
                  */
                 void reset_command_buffer_fence(VkCommandBuffer) const noexcept;
 
+                /**
+                 * @brief Serial of the most recent submission. Every submit increments it
+                 */
+                [[nodiscard]] u64 submitted_serial() const noexcept { return _submitted_serial; }
+
+                /**
+                 * @brief Highest serial whose work, and all work submitted before it, has finished on the GPU
+                 * @note Only as current as the last `update()`
+                 */
+                [[nodiscard]] u64 completed_serial() const noexcept;
+
+                /**
+                 * @brief Block until the submission stamped with `serial` has finished on the GPU
+                 * @return `false` if the timeout (in nanoseconds) expired first
+                 */
+                bool wait_for_serial(u64 serial, u64 timeout) const noexcept;
+
                 /**
                  * @brief Destroy created resources and other shutdown behavior
                  */
@@ -67,7 +101,11 @@ namespace blade
                     {
                         VkCommandBuffer command_buffer{VK_NULL_HANDLE};
                         VkFence fence{VK_NULL_HANDLE};
+
+                        /// @brief Serial of the batch the buffer was last submitted in. `0` if it used `fence`
+                        u64 batch_serial{0};
                         bool is_submitted{false};
+                        u64 serial{0};
                         node* next{nullptr};
 
                         [[nodiscard]] explicit node(
@@ -100,16 +138,68 @@ namespace blade
 
             private:
                 std::optional<VkFence> create_fence_() const noexcept;
+                bool is_complete_(const buffer_free_list::node& node) const noexcept;
                 void process_completed_buffers_() noexcept;
 
             private:
                 std::weak_ptr<device> _device{};
+                VkAllocationCallbacks* _allocation_callbacks{nullptr};
+
+                /// @brief Batch the buffers marked submitted went out in. Its fences are recycled, so only its serials are kept
+                class submit_batch* _batch{nullptr};
 
                 buffer_free_list _free_list{};
                 std::shared_ptr<command_pool> _command_pool{nullptr};
-                std::unordered_map<VkCommandBuffer, buffer_free_list::node*> _active_nodes{};
-                std::vector<std::unique_ptr<buffer_free_list::node>> _all_buffer_nodes{};
+                core::flat_hash_map<VkCommandBuffer, buffer_free_list::node*> _active_nodes{};
+                core::free_list<buffer_free_list::node, 16> _node_pool{};
+                std::vector<buffer_free_list::node*> _all_buffer_nodes{};
                 std::vector<VkCommandBuffer> _all_command_buffers{};
+                mutable u64 _submitted_serial{0};
+            };
+
+            /**
+             * @brief One command pool per recording thread for secondary command buffers
+             *
+             * Command pools are externally synchronized, so each worker only ever allocates from its own pool.
+             * Buffers handed out for a frame are stamped with the serial of the primary buffer executing them and
+             * reused once that serial has completed.
+             */
+            class thread_command_pools
+            {
+            public:
+                [[nodiscard]] explicit thread_command_pools(std::weak_ptr<class device> device, queue_type queue, u32 thread_count, VkAllocationCallbacks* callbacks = nullptr) noexcept;
+
+                [[nodiscard]] u32 thread_count() const noexcept { return static_cast<u32>(_pools.size()); }
+
+                /**
+                 * @brief Get a secondary buffer from the pool of worker `thread`
+                 * @note Only the thread recording as `thread` may call this until the frame is submitted
+                 * @return `VK_NULL_HANDLE` if `thread` is out of range or the pool could not be created
+                 */
+                VkCommandBuffer acquire_secondary(u32 thread) noexcept;
+
+                /// @brief Stamp the buffers acquired since the last submit with the primary buffer's serial
+                void submit(u64 serial) noexcept;
+
+                /// @brief Return the buffers of every completed serial to their pools
+                void release(u64 completed_serial) noexcept;
+
+                void destroy() noexcept;
+
+            private:
+                struct thread_pool
+                {
+                    std::shared_ptr<command_pool> pool {nullptr};
+                    std::vector<VkCommandBuffer> free {};
+
+                    /// @brief Buffers waiting on their serial. `0` until the frame using them is submitted
+                    std::vector<std::pair<u64, VkCommandBuffer>> pending {};
+                };
+
+                std::weak_ptr<device> _device{};
+                VkAllocationCallbacks* _allocation_callbacks{nullptr};
+                u32 _queue_family_index{0};
+                std::vector<thread_pool> _pools{};
             };
         } // vk namespace
     } // gfx namespace
@@ -0,0 +1,48 @@
+#ifndef BLADE_GFX_VULKAN_DELETION_QUEUE_H
+#define BLADE_GFX_VULKAN_DELETION_QUEUE_H
+
+#include "gfx/vulkan/common.h"
+
+#include <deque>
+#include <functional>
+
+namespace blade
+{
+    namespace gfx
+    {
+        namespace vk
+        {
+            /**
+             * @brief Frees resources once the GPU has finished every submission that may still use them
+             *
+             * Each deleter is tagged with the serial of the last submission at the time the resource was dropped.
+             * Serials only grow, so the queue stays sorted and `collect` only looks at its front.
+             */
+            class deletion_queue
+            {
+                public:
+                    /// @brief Run `deleter` once submission `serial` has completed
+                    void push(u64 serial, std::function<void()> deleter) noexcept;
+
+                    /// @brief Run every deleter whose serial is at or below `completed_serial`
+                    void collect(u64 completed_serial) noexcept;
+
+                    /// @brief Run every deleter. The device must be idle
+                    void flush() noexcept;
+
+                    [[nodiscard]] usize size() const noexcept { return _entries.size(); }
+
+                private:
+                    struct entry
+                    {
+                        u64 serial { 0 };
+                        std::function<void()> deleter {};
+                    };
+
+                    std::deque<entry> _entries {};
+            };
+        } // vk namespace
+    } // gfx namespace
+} // blade namespace
+
+#endif // BLADE_GFX_VULKAN_DELETION_QUEUE_H
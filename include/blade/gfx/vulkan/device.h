@@ -29,8 +29,8 @@ namespace blade
                 {
                     _info.physical_device = physical_device;
                     set_properties_();
-                    set_features_();
                     set_extensions_();
+                    set_features_();
                     set_memory_properties_();
                     find_queue_family_indices_();
 
@@ -46,6 +46,15 @@ namespace blade
                         _info.physical_device = other._info.physical_device;
                         _info.properties = other._info.properties;
                         _info.features = other._info.features;
+                        _info.vulkan12_features = other._info.vulkan12_features;
+                        _info.extended_dynamic_state_features = other._info.extended_dynamic_state_features;
+                        _info.extended_dynamic_state2_features = other._info.extended_dynamic_state2_features;
+                        _info.extended_dynamic_state3_features = other._info.extended_dynamic_state3_features;
+                        _info.graphics_pipeline_library_features = other._info.graphics_pipeline_library_features;
+                        _info.graphics_pipeline_library_properties = other._info.graphics_pipeline_library_properties;
+                        _info.present_id_features = other._info.present_id_features;
+                        _info.present_wait_features = other._info.present_wait_features;
+                        _info.descriptor_indexing_properties = other._info.descriptor_indexing_properties;
                         _info.memory_properties = other._info.memory_properties;
                         _info.extensions = other._info.extensions;
                         _info.queue_families = other._info.queue_families;
@@ -66,6 +75,15 @@ namespace blade
                         _info.physical_device = other._info.physical_device;
                         _info.properties = other._info.properties;
                         _info.features = other._info.features;
+                        _info.vulkan12_features = other._info.vulkan12_features;
+                        _info.extended_dynamic_state_features = other._info.extended_dynamic_state_features;
+                        _info.extended_dynamic_state2_features = other._info.extended_dynamic_state2_features;
+                        _info.extended_dynamic_state3_features = other._info.extended_dynamic_state3_features;
+                        _info.graphics_pipeline_library_features = other._info.graphics_pipeline_library_features;
+                        _info.graphics_pipeline_library_properties = other._info.graphics_pipeline_library_properties;
+                        _info.present_id_features = other._info.present_id_features;
+                        _info.present_wait_features = other._info.present_wait_features;
+                        _info.descriptor_indexing_properties = other._info.descriptor_indexing_properties;
                         _info.memory_properties = other._info.memory_properties;
                         _info.extensions = other._info.extensions;
                         _info.queue_families = other._info.queue_families;
@@ -94,6 +112,45 @@ namespace blade
                  */
                 const VkPhysicalDeviceFeatures* get_features_ptr() const { return &_info.features; }
 
+                /**
+                 * @brief Get the Vulkan 1.2 features of this physical device
+                 */
+                const VkPhysicalDeviceVulkan12Features& get_vulkan12_features() const { return _info.vulkan12_features; }
+
+                /**
+                 * @brief Get the descriptor indexing limits of this physical device
+                 */
+                const VkPhysicalDeviceDescriptorIndexingProperties& get_descriptor_indexing_properties() const
+                {
+                    return _info.descriptor_indexing_properties;
+                }
+
+                /**
+                 * @brief Check if the device supports everything needed for update-after-bind descriptor arrays
+                 * @return `true` if bindless descriptors can be used and `false` otherwise
+                 */
+                bool supports_descriptor_indexing() const noexcept;
+
+                /**
+                 * @brief Check which `VK_EXT_extended_dynamic_state` levels the device supports
+                 * @return `true` if the extension and the features the backend sets at record time are available
+                 */
+                bool supports_extended_dynamic_state() const noexcept;
+                bool supports_extended_dynamic_state2() const noexcept;
+                bool supports_extended_dynamic_state3() const noexcept;
+
+                /**
+                 * @brief Check if pipelines can be split into separately compiled libraries and linked
+                 * @return `true` if `VK_EXT_graphics_pipeline_library` with fast linking is available
+                 */
+                bool supports_graphics_pipeline_library() const noexcept;
+
+                /**
+                 * @brief Check if presents can be tagged with an id and waited on until they reach the display
+                 * @return `true` if both `VK_KHR_present_id` and `VK_KHR_present_wait` are available
+                 */
+                bool supports_present_wait() const noexcept;
+
                 /**
                  * @brief Query the `VkMemoryDeviceProperties` to find if a memory type is supported
                  */
@@ -160,6 +217,15 @@ namespace blade
                     VkPhysicalDevice physical_device{VK_NULL_HANDLE};
                     VkPhysicalDeviceProperties properties{};
                     VkPhysicalDeviceFeatures features{};
+                    VkPhysicalDeviceVulkan12Features vulkan12_features{};
+                    VkPhysicalDeviceExtendedDynamicStateFeaturesEXT extended_dynamic_state_features{};
+                    VkPhysicalDeviceExtendedDynamicState2FeaturesEXT extended_dynamic_state2_features{};
+                    VkPhysicalDeviceExtendedDynamicState3FeaturesEXT extended_dynamic_state3_features{};
+                    VkPhysicalDeviceGraphicsPipelineLibraryFeaturesEXT graphics_pipeline_library_features{};
+                    VkPhysicalDeviceGraphicsPipelineLibraryPropertiesEXT graphics_pipeline_library_properties{};
+                    VkPhysicalDevicePresentIdFeaturesKHR present_id_features{};
+                    VkPhysicalDevicePresentWaitFeaturesKHR present_wait_features{};
+                    VkPhysicalDeviceDescriptorIndexingProperties descriptor_indexing_properties{};
                     VkPhysicalDeviceMemoryProperties memory_properties{};
                     std::vector<VkExtensionProperties> extensions{};
                     std::vector<VkQueueFamilyProperties> queue_families{};
@@ -199,6 +265,16 @@ namespace blade
                     builder& require_extension(const char* extension) noexcept;
                     builder& require_queue(queue_type type) noexcept;
 
+                    /// @brief Enable descriptor indexing features for bindless descriptors if the device supports them
+                    builder& request_descriptor_indexing(bool enabled = true) noexcept;
+
+                    /// @brief Enable the extended dynamic state extensions the device supports
+                    builder& request_extended_dynamic_state(bool enabled = true) noexcept;
+
+                    /// @brief Enable graphics pipeline libraries for fast-linked pipelines if the device supports them
+                    builder& request_graphics_pipeline_library(bool enabled = true) noexcept;
+                    builder& request_present_wait(bool enabled = true) noexcept;
+
                     struct
                     {
                         std::weak_ptr<const class instance> instance{};
@@ -211,6 +287,11 @@ namespace blade
                         bool require_transfer_queue{false};
                         bool require_present_queue{false};
                         bool require_compute_queue{false};
+
+                        bool request_descriptor_indexing{false};
+                        bool request_extended_dynamic_state{false};
+                        bool request_graphics_pipeline_library{false};
+                        bool request_present_wait{false};
                     } info;
 
                 private:
@@ -223,6 +304,9 @@ namespace blade
                     {
                         _physical_device = std::move(other._physical_device);
                         _logical_device = std::exchange(other._logical_device, VK_NULL_HANDLE);
+                        _enabled_features = other._enabled_features;
+                        _dynamic_state_commands = other._dynamic_state_commands;
+                        _wait_for_present = other._wait_for_present;
                     }
                 }
 
@@ -232,6 +316,9 @@ namespace blade
                     {
                         _physical_device = std::move(other._physical_device);
                         _logical_device = std::exchange(other._logical_device, VK_NULL_HANDLE);
+                        _enabled_features = other._enabled_features;
+                        _dynamic_state_commands = other._dynamic_state_commands;
+                        _wait_for_present = other._wait_for_present;
                     }
 
                     return *this;
@@ -263,6 +350,42 @@ namespace blade
 
                 void destroy() noexcept;
 
+                /**
+                 * @brief Optional features that were requested and enabled when the device was created
+                 */
+                struct enabled_features
+                {
+                    bool descriptor_indexing{false};
+                    bool extended_dynamic_state{false};
+                    bool extended_dynamic_state2{false};
+                    bool extended_dynamic_state3{false};
+                    bool graphics_pipeline_library{false};
+                    bool present_wait{false};
+                };
+
+                const enabled_features& get_enabled_features() const noexcept { return _enabled_features; }
+
+                /**
+                 * @brief Extension commands loaded for the enabled extended dynamic state levels
+                 * @note Pointers for levels that were not enabled are `nullptr`
+                 */
+                struct dynamic_state_commands
+                {
+                    PFN_vkCmdSetCullModeEXT cmd_set_cull_mode{nullptr};
+                    PFN_vkCmdSetFrontFaceEXT cmd_set_front_face{nullptr};
+                    PFN_vkCmdSetPrimitiveTopologyEXT cmd_set_primitive_topology{nullptr};
+                    PFN_vkCmdSetDepthTestEnableEXT cmd_set_depth_test_enable{nullptr};
+                    PFN_vkCmdSetDepthWriteEnableEXT cmd_set_depth_write_enable{nullptr};
+                    PFN_vkCmdSetDepthCompareOpEXT cmd_set_depth_compare_op{nullptr};
+                    PFN_vkCmdSetPrimitiveRestartEnableEXT cmd_set_primitive_restart_enable{nullptr};
+                    PFN_vkCmdSetPolygonModeEXT cmd_set_polygon_mode{nullptr};
+                    PFN_vkCmdSetColorBlendEnableEXT cmd_set_color_blend_enable{nullptr};
+                };
+
+                const dynamic_state_commands& get_dynamic_state_commands() const noexcept { return _dynamic_state_commands; }
+
+                /// @brief `vkWaitForPresentKHR`, or `nullptr` if present wait was not enabled
+                PFN_vkWaitForPresentKHR get_wait_for_present_command() const noexcept { return _wait_for_present; }
 
                 [[nodiscard]] std::optional<u32> get_queue_index(const queue_type type) const noexcept;
 
@@ -280,6 +403,11 @@ namespace blade
                 std::shared_ptr<physical_device> _physical_device{nullptr};
                 VkDevice _logical_device{VK_NULL_HANDLE};
                 VkAllocationCallbacks* _allocation_callbacks{nullptr};
+                enabled_features _enabled_features{};
+                dynamic_state_commands _dynamic_state_commands{};
+                PFN_vkWaitForPresentKHR _wait_for_present{nullptr};
+
+                void load_dynamic_state_commands_() noexcept;
             };
         } // vk namespace
     } // gfx namespace
@@ -0,0 +1,66 @@
+#ifndef BLADE_GFX_VULKAN_FRAME_PACER_H
+#define BLADE_GFX_VULKAN_FRAME_PACER_H
+
+#include "gfx/vulkan/common.h"
+
+#include <chrono>
+
+namespace blade
+{
+    namespace gfx
+    {
+        namespace vk
+        {
+            /**
+             * @brief Decides when the CPU may start recording the next frame
+             *
+             * The limiter keeps frame starts at least `1 / max_frame_rate` apart. In low latency mode the view
+             * reports when each frame finished on the GPU (or reached the display, with present wait), and the
+             * start of the next frame is pushed back so its recording ends just as the GPU frees up. Input read
+             * at frame start is then as fresh as possible when its image is shown.
+             */
+            class frame_pacer
+            {
+                public:
+                    using clock = std::chrono::steady_clock;
+
+                    /// @brief Cap the frame rate. `0` disables the limiter
+                    void set_max_frame_rate(f32 max_frame_rate) noexcept;
+
+                    void set_low_latency(bool enabled) noexcept;
+
+                    [[nodiscard]] bool low_latency() const noexcept { return _low_latency; }
+
+                    /// @brief Record that an earlier frame finished on the GPU or reached the display at `time`
+                    void frame_completed(clock::time_point time) noexcept;
+
+                    /// @brief Sleep until the next frame should start. Inside a fiber task, yields to other jobs instead
+                    void wait_for_frame_start() noexcept;
+
+                    /// @brief Mark the end of the CPU work of the frame started by `wait_for_frame_start`
+                    void frame_submitted() noexcept;
+
+                    /// @brief Forget measured intervals, e.g. after a swapchain rebuild changed the present rate
+                    void reset() noexcept;
+
+                private:
+                    /// @brief Weight of the newest sample in the moving averages
+                    static constexpr f64 smoothing = 0.1;
+
+                    /// @brief Margin left for scheduling jitter so a late wake-up does not starve the GPU
+                    static constexpr clock::duration slack = std::chrono::microseconds(500);
+
+                private:
+                    clock::duration _min_frame_time      { clock::duration::zero() };
+                    bool _low_latency                    { false };
+
+                    clock::time_point _frame_start       {};
+                    clock::time_point _last_completion   {};
+                    f64 _completion_interval             { 0.0 };
+                    f64 _cpu_frame_time                  { 0.0 };
+            };
+        } // vk namespace
+    } // gfx namespace
+} // blade namespace
+
+#endif // BLADE_GFX_VULKAN_FRAME_PACER_H
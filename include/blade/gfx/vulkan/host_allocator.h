@@ -0,0 +1,71 @@
+#ifndef BLADE_GFX_VULKAN_HOST_ALLOCATOR_H
+#define BLADE_GFX_VULKAN_HOST_ALLOCATOR_H
+
+#include "core/allocator.h"
+#include "gfx/vulkan/common.h"
+
+#include <array>
+#include <atomic>
+
+namespace blade
+{
+    namespace gfx
+    {
+        namespace vk
+        {
+            /**
+             * @brief Vulkan allocation callbacks that forward the driver's host memory to an engine allocator
+             *
+             * Everything is charged to `core::memory_tag::driver` and also counted per allocation scope.
+             * Command-scope allocations only live for the duration of one Vulkan call, so they are served from a
+             * small per-thread linear arena that rewinds whenever its last allocation is freed.
+             *
+             * The allocator must outlive every object created with its callbacks.
+             */
+            class host_allocator
+            {
+                public:
+                    static constexpr usize command_arena_size = 64 * 1024;
+                    static constexpr usize scope_count = VK_SYSTEM_ALLOCATION_SCOPE_INSTANCE + 1;
+
+                    [[nodiscard]] explicit host_allocator(core::allocator& source = core::allocator::heap()) noexcept;
+
+                    host_allocator(const host_allocator&) = delete;
+                    host_allocator& operator=(const host_allocator&) = delete;
+
+                    /// @brief Callbacks to pass to Vulkan
+                    [[nodiscard]] VkAllocationCallbacks* callbacks() noexcept { return &_callbacks; }
+
+                    /// @brief Host memory the driver holds in `scope`, including internal allocations it reported
+                    [[nodiscard]] core::memory_stats stats(VkSystemAllocationScope scope) const noexcept;
+
+                private:
+                    struct scope_counters
+                    {
+                        std::atomic<usize> live_bytes { 0 };
+                        std::atomic<usize> peak_bytes { 0 };
+                        std::atomic<usize> count { 0 };
+                    };
+
+                    static VKAPI_ATTR void* VKAPI_CALL allocate_(void* user_data, size_t size, size_t alignment, VkSystemAllocationScope scope);
+                    static VKAPI_ATTR void* VKAPI_CALL reallocate_(void* user_data, void* original, size_t size, size_t alignment, VkSystemAllocationScope scope);
+                    static VKAPI_ATTR void VKAPI_CALL free_(void* user_data, void* memory);
+                    static VKAPI_ATTR void VKAPI_CALL internal_allocation_(void* user_data, size_t size, VkInternalAllocationType type, VkSystemAllocationScope scope);
+                    static VKAPI_ATTR void VKAPI_CALL internal_free_(void* user_data, size_t size, VkInternalAllocationType type, VkSystemAllocationScope scope);
+
+                    [[nodiscard]] void* allocate_memory_(usize size, usize alignment, VkSystemAllocationScope scope) noexcept;
+                    void free_memory_(void* memory) noexcept;
+
+                    void count_allocation_(VkSystemAllocationScope scope, usize size) noexcept;
+                    void count_free_(VkSystemAllocationScope scope, usize size) noexcept;
+
+                private:
+                    core::allocator& _source;
+                    VkAllocationCallbacks _callbacks {};
+                    std::array<scope_counters, scope_count> _scopes {};
+            };
+        } // vk namespace
+    } // gfx namespace
+} // blade namespace
+
+#endif // BLADE_GFX_VULKAN_HOST_ALLOCATOR_H
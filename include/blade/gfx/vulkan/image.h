@@ -0,0 +1,71 @@
+#ifndef BLADE_GFX_VULKAN_IMAGE_H
+#define BLADE_GFX_VULKAN_IMAGE_H
+
+#include "gfx/vulkan/common.h"
+#include "gfx/vulkan/device.h"
+
+#include <memory>
+#include <optional>
+#include <vulkan/vulkan_core.h>
+
+namespace blade
+{
+    namespace gfx
+    {
+        namespace vk
+        {
+            /**
+             * @brief A 2D device-local image with its own memory and a view of its color or depth aspect
+             */
+            class image
+            {
+                public:
+                    struct builder
+                    {
+                        [[nodiscard]] explicit builder(std::weak_ptr<class device> device) noexcept
+                            : info { device }
+                        {}
+
+                        std::optional<std::shared_ptr<image>> build() const noexcept;
+
+                        builder& set_format(const VkFormat format) noexcept;
+                        builder& set_extent(struct width width, struct height height) noexcept;
+                        builder& set_usage(const VkImageUsageFlags usage) noexcept;
+                        builder& set_allocation_callbacks(VkAllocationCallbacks* callbacks) noexcept;
+
+                        struct
+                        {
+                            std::weak_ptr<class device> device          {};
+                            VkFormat format                             { VK_FORMAT_R8G8B8A8_UNORM };
+                            VkExtent2D extent                           {};
+                            VkImageUsageFlags usage                     { VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT };
+                            VkAllocationCallbacks* allocation_callbacks { nullptr };
+                        } info;
+                    };
+
+                    [[nodiscard]] explicit image(std::weak_ptr<class device> device, VkAllocationCallbacks* callbacks) noexcept
+                        : _device { device }
+                        , _allocation_callbacks { callbacks }
+                    {}
+
+                    [[nodiscard]] VkImage handle() const noexcept { return _image; }
+                    [[nodiscard]] VkImageView view() const noexcept { return _view; }
+                    [[nodiscard]] VkFormat format() const noexcept { return _format; }
+                    [[nodiscard]] VkExtent2D extent() const noexcept { return _extent; }
+
+                    void destroy() noexcept;
+
+                private:
+                    std::weak_ptr<class device> _device          {};
+                    VkAllocationCallbacks* _allocation_callbacks { nullptr };
+                    VkImage _image                               { VK_NULL_HANDLE };
+                    VkImageView _view                            { VK_NULL_HANDLE };
+                    VkDeviceMemory _memory                       { VK_NULL_HANDLE };
+                    VkFormat _format                             { VK_FORMAT_UNDEFINED };
+                    VkExtent2D _extent                           {};
+            };
+        } // vk namespace
+    } // gfx namespace
+} // blade namespace
+
+#endif // BLADE_GFX_VULKAN_IMAGE_H
@@ -1,12 +1,14 @@
 #ifndef BLADE_GFX_VULKAN_PIPELINE_H
 #define BLADE_GFX_VULKAN_PIPELINE_H
 
+#include "core/containers/small_vector.h"
 #include "gfx/vulkan/common.h"
 #include "gfx/vulkan/shader.h"
 
 #include <array>
 #include <optional>
 #include <memory>
+#include <span>
 #include <vulkan/vulkan_core.h>
 
 namespace blade
@@ -15,6 +17,22 @@ namespace blade
     {
         namespace vk
         {
+            /// @brief Fixed-function values that can be set while recording when the device has extended dynamic state
+            struct dynamic_state
+            {
+                VkCullModeFlags cull_mode     { VK_CULL_MODE_NONE };
+                VkFrontFace front_face        { VK_FRONT_FACE_CLOCKWISE };
+                VkPrimitiveTopology topology  { VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST };
+                VkBool32 primitive_restart    { VK_FALSE };
+                VkBool32 depth_test           { VK_FALSE };
+                VkBool32 depth_write          { VK_FALSE };
+                VkCompareOp depth_compare     { VK_COMPARE_OP_LESS };
+                VkPolygonMode polygon_mode    { VK_POLYGON_MODE_FILL };
+                VkBool32 blend                { VK_FALSE };
+
+                bool operator==(const dynamic_state&) const noexcept = default;
+            };
+
             class pipeline
             {
                 public:
@@ -24,6 +42,20 @@ namespace blade
                         graphics
                     };
 
+                    /// @brief Parts of a graphics pipeline that `VK_EXT_graphics_pipeline_library` compiles separately
+                    enum class library_part : u32
+                    {
+                        vertex_input,
+                        pre_rasterization,
+                        fragment_shader,
+                        fragment_output,
+
+                        count
+                    };
+
+                    using libraries = std::array<std::shared_ptr<pipeline>, static_cast<u32>(library_part::count)>;
+                    using libraries_keys = std::array<u32, static_cast<u32>(library_part::count)>;
+
                     class builder
                     {
                         public:
@@ -33,13 +65,23 @@ namespace blade
 
                             std::optional<std::shared_ptr<pipeline>> build() const noexcept;
 
+                            /**
+                             * @brief Compile only one part of the graphics pipeline as a library
+                             * @note Requires a device with graphics pipeline libraries enabled
+                             */
+                            std::optional<std::shared_ptr<pipeline>> build_library(const library_part part) const noexcept;
+
                             builder& add_dynamic_state(const VkDynamicState dynamic_state) noexcept;
                             builder& set_type(const enum type type) noexcept;
                             builder& use_allocation_callbacks(VkAllocationCallbacks* callbacks) noexcept;
                             builder& use_blending(const bool enabled = true) noexcept;
+                            builder& set_color_attachment_count(const u32 count) noexcept;
                             builder& add_multisampling(const bool enabled = true) noexcept;
                             builder& add_renderpass(const VkRenderPass& renderpass) noexcept;
                             builder& add_shader(shader::type type, const VkShaderModule&) noexcept;
+
+                            /// @brief Forget the shaders and dynamic states so another program can be built
+                            builder& clear_program() noexcept;
                             builder& set_render_pass(const VkRenderPass& renderpass) noexcept;
                             builder& set_pipeline_layout(const VkPipelineLayout& layout) noexcept;
                             builder& add_viewport(const VkViewport viewport) noexcept;
@@ -73,19 +115,29 @@ namespace blade
                             builder& add_multisampler_alpha_to_one(const VkBool32) noexcept;
                             builder& set_multisampler_pnext(const void*) noexcept;
 
+                            builder& set_depth_test(const VkBool32) noexcept;
+                            builder& set_depth_write(const VkBool32) noexcept;
+                            builder& set_depth_compare_op(const VkCompareOp) noexcept;
+
+                            /// @brief Apply every value of a dynamic state as baked pipeline state
+                            builder& set_dynamic_state_values(const struct dynamic_state& state) noexcept;
+
                             // TODO: make references?
                             builder& add_pipeline_layout_descriptor_set(const VkDescriptorSetLayout) noexcept;
                             builder& add_pipeline_layout_push_constant(const VkPushConstantRange) noexcept;
+
+                            /// @brief Replace every push constant range added so far
+                            builder& set_pipeline_layout_push_constants(std::span<const VkPushConstantRange>) noexcept;
                             builder& set_pipeline_layout_pnext(const void*) noexcept;
                             builder& set_pipeline_layout_flags(const VkPipelineLayoutCreateFlags) noexcept;
                             
                             struct
                             {
                                 std::weak_ptr<const class device> device                   {};
-                                std::vector<VkViewport> viewports                          {};
-                                std::vector<VkRect2D> scissors                             {};
-                                std::vector<VkPipelineShaderStageCreateInfo> shader_stages {};
-                                std::vector<VkDynamicState> dynamic_states                 {};
+                                core::small_vector<VkViewport, 1> viewports                {};
+                                core::small_vector<VkRect2D, 1> scissors                   {};
+                                core::small_vector<VkPipelineShaderStageCreateInfo, 2> shader_stages {};
+                                core::small_vector<VkDynamicState, 12> dynamic_states      {};
                                 VkAllocationCallbacks* allocation_callbacks                { nullptr };
                                 VkExtent2D extent                                          {};
                                 VkPipelineLayout pipeline_layout                           { VK_NULL_HANDLE };
@@ -94,11 +146,11 @@ namespace blade
                                 enum type type                                             { type::graphics };
                                 VkRenderPass renderpass                                    { VK_NULL_HANDLE };
                                 
-                                std::vector<VkVertexInputBindingDescription> vertex_binding_descriptions     {};
-                                std::vector<VkVertexInputAttributeDescription> vertex_attribute_descriptions {};
+                                core::small_vector<VkVertexInputBindingDescription, 2> vertex_binding_descriptions     {};
+                                core::small_vector<VkVertexInputAttributeDescription, 8> vertex_attribute_descriptions {};
 
-                                std::vector<VkDescriptorSetLayout> descriptor_sets {};
-                                std::vector<VkPushConstantRange> push_constants    {};
+                                core::small_vector<VkDescriptorSetLayout, 4> descriptor_sets {};
+                                core::small_vector<VkPushConstantRange, 2> push_constants    {};
 
                                 VkPipelineVertexInputStateCreateInfo vertex_info           
                                 { 
@@ -148,6 +200,18 @@ namespace blade
                                     .alphaToOneEnable = VK_FALSE,
                                 };
                                 
+                                VkPipelineDepthStencilStateCreateInfo depth_stencil_info
+                                {
+                                    .sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO,
+                                    .depthTestEnable = VK_FALSE,
+                                    .depthWriteEnable = VK_FALSE,
+                                    .depthCompareOp = VK_COMPARE_OP_LESS,
+                                    .depthBoundsTestEnable = VK_FALSE,
+                                    .stencilTestEnable = VK_FALSE,
+                                    .minDepthBounds = 0.0f,
+                                    .maxDepthBounds = 1.0f,
+                                };
+
                                 VkPipelineLayoutCreateInfo pipeline_layout_info            
                                 {
                                     .sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
@@ -172,6 +236,7 @@ namespace blade
                                         | VK_COLOR_COMPONENT_B_BIT
                                         | VK_COLOR_COMPONENT_A_BIT,
                                 };
+                                u32 color_attachment_count { 1 };
                                 VkPipelineColorBlendStateCreateInfo color_blend_info       
                                 { 
                                     .sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO,
@@ -187,8 +252,21 @@ namespace blade
                 
                 // Public Methods
                 public:
+                    /**
+                     * @brief Link a full set of pipeline libraries into an executable pipeline
+                     * @param optimize Run link-time optimization. Slow, so it is meant for a background thread
+                     * @return The linked pipeline. It shares the pre-rasterization library's layout and keeps the libraries alive
+                     */
+                    static std::optional<std::shared_ptr<pipeline>> link(
+                        std::weak_ptr<const class device> device
+                        , const libraries& parts
+                        , const bool optimize
+                        , VkAllocationCallbacks* callbacks = nullptr
+                    ) noexcept;
+
                     void destroy() noexcept;
                     VkPipeline handle() const noexcept { return _pipeline; }
+                    VkPipelineLayout layout() const noexcept { return _layout; }
 
                     [[nodiscard]] explicit pipeline(std::weak_ptr<const class device> device) noexcept
                         : _device{ device }
@@ -201,6 +279,8 @@ namespace blade
                     VkPipelineLayout _layout                     { VK_NULL_HANDLE };
                     VkPipeline _pipeline                         { VK_NULL_HANDLE };
                     VkAllocationCallbacks* _allocation_callbacks { nullptr };
+                    bool _owns_layout                            { true };
+                    libraries _libraries                         {};
             };
         } // vk namespace
     } // gfx namespace
@@ -31,6 +31,12 @@ namespace blade
                     VkSurfaceCreateInfo& create_info_ref,
                     struct framebuffer_create_info::native_window_data window_data
                 );
+
+                /// @brief Whether both handles refer to the same native window
+                bool same_window(
+                    const struct framebuffer_create_info::native_window_data& lhs,
+                    const struct framebuffer_create_info::native_window_data& rhs
+                ) noexcept;
             } // platform namespace
         } // vk namespace
     } // gfx namespace
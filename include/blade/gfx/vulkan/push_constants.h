@@ -0,0 +1,109 @@
+#ifndef BLADE_GFX_VULKAN_PUSH_CONSTANTS_H
+#define BLADE_GFX_VULKAN_PUSH_CONSTANTS_H
+
+#include "gfx/vulkan/command.h"
+#include "gfx/vulkan/common.h"
+
+#include <array>
+#include <vector>
+#include <vulkan/vulkan_core.h>
+
+namespace blade
+{
+    namespace gfx
+    {
+        namespace vk
+        {
+            /**
+             * @brief CPU copy of a view's push constant block
+             *
+             * Writes are validated against the declared ranges and only the spans that were actually written are
+             * pushed when recording. Writes that do not change the stored bytes are dropped. Each queued draw
+             * captures the block as it was when the draw was queued, and draws queued without a write in between
+             * share one capture.
+             *
+             * A block may reserve bytes at offset 0 that the backend fills per draw, like bindless indices. Vulkan
+             * lets a stage appear in only one range, so declared ranges that share a stage with the reserved bytes
+             * are widened down to offset 0 in the pipeline layout.
+             */
+            class push_constant_block
+            {
+                public:
+                    /// @brief Largest push constant block any device reports. The spec guarantees at least 128 bytes
+                    static constexpr u32 max_size = 256;
+
+                    /// @brief Capture offset of draws queued while no range is declared
+                    static constexpr u32 no_capture = ~0u;
+
+                    /**
+                     * @brief Reserve `range.size` bytes at offset 0 for the backend, read by `range.stageFlags`
+                     * @return `false` if ranges were declared already or the size is invalid
+                     */
+                    bool reserve(const VkPushConstantRange range, const u32 limit) noexcept;
+
+                    /**
+                     * @brief Declare a range the pipeline layout will contain
+                     * @param limit The device `maxPushConstantsSize`
+                     * @return `true` if the range is valid and clear of the reserved bytes. `false` otherwise
+                     */
+                    bool declare(const VkPushConstantRange range, const u32 limit) noexcept;
+
+                    /**
+                     * @brief Copy data into the block
+                     * @return `true` if the write fits the declared ranges. `false` otherwise
+                     */
+                    bool write(const void* data, u32 size, u32 offset) noexcept;
+
+                    /**
+                     * @brief Copy the block into a frame's captures for the next queued draw
+                     * @return Offset of the copy in `captures`. The previous offset if nothing was written since
+                     */
+                    u32 capture(std::vector<u8>& captures) noexcept;
+
+                    /// @brief Copy the block into `captures` even if it is unchanged since the last capture
+                    u32 snapshot(std::vector<u8>& captures) const noexcept;
+
+                    /// @brief Forget the last capture once the captures it went into are handed off for recording
+                    void restart_captures() noexcept { _captured = no_capture; }
+
+                    /// @brief Push every written span of a captured copy into the renderpass
+                    void record(const command_buffer::recording::record_renderpass& pass, VkPipelineLayout layout, const u8* captured) const noexcept;
+
+                    /// @brief Push `reserved_size()` bytes into the reserved block
+                    void record_reserved(const command_buffer::recording::record_renderpass& pass, VkPipelineLayout layout, const void* data) const noexcept;
+
+                    [[nodiscard]] u32 reserved_size() const noexcept { return _reserved.size; }
+
+                    /// @brief The ranges the pipeline layout is created with
+                    [[nodiscard]] const std::vector<VkPushConstantRange>& ranges() const noexcept { return _layout_ranges; }
+
+                private:
+                    /// @brief A run of written bytes and the stages that must be named when pushing it
+                    struct span
+                    {
+                        VkShaderStageFlags stages { 0 };
+                        u32 begin                 { 0 };
+                        u32 end                   { 0 };
+                    };
+
+                    bool check_size_(const VkPushConstantRange range, const u32 limit) const noexcept;
+                    void mark_written_(VkShaderStageFlags stages, u32 begin, u32 end) noexcept;
+                    void update_layout_ranges_() noexcept;
+
+                private:
+                    /// @brief Ranges as declared, without the reserved bytes
+                    std::vector<VkPushConstantRange> _ranges {};
+                    std::vector<VkPushConstantRange> _layout_ranges {};
+                    VkPushConstantRange _reserved            {};
+                    std::vector<span> _written               {};
+                    std::array<u8, max_size> _data           {};
+
+                    /// @brief End of the highest declared range, the bytes each capture copies
+                    u32 _size                                { 0 };
+                    u32 _captured                            { no_capture };
+            };
+        } // vk namespace
+    } // gfx namespace
+} // blade namespace
+
+#endif // BLADE_GFX_VULKAN_PUSH_CONSTANTS_H
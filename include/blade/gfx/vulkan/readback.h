@@ -0,0 +1,94 @@
+#ifndef BLADE_GFX_VULKAN_READBACK_H
+#define BLADE_GFX_VULKAN_READBACK_H
+
+#include "gfx/view.h"
+#include "gfx/vulkan/buffer.h"
+#include "gfx/vulkan/command.h"
+#include "gfx/vulkan/common.h"
+#include "gfx/vulkan/device.h"
+
+#include <memory>
+#include <span>
+#include <vector>
+#include <vulkan/vulkan_core.h>
+
+namespace blade
+{
+    namespace gfx
+    {
+        namespace vk
+        {
+            /**
+             * @brief Ring of persistently mapped staging buffers that color targets are copied into
+             *
+             * A request takes a free slot, is recorded after the frame's renderpass, and is stamped with the
+             * serial of the submission that carries it. Once that serial completes the callback reads the
+             * mapped pixels in place and the slot is reused. Buffers are only reallocated when a request
+             * needs more bytes than the slot holds, so steady capture at a fixed size allocates nothing.
+             */
+            class readback_ring
+            {
+                public:
+                    /// @brief Slots created up front. Enough to cover the frames the GPU may be behind
+                    static constexpr u32 initial_slots = 3;
+
+                    /// @brief Slots the ring may grow to before new requests are refused
+                    static constexpr u32 max_slots = 8;
+
+                    [[nodiscard]] explicit readback_ring(std::weak_ptr<class device> device) noexcept
+                        : _device { device }
+                    {}
+
+                    void set_allocation_callbacks(VkAllocationCallbacks* callbacks) noexcept { _allocation_callbacks = callbacks; }
+
+                    /**
+                     * @brief Reserve a slot for the next recorded frame
+                     * @return `false` if every slot is still waiting on the GPU or the staging buffer could not be created
+                     */
+                    bool request(u32 target, VkExtent2D extent, texture_format format, readback_callback callback) noexcept;
+
+                    /// @brief Whether any request is waiting to be recorded
+                    [[nodiscard]] bool has_queued() const noexcept;
+
+                    /// @brief Copy every queued request's target. The images must be in `layout`
+                    void record(const command_buffer::recording::record_transfer& transfer, std::span<const VkImage> targets, VkImageLayout layout) const noexcept;
+
+                    /// @brief Stamp the recorded requests with the serial of the submission carrying them
+                    void submit(u64 serial) noexcept;
+
+                    /// @brief Run the callbacks of every request whose submission has completed
+                    void resolve(u64 completed_serial) noexcept;
+
+                    /// @brief Drop requests that were never submitted. Their callbacks see no pixels
+                    void cancel_queued() noexcept;
+
+                    void destroy() noexcept;
+
+                    [[nodiscard]] static u32 bytes_per_pixel(texture_format format) noexcept;
+
+                private:
+                    struct slot
+                    {
+                        std::shared_ptr<class buffer> staging { nullptr };
+                        const void* mapped                    { nullptr };
+                        u64 serial                            { 0 };
+                        bool in_use                           { false };
+                        u32 target                            { 0 };
+                        VkExtent2D extent                     {};
+                        texture_format format                 { texture_format::rgba8 };
+                        readback_callback callback            {};
+                    };
+
+                    bool reserve_(slot& slot, u32 size) noexcept;
+                    void release_(slot& slot) noexcept;
+
+                private:
+                    std::weak_ptr<class device> _device          {};
+                    VkAllocationCallbacks* _allocation_callbacks { nullptr };
+                    std::vector<slot> _slots                     {};
+            };
+        } // vk namespace
+    } // gfx namespace
+} // blade namespace
+
+#endif // BLADE_GFX_VULKAN_READBACK_H
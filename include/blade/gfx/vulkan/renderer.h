@@ -1,16 +1,23 @@
 #include "core/core.h"
+#include "core/containers/mpsc_queue.h"
+#include "core/containers/slot_map.h"
 #include "core/memory.h"
 #include "gfx/handle.h"
 #include "gfx/renderer.h"
 #include "gfx/vertex.h"
 #include "gfx/view.h"
 #include "gfx/program.h"
+#include "gfx/vulkan/bindless.h"
 #include "gfx/vulkan/buffer.h"
 #include "gfx/vulkan/command.h"
+#include "gfx/vulkan/deletion_queue.h"
+#include "gfx/vulkan/host_allocator.h"
 #include "gfx/vulkan/view.h"
 #include "gfx/vulkan/renderpass.h"
+#include "gfx/vulkan/submit_batch.h"
 #include "gfx/vulkan/types.h"
-#include <unordered_map>
+#include <functional>
+#include <vector>
 #include <vulkan/vulkan_core.h>
 
 #ifndef BLADE_GFX_VULKAN_VULKAN_H
@@ -33,39 +40,102 @@ namespace blade
                     void submit() noexcept override;
                     void frame() noexcept override;
                     void set_viewport(const framebuffer_handle framebuffer, f32 x, f32 y, struct width width, struct height height) noexcept override;
-                    void attach_vertex_buffer(const buffer_handle) noexcept override;
-                    void set_vertex_buffer(const buffer_handle handle) noexcept override;
-                    void set_index_buffer(const buffer_handle handle) noexcept override;
+                    void set_render_state(const framebuffer_handle framebuffer, const render_state& state) noexcept override;
+                    void attach_vertex_buffer(const framebuffer_handle framebuffer, const buffer_handle handle) noexcept override;
+                    void set_vertex_buffer(const framebuffer_handle framebuffer, const buffer_handle handle) noexcept override;
+                    void set_index_buffer(const framebuffer_handle framebuffer, const buffer_handle handle) noexcept override;
+                    u32 get_bindless_index(const buffer_handle handle) noexcept override;
+                    bool declare_push_constants(const framebuffer_handle framebuffer, const push_constant_range range) noexcept override;
+                    void set_push_constants(const framebuffer_handle framebuffer, const void* data, u32 size, u32 offset) noexcept override;
+                    bool read_framebuffer(const framebuffer_handle framebuffer, u32 target, readback_callback callback) noexcept override;
+                    void set_frame_pacing(const framebuffer_handle framebuffer, const frame_pacing& pacing) noexcept override;
+                    void draw(const framebuffer_handle framebuffer, const draw_call& call) noexcept override;
 
                     framebuffer_handle create_framebuffer(framebuffer_create_info) noexcept override;
-                    shader_handle create_shader(const std::vector<u8>&) noexcept override;
+                    shader_handle create_shader(const core::memory* code) noexcept override;
                     program_handle create_view_program(const framebuffer_handle, const shader_handle, const shader_handle) noexcept override;
                     buffer_handle create_vertex_buffer(const core::memory* memory, const vertex_layout& layout) noexcept override;
                     buffer_handle create_index_buffer(const core::memory* memory) noexcept override;
 
+                    void destroy_shader(const shader_handle handle) noexcept override;
+                    void destroy_view_program(const program_handle handle) noexcept override;
+                    void destroy_buffer(const buffer_handle handle) noexcept override;
+
                 private:
+                    /// @brief A vertex or index buffer and where shaders find it
+                    struct buffer_resource
+                    {
+                        enum class usage : u8
+                        {
+                            vertex,
+                            index
+                        };
+
+                        std::shared_ptr<class buffer> buffer            { nullptr };
+                        enum usage usage                                { usage::vertex };
+                        u32 bindless_index                              { BLADE_INVALID_BINDLESS_INDEX };
+                    };
+
+                    /// @brief A program and the framebuffer whose pipelines were built from it
+                    struct program_resource
+                    {
+                        struct program program                          {};
+                        framebuffer_handle framebuffer                  {};
+                    };
+
                     /// @brief Append platform-specific vulkan extensions to the list
                     std::vector<const char*> get_platform_extensions() const noexcept;
 
                     /// @brief Get the validation layer names
                     std::optional<std::vector<const char*>> get_debug_validation_layers() const noexcept;
 
+                    /// @brief Give a buffer a slot in the bindless storage buffer array if bindless is enabled
+                    void register_bindless_buffer_(const core::slot_id slot, buffer_resource& resource) noexcept;
+
+                    /// @brief Translate frontend pacing settings for a view
+                    void set_view_pacing_(class view& view, const frame_pacing& pacing) const noexcept;
+
+                    /// @brief Queue the part of a creation that touches queues or resource maps for the frame thread
+                    void defer_creation_(std::function<void()> creation) noexcept;
+
+                    /// @brief Run creations queued by any thread so far. Frame thread only
+                    void apply_pending_creations_() noexcept;
+
                 private:
+                    /// @brief Driver host memory. Declared first so it outlives every Vulkan object below
+                    host_allocator _host_allocator                             {};
+
                     bool _is_initialized                                       { false };
                     std::shared_ptr<instance> _instance                        { nullptr };
                     std::shared_ptr<class device> _device                      { nullptr };
                     // std::shared_ptr<class command_pool> _command_pool          { nullptr };
-                    VkAllocationCallbacks* allocation_callbacks                { nullptr };
-                    std::unordered_map<framebuffer_handle, view> _views        {};
-                    std::unordered_map<shader_handle, shader> _shaders         {};
-                    std::unordered_map<program_handle, program> _programs      {};
+
+                    /// @brief Frontend handles are slot ids. Slots are reserved on the creating thread and filled on the frame thread
+                    core::slot_map<view> _views                                {};
+                    core::slot_map<shader> _shaders                            {};
+                    core::slot_map<program_resource> _programs                 {};
+                    core::slot_map<buffer_resource> _buffers                   {};
 
                     std::shared_ptr<command_handler> _transfer_cmd_handler              { nullptr };
-                    u16 _buffer_handle_index { 0 };
+                    std::unique_ptr<submit_batch> _submit_batch                         { nullptr };
+
+                    /// @brief Creation queued by `defer_creation_`
+                    struct pending_creation : core::mpsc_node
+                    {
+                        std::function<void()> create {};
+                    };
+
+                    core::mpsc_queue<pending_creation> _pending_creations               {};
 
-                    std::unordered_map<buffer_handle, std::shared_ptr<buffer>> _vertex_input_infos  {};
-                    std::unordered_map<buffer_handle, std::shared_ptr<buffer>> _index_input_infos   {};
                     u32 _num_bindings { 0 };
+
+                    std::shared_ptr<bindless_set> _bindless                             { nullptr };
+
+                    /// @brief Destroyed resources waiting for the last batch that may use them
+                    deletion_queue _deletion_queue                                      {};
+
+                    /// @brief Pacing new framebuffers start with
+                    frame_pacing _default_pacing                                        {};
             };
         } // vk namespace
     } // gfx namespace
@@ -6,8 +6,9 @@
 #include "gfx/vulkan/device.h"
 #include "resources/resources.h"
 
-#include <vector>
 #include <memory>
+#include <span>
+#include <vector>
 #include <vulkan/vulkan_core.h>
 
 namespace blade
@@ -35,13 +36,14 @@ namespace blade
                         std::optional<shader> build() const noexcept;
 
                         builder& use_allocation_callbacks(VkAllocationCallbacks* callbacks) noexcept;
-                        builder& set_code(const std::vector<u8>& code) noexcept;
+                        /// @brief Borrow SPIR-V bytes, which must stay alive until `build` returns
+                        builder& set_code(std::span<const u8> code) noexcept;
 
                         struct
                         {
                             const class device& device;
                             VkAllocationCallbacks* callbacks { nullptr };
-                            std::vector<u8> code;
+                            std::span<const u8> code {};
                         } info;
                     };
 
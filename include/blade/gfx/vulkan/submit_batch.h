@@ -0,0 +1,92 @@
+#ifndef BLADE_GFX_VULKAN_SUBMIT_BATCH_H
+#define BLADE_GFX_VULKAN_SUBMIT_BATCH_H
+
+#include "gfx/vulkan/common.h"
+#include "gfx/vulkan/device.h"
+
+#include <memory>
+#include <optional>
+#include <vector>
+#include <vulkan/vulkan_core.h>
+
+namespace blade
+{
+    namespace gfx
+    {
+        namespace vk
+        {
+            /**
+             * @brief Collects the command buffers of several views and hands them to the queue in one `vkQueueSubmit`
+             *
+             * Every buffer in a batch shares one fence, and fences are recycled as soon as they have signaled. Work
+             * is therefore tracked by the serial each batch is stamped with rather than by its fence.
+             */
+            class submit_batch
+            {
+                public:
+                    /// @brief One command buffer and the semaphores its submission waits on and signals
+                    struct entry
+                    {
+                        VkCommandBuffer command_buffer { VK_NULL_HANDLE };
+                        VkSemaphore wait_semaphore     { VK_NULL_HANDLE };
+                        VkSemaphore signal_semaphore   { VK_NULL_HANDLE };
+                        VkPipelineStageFlags wait_stage { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
+                    };
+
+                    [[nodiscard]] explicit submit_batch(std::weak_ptr<class device> device) noexcept
+                        : _device { device }
+                    {}
+
+                    void set_allocation_callbacks(VkAllocationCallbacks* callbacks) noexcept { _allocation_callbacks = callbacks; }
+
+                    void add(const entry& entry) noexcept { _entries.push_back(entry); }
+
+                    [[nodiscard]] bool is_empty() const noexcept { return _entries.empty(); }
+
+                    /**
+                     * @brief Submit every added entry and clear the batch
+                     * @return The fence signaled when the whole batch has finished. `std::nullopt` if submission failed
+                     */
+                    std::optional<VkFence> submit(VkQueue queue) noexcept;
+
+                    /// @brief Serial of the last successful submission. Batches are numbered from 1
+                    [[nodiscard]] u64 submitted_serial() const noexcept { return _submitted_serial; }
+
+                    /// @brief Serial of the newest batch the GPU has finished. Polls the fences still in flight
+                    [[nodiscard]] u64 completed_serial() noexcept;
+
+                    /**
+                     * @brief Block until the batch stamped with `serial` has finished on the GPU
+                     * @return `false` if the timeout (in nanoseconds) expired first
+                     */
+                    bool wait_for_serial(u64 serial, u64 timeout) noexcept;
+
+                    /// @brief Destroy the fences. The device must be idle
+                    void destroy() noexcept;
+
+                private:
+                    std::optional<VkFence> acquire_fence_() noexcept;
+
+                    /// @brief Move signaled fences to the free list and advance the completed serial
+                    void poll_() noexcept;
+
+                    struct in_flight
+                    {
+                        VkFence fence { VK_NULL_HANDLE };
+                        u64 serial    { 0 };
+                    };
+
+                private:
+                    std::weak_ptr<class device> _device          {};
+                    VkAllocationCallbacks* _allocation_callbacks { nullptr };
+                    std::vector<entry> _entries                  {};
+                    std::vector<in_flight> _in_flight_fences     {};
+                    std::vector<VkFence> _free_fences            {};
+                    u64 _submitted_serial                        { 0 };
+                    u64 _completed_serial                        { 0 };
+            };
+        } // vk namespace
+    } // gfx namespace
+} // blade namespace
+
+#endif // BLADE_GFX_VULKAN_SUBMIT_BATCH_H
@@ -65,10 +65,16 @@ namespace blade
                             builder& prefer_format(VkFormat format) noexcept;
                             builder& request_min_image_count(u32 count) noexcept;
                             builder& require_image_usage(VkImageUsageFlagBits usage) noexcept;
+
+                            /// @brief Add image usage flags only if the surface supports them
+                            builder& request_image_usage(VkImageUsageFlags usage) noexcept;
                             builder& set_composite_alpha(VkCompositeAlphaFlagBitsKHR alpha) noexcept;
                             builder& set_clipped(VkBool32 clipped) noexcept;
                             builder& set_allocation_callbacks(VkAllocationCallbacks* callbacks) noexcept;
 
+                            /// @brief Swapchain being replaced. It is retired once the new one is created
+                            builder& set_old_swapchain(VkSwapchainKHR old_swapchain) noexcept;
+
                             struct
                             {
                                 std::weak_ptr<class device> device;
@@ -79,6 +85,7 @@ namespace blade
                                 VkFormat preferred_format { VK_FORMAT_R8G8B8A8_UNORM };
                                 u32 min_image_count { 0 };
                                 VkImageUsageFlags image_usage { };
+                                VkImageUsageFlags requested_image_usage { };
                                 VkCompositeAlphaFlagBitsKHR composite_alpha { VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR };
                                 VkBool32 clipped { VK_TRUE };
                                 VkSwapchainKHR old_swapchain { VK_NULL_HANDLE };
@@ -113,8 +120,23 @@ namespace blade
                     const std::vector<VkImageView>& get_image_views() const noexcept { return _image_views; }
                     const VkImageView* get_image_views_raw() const noexcept { return _image_views.data(); }
                     VkFormat get_format() const noexcept { return _format; }
+                    VkImage get_image(usize index) const noexcept { return _images[index]; }
+                    VkImageUsageFlags get_usage() const noexcept { return _usage; }
                     
-                    [[nodiscard]] std::optional<u32> get_image_index(VkSemaphore semaphore, VkFence fence = VK_NULL_HANDLE) const noexcept;
+                    /// @brief Image handed out by the presentation engine
+                    struct acquired_image
+                    {
+                        u32 index { 0 };
+
+                        /// @brief The image can still be presented, but the swapchain should be recreated soon
+                        bool suboptimal { false };
+                    };
+
+                    /**
+                     * @brief Acquire the next image to render into
+                     * @return `std::nullopt` if the swapchain is out of date or acquiring failed. The semaphore is not signaled then
+                     */
+                    [[nodiscard]] std::optional<acquired_image> acquire_image(VkSemaphore semaphore, VkFence fence = VK_NULL_HANDLE) const noexcept;
 
                 private:
                     std::weak_ptr<const class device> _device {};
@@ -123,6 +145,7 @@ namespace blade
                     VkAllocationCallbacks* _allocation_callbacks { nullptr };
                     VkSwapchainKHR _swapchain { VK_NULL_HANDLE };
                     VkFormat _format {};
+                    VkImageUsageFlags _usage {};
                     VkExtent2D _extent {};
 
                 private:
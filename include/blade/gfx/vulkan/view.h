@@ -1,19 +1,32 @@
 #ifndef BLADE_GFX_VULKAN_VIEW_H
 #define BLADE_GFX_VULKAN_VIEW_H
 
+#include "core/containers/flat_hash_map.h"
+#include "core/event.h"
+#include "core/frame_arena.h"
 #include "gfx/program.h"
 #include "gfx/view.h"
+#include "gfx/vulkan/bindless.h"
 #include "gfx/vulkan/buffer.h"
 #include "gfx/vulkan/command_handler.h"
 #include "gfx/vulkan/common.h"
 #include "gfx/vulkan/device.h"
+#include "gfx/vulkan/frame_pacer.h"
+#include "gfx/vulkan/image.h"
 #include "gfx/vulkan/renderpass.h"
 #include "gfx/vulkan/swapchain.h"
 #include "gfx/vulkan/instance.h"
 #include "gfx/vulkan/pipeline.h"
+#include "gfx/vulkan/push_constants.h"
+#include "gfx/vulkan/readback.h"
 #include "gfx/vulkan/command.h"
 
+#include <array>
+#include <atomic>
+#include <future>
 #include <memory>
+#include <span>
+#include <vector>
 
 namespace blade
 {
@@ -25,23 +38,84 @@ namespace blade
             {
                 public:
                     // TODO: use command submission from each view
-                    view(std::weak_ptr<class device> device, std::shared_ptr<class surface> surface) noexcept;
+                    view(std::weak_ptr<class device> device, std::shared_ptr<class surface> surface, VkAllocationCallbacks* callbacks = nullptr) noexcept;
 
                     void destroy() noexcept;
                     bool create_framebuffers() noexcept;
 
                     void set_viewport(f32 x, f32 y, struct width width, struct height height) noexcept;
                    
-                    void record_commands(class command_buffer& command_buffer) const noexcept;
+                    /// @brief A draw and the state captured for it when it was queued
+                    struct queued_draw
+                    {
+                        draw_call call {};
 
-                    void frame() noexcept;
+                        /// @brief Offset of its push constants in the frame's captures. `push_constant_block::no_capture` if none are declared
+                        u32 push_constants { push_constant_block::no_capture };
+
+                        /// @brief Index of its render state in the frame's draw states
+                        u32 state          { 0 };
+                    };
+
+                    /**
+                     * @brief Record the frame's renderpass and readback copies
+                     * @note Draw lists of at least two `min_draws_per_chunk` chunks are recorded into secondary buffers on worker threads
+                     */
+                    void record_commands(class command_buffer& command_buffer, std::span<const queued_draw> draws) noexcept;
+
+                    /// @brief Queue a draw for the next recorded frame with the push constants and render state set so far
+                    void draw(const draw_call& call) noexcept;
+
+                    /// @brief Fewest draws worth handing to another recording thread
+                    static constexpr u32 min_draws_per_chunk = 1024;
+
+                    /// @brief Most threads one view records with
+                    static constexpr u32 max_recording_threads = 8;
+
+                    /// @brief Command buffer a view recorded for the frame and the semaphores its submission uses
+                    struct recorded_frame
+                    {
+                        VkCommandBuffer command_buffer { VK_NULL_HANDLE };
+
+                        /// @brief Signaled by image acquisition. `VK_NULL_HANDLE` for offscreen views
+                        VkSemaphore wait_semaphore     { VK_NULL_HANDLE };
+
+                        /// @brief Waited on by present. `VK_NULL_HANDLE` for offscreen views
+                        VkSemaphore signal_semaphore   { VK_NULL_HANDLE };
+                    };
+
+                    /**
+                     * @brief Handle resizes, pace, acquire an image and record the frame's commands
+                     * @note Only touches this view, so views can record on separate threads
+                     * @return `std::nullopt` if the view skips the frame
+                     */
+                    std::optional<recorded_frame> record_frame() noexcept;
+
+                    /// @brief Track the recorded frame after it went out in `batch`, then present it. `nullptr` if the batch failed
+                    void submitted(const recorded_frame& frame, class submit_batch* batch) noexcept;
+
+                    /// @brief Run the callbacks of finished readbacks on the calling thread
+                    void resolve_readbacks() noexcept;
 
                     VkExtent2D get_extent() const noexcept;
 
-                    static std::optional<view> create(std::weak_ptr<class instance> instance, std::weak_ptr<class device> device, const framebuffer_create_info info) noexcept;
+                    /// @param callbacks Used for every Vulkan object the view creates
+                    static std::optional<view> create(std::weak_ptr<class instance> instance, std::weak_ptr<class device> device, const framebuffer_create_info info, VkAllocationCallbacks* callbacks = nullptr) noexcept;
 
                     bool create_program(const struct program& program, const shader& vertex, const shader& fragment) noexcept;
 
+                    /**
+                     * @brief Drop the program and every pipeline built from it
+                     * @return The pipelines, which the last submitted frame may still use. Waits for links still compiling against them
+                     */
+                    std::vector<std::shared_ptr<class pipeline>> release_program() noexcept;
+
+                    /// @brief Wait for background links and destroy their results, so no thread still uses the view's pipeline libraries
+                    void finish_pipeline_links() noexcept;
+
+                    /// @brief Stop drawing with the buffer if it is bound as the vertex or index buffer
+                    void release_buffer(const class buffer& buffer) noexcept;
+
                     std::weak_ptr<class pipeline> get_graphics_pipeline() const noexcept { return graphics_pipeline; }
 
                     void attach_vertex_buffer(std::weak_ptr<buffer> buffer) noexcept;
@@ -49,24 +123,151 @@ namespace blade
                     void set_vertex_buffer(std::weak_ptr<buffer> buffer) noexcept;
                     void set_index_buffer(std::shared_ptr<buffer> buffer) noexcept;
 
+                    /// @brief Build pipelines against the bindless set layout and bind it when recording
+                    void use_bindless(std::weak_ptr<bindless_set> set) noexcept;
+
+                    /**
+                     * @brief Add a push constant range to the pipeline layout
+                     * @return `false` if the range is invalid or the pipeline was already built
+                     */
+                    bool declare_push_constants(const VkPushConstantRange range) noexcept;
+
+                    /// @brief Capture push constant data for the next recorded draws
+                    void set_push_constants(const void* data, u32 size, u32 offset) noexcept;
+
+                    /**
+                     * @brief Set the fixed-function state for the next recorded draws
+                     * @note Only the states the device cannot set dynamically select a different pipeline
+                     */
+                    void set_render_state(const struct dynamic_state& state) noexcept;
+
+                    /**
+                     * @brief Copy a color target into the readback ring after the next frame
+                     * @return `false` if the target cannot be copied or every staging buffer is still in flight
+                     */
+                    bool read_framebuffer(u32 target, readback_callback callback) noexcept;
+
+                    /**
+                     * @brief Choose how frames are presented and when the CPU may start the next one
+                     * @param image_count Minimum swapchain images. `0` lets the present mode decide
+                     * @param max_frame_rate Frame rate cap. `0` disables the limiter
+                     * @param low_latency Delay frame starts from measured completion times instead of queueing ahead
+                     * @note A new present mode or image count rebuilds the swapchain on the next frame
+                     */
+                    void set_frame_pacing(present_mode mode, u32 image_count, f32 max_frame_rate, bool low_latency) noexcept;
 
                 private:
                     bool recreate_swapchain_(struct width width, struct height height) noexcept;
-                    bool create_swapchain_(struct width width, struct height height) noexcept;
+                    bool create_swapchain_(struct width width, struct height height, VkSwapchainKHR old_swapchain = VK_NULL_HANDLE) noexcept;
                     bool create_renderpass_() noexcept;
+                    bool create_offscreen_targets_(struct width width, struct height height) noexcept;
+                    bool recreate_offscreen_targets_(struct width width, struct height height) noexcept;
+                    void destroy_offscreen_targets_() noexcept;
+                    VkFormat find_depth_format_() const noexcept;
+                    bool create_depth_target_() noexcept;
+                    void retire_depth_target_() noexcept;
+                    void release_retired_targets_(const u64 completed_serial) noexcept;
+                    void subscribe_to_resize_(const struct framebuffer_create_info::native_window_data window) noexcept;
+                    std::optional<texture_format> readback_format_() const noexcept;
+                    u32 color_attachment_count_() const noexcept;
                     void destroy_framebuffers_() noexcept;
                     VkFormat get_format_() const noexcept;
+                    pipeline::libraries_keys pipeline_part_keys_(const struct dynamic_state& state) const noexcept;
+                    u32 pipeline_key_(const struct dynamic_state& state) const noexcept;
+                    std::shared_ptr<class pipeline> find_or_build_pipeline_() noexcept;
+                    std::shared_ptr<class pipeline> link_pipeline_(const u32 key) noexcept;
+                    void update_pipeline_links_() noexcept;
+                    void pace_frame_() noexcept;
+                    void present_(const recorded_frame& frame) noexcept;
+                    bool release_image_(const recorded_frame& frame) const noexcept;
+                    void record_draws_(const command_buffer::recording::record_renderpass& pass, std::span<const queued_draw> draws, VkRect2D render_area) const noexcept;
+                    core::frame_vector<VkCommandBuffer> record_draw_chunks_(std::span<const queued_draw> draws, u32 chunk_count, VkFramebuffer framebuffer, VkRect2D render_area) noexcept;
+
+                    /// @brief Optimized link running in the background that replaces a fast-linked pipeline
+                    struct pending_link
+                    {
+                        u32 key { 0 };
+                        std::future<std::optional<std::shared_ptr<class pipeline>>> result {};
+                    };
+
+                    /**
+                     * @brief Latest window size reported through resize events
+                     *
+                     * The event handler only overwrites the size, so a burst of events during a drag collapses into
+                     * one rebuild at the final size on the next frame. Shared so the handler can outlive a moved view.
+                     */
+                    struct resize_request
+                    {
+                        std::optional<struct framebuffer_create_info::native_window_data> window { std::nullopt };
+                        std::atomic<u32> width     { 0 };
+                        std::atomic<u32> height    { 0 };
+                        std::atomic<bool> pending  { false };
+                    };
+
+                    /// @brief Render targets replaced by a resize, kept alive until the frames that used them have finished
+                    struct retired_target
+                    {
+                        u64 serial { 0 };
+                        std::unique_ptr<class swapchain> swapchain { nullptr };
+                        std::vector<std::shared_ptr<class image>> images {};
+                        std::vector<VkFramebuffer> framebuffers {};
+                    };
+
+                    /// @brief A submitted frame the pacer can wait on
+                    struct paced_frame
+                    {
+                        /// @brief Present id the frame was tagged with. `0` if it was not presented with one
+                        u64 present_id { 0 };
+                        u64 serial     { 0 };
+                    };
+
+                    /// @brief Render state some queued draws use. The pipeline is looked up by key when recording
+                    struct draw_state
+                    {
+                        struct dynamic_state state {};
+                        u32 pipeline_key           { 0 };
+                    };
+
+                    /// @brief Pipeline kept alive until the command buffers that may use it have finished
+                    struct retired_pipeline
+                    {
+                        u64 serial { 0 };
+                        std::shared_ptr<class pipeline> pipeline { nullptr };
+                    };
                    
                 private:
                     std::weak_ptr<class device> device                        {};
                     command_handler cmd_handler;
+                    thread_command_pools secondary_pools;
                     // std::shared_ptr<class command_pool> command_pool          {};
                     std::shared_ptr<struct surface> surface                   { nullptr };
                     std::optional<std::unique_ptr<class swapchain>> swapchain { std::nullopt };
                     std::vector<VkFramebuffer> framebuffers                   {};
+                    std::vector<std::shared_ptr<class image>> offscreen_targets {};
+                    std::vector<retired_target> retired_targets               {};
+                    u32 offscreen_target_count                                { 1 };
+                    texture_format offscreen_format                           { texture_format::rgba8 };
+                    VkFormat depth_format                                     { VK_FORMAT_UNDEFINED };
+                    std::shared_ptr<class image> depth_target                 { nullptr };
+                    readback_ring readbacks;
+                    std::shared_ptr<resize_request> resize_requests           { std::make_shared<resize_request>() };
+                    events::subscription resize_subscription                  {};
+                    bool swapchain_out_of_date                                { false };
+                    present_mode preferred_present_mode                       { present_mode::FIFO };
+                    u32 min_image_count                                       { 0 };
+                    frame_pacer pacer                                         {};
+                    u64 present_id                                            { 0 };
+                    u64 first_present_id                                      { 1 };
+                    paced_frame previous_frame                                {};
+                    paced_frame last_frame                                    {};
                     VkAllocationCallbacks* allocation_callbacks               { nullptr };
                     std::unique_ptr<class pipeline::builder> pipeline_builder { nullptr };
                     std::shared_ptr<class pipeline> graphics_pipeline         { nullptr };
+                    core::flat_hash_map<u32, std::shared_ptr<class pipeline>> pipelines {};
+                    std::array<core::flat_hash_map<u32, std::shared_ptr<class pipeline>>, static_cast<u32>(pipeline::library_part::count)> pipeline_libraries {};
+                    std::vector<pending_link> pending_links                   {};
+                    std::vector<retired_pipeline> retired_pipelines           {};
+                    struct dynamic_state render_state                         {};
                     std::shared_ptr<class renderpass> renderpass              { nullptr };
                     struct program program                                    {};
                     VkViewport viewport                                       {};
@@ -76,6 +277,18 @@ namespace blade
                     u32 current_image_index                                   { 0 };
                     std::weak_ptr<class buffer> buffer                 {};
                     std::shared_ptr<class buffer> index_buffer                { nullptr };
+                    std::weak_ptr<bindless_set> bindless                      {};
+                    push_constant_block push_constants                        {};
+                    std::vector<queued_draw> draws                            {};
+                    /// @brief Draws of the frame being recorded. Swapped with `draws` so both keep their capacity
+                    std::vector<queued_draw> recording_draws                  {};
+                    /// @brief Push constants captured by the queued draws, swapped along with them
+                    std::vector<u8> push_captures                             {};
+                    std::vector<u8> recording_push_captures                   {};
+                    /// @brief Render states of the queued draws, one per change, swapped along with them
+                    std::vector<draw_state> draw_states                       {};
+                    std::vector<draw_state> recording_draw_states             {};
+                    bool render_state_captured                                { false };
 
                     u32 cached_width  { 0 };
                     u32 cached_height { 0 };
@@ -91,12 +91,16 @@ namespace blade
         /// @param height Height after resize
         void _handle_resize(struct width width, struct height height);
 
+        /// @brief Post one resize event with the latest size if any arrived since the last pump
+        void _post_resize();
+
         i32 _id{INVALID_WINDOW_ID};
         u32 _width{0};
         u32 _height{0};
         std::string _title{""};
         bool _is_initialized{false};
         bool _should_close{true};
+        bool _resize_pending{false};
 
 #if defined(BLADE_PLATFORM_WINDOWS)
         HWND _hwnd;
@@ -0,0 +1,282 @@
+// Stress tests for the lock-free containers. Built with ThreadSanitizer, so a missing fence shows up as a
+// reported race even on hardware whose memory model would hide it.
+
+#include "core/containers/mpsc_queue.h"
+#include "core/containers/ring_buffer.h"
+#include "core/types.h"
+
+#include <array>
+#include <atomic>
+#include <cstdio>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace blade;
+
+namespace
+{
+    constexpr u32 producer_count = 4;
+    constexpr u32 consumer_count = 4;
+    constexpr u64 items_per_producer = 20'000;
+    constexpr usize batch_size = 16;
+
+    u32 failures = 0;
+
+    void check(bool condition, const char* what) noexcept
+    {
+        if (!condition)
+        {
+            std::fprintf(stderr, "FAILED: %s\n", what);
+            failures++;
+        }
+    }
+
+    /// @brief Items carry their producer in the high half and their sequence number in the low half
+    [[nodiscard]] u64 encode(u32 producer, u64 sequence) noexcept { return (static_cast<u64>(producer) << 32) | sequence; }
+    [[nodiscard]] u32 producer_of(u64 item) noexcept { return static_cast<u32>(item >> 32); }
+    [[nodiscard]] u64 sequence_of(u64 item) noexcept { return item & 0xffffffffu; }
+
+    void spsc_ring_keeps_order() noexcept
+    {
+        constexpr u64 count = 200'000;
+        core::spsc_ring<u64> ring(256);
+
+        // Single pushes and batches alternate on both sides so the cached indices go stale in every way
+        std::thread producer([&ring]() {
+            u64 next = 0;
+            std::array<u64, batch_size> batch{};
+            while (next < count)
+            {
+                if (next % 3 == 0)
+                {
+                    usize filled = 0;
+                    for (; filled < batch.size() && next + filled < count; filled++)
+                    {
+                        batch[filled] = next + filled;
+                    }
+                    next += ring.push_batch(std::span<u64>(batch.data(), filled));
+                }
+                else if (ring.try_push(next))
+                {
+                    next++;
+                }
+            }
+        });
+
+        u64 expected = 0;
+        bool ordered = true;
+        std::array<u64, batch_size> batch{};
+        while (expected < count)
+        {
+            const usize popped = ring.pop_batch(batch);
+            for (usize i = 0; i < popped; i++)
+            {
+                ordered = ordered && batch[i] == expected;
+                expected++;
+            }
+
+            u64 item = 0;
+            if (expected < count && ring.try_pop(item))
+            {
+                ordered = ordered && item == expected;
+                expected++;
+            }
+        }
+
+        producer.join();
+        check(ordered, "spsc_ring delivers every item once, in order");
+        check(ring.is_empty(), "spsc_ring is empty after draining");
+    }
+
+    void mpmc_ring_delivers_each_item_once() noexcept
+    {
+        constexpr u64 total = producer_count * items_per_producer;
+        core::mpmc_ring<u64> ring(1024);
+
+        std::vector<std::atomic<u32>> seen(total);
+        std::atomic<u64> consumed{0};
+        std::atomic<bool> ordered{true};
+
+        std::vector<std::thread> threads{};
+        for (u32 p = 0; p < producer_count; p++)
+        {
+            threads.emplace_back([&ring, p]() {
+                u64 next = 0;
+                std::array<u64, batch_size> batch{};
+                while (next < items_per_producer)
+                {
+                    // Odd producers claim runs of cells at once
+                    if (p % 2 == 1)
+                    {
+                        usize filled = 0;
+                        for (; filled < batch.size() && next + filled < items_per_producer; filled++)
+                        {
+                            batch[filled] = encode(p, next + filled);
+                        }
+                        next += ring.push_batch(std::span<u64>(batch.data(), filled));
+                    }
+                    else if (ring.try_push(encode(p, next)))
+                    {
+                        next++;
+                    }
+                }
+            });
+        }
+
+        for (u32 c = 0; c < consumer_count; c++)
+        {
+            threads.emplace_back([&ring, &seen, &consumed, &ordered, c]() {
+                // Cells are claimed in ring order, so each consumer sees every producer's items in order
+                std::array<u64, producer_count> last{};
+                std::array<bool, producer_count> any{};
+                auto take = [&](u64 item) {
+                    const u32 producer = producer_of(item);
+                    const u64 sequence = sequence_of(item);
+                    if (any[producer] && sequence <= last[producer])
+                    {
+                        ordered.store(false, std::memory_order_relaxed);
+                    }
+                    any[producer] = true;
+                    last[producer] = sequence;
+                    seen[producer * items_per_producer + sequence].fetch_add(1, std::memory_order_relaxed);
+                };
+
+                std::array<u64, batch_size> batch{};
+                while (consumed.load(std::memory_order_relaxed) < total)
+                {
+                    usize taken = 0;
+                    if (c % 3 == 0)
+                    {
+                        taken = ring.pop_batch(batch);
+                        for (usize i = 0; i < taken; i++)
+                        {
+                            take(batch[i]);
+                        }
+                    }
+                    else if (c % 3 == 1)
+                    {
+                        taken = ring.consume(batch_size, take);
+                    }
+                    else
+                    {
+                        u64 item = 0;
+                        if (ring.try_pop(item))
+                        {
+                            take(item);
+                            taken = 1;
+                        }
+                    }
+
+                    consumed.fetch_add(taken, std::memory_order_relaxed);
+                }
+            });
+        }
+
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+
+        bool once = true;
+        for (const auto& count : seen)
+        {
+            once = once && count.load(std::memory_order_relaxed) == 1;
+        }
+
+        check(once, "mpmc_ring delivers every item exactly once");
+        check(ordered.load(), "mpmc_ring keeps each producer's order for each consumer");
+        check(ring.is_empty(), "mpmc_ring is empty after draining");
+    }
+
+    struct queued_item : core::mpsc_node
+    {
+        u32 producer { 0 };
+        u64 sequence { 0 };
+    };
+
+    void mpsc_queue_delivers_each_item_once() noexcept
+    {
+        core::mpsc_queue<queued_item> queue{};
+
+        // Nodes hold atomics and cannot move, so each producer's items live in one fixed array
+        std::vector<std::unique_ptr<queued_item[]>> items(producer_count);
+        for (u32 p = 0; p < producer_count; p++)
+        {
+            items[p] = std::make_unique<queued_item[]>(items_per_producer);
+            for (u64 i = 0; i < items_per_producer; i++)
+            {
+                items[p][i].producer = p;
+                items[p][i].sequence = i;
+            }
+        }
+
+        std::vector<std::thread> producers{};
+        for (u32 p = 0; p < producer_count; p++)
+        {
+            producers.emplace_back([&queue, &items, p]() {
+                auto& own = items[p];
+                std::array<queued_item*, batch_size> batch{};
+                u64 next = 0;
+                while (next < items_per_producer)
+                {
+                    // Odd producers link whole batches in with one exchange
+                    if (p % 2 == 1)
+                    {
+                        usize filled = 0;
+                        for (; filled < batch.size() && next + filled < items_per_producer; filled++)
+                        {
+                            batch[filled] = &own[next + filled];
+                        }
+                        queue.push_batch(std::span<queued_item* const>(batch.data(), filled));
+                        next += filled;
+                    }
+                    else
+                    {
+                        queue.push(&own[next++]);
+                    }
+                }
+            });
+        }
+
+        constexpr u64 total = producer_count * items_per_producer;
+        std::array<u64, producer_count> expected{};
+        bool ordered = true;
+        u64 received = 0;
+        std::array<queued_item*, batch_size> batch{};
+        while (received < total)
+        {
+            const usize popped = queue.pop_batch(batch);
+            for (usize i = 0; i < popped; i++)
+            {
+                ordered = ordered && batch[i]->sequence == expected[batch[i]->producer];
+                expected[batch[i]->producer]++;
+            }
+            received += popped;
+        }
+
+        for (auto& producer : producers)
+        {
+            producer.join();
+        }
+
+        check(ordered, "mpsc_queue delivers every item once, in each producer's order");
+        check(queue.pop() == nullptr, "mpsc_queue is empty after draining");
+    }
+} // anonymous namespace
+
+int main()
+{
+    spsc_ring_keeps_order();
+    mpmc_ring_delivers_each_item_once();
+    mpsc_queue_delivers_each_item_once();
+
+    if (failures != 0)
+    {
+        std::fprintf(stderr, "%u check(s) failed\n", failures);
+        return 1;
+    }
+
+    std::printf("containers_stress passed\n");
+    return 0;
+}
@@ -0,0 +1,179 @@
+// Checks that a steady-state frame costs no heap allocations. Every global `new` is counted, and so is
+// every allocation charged to a `core::allocator` tag, across a frame shaped like the renderer's: per-thread
+// temporaries on the frame arena, recorded from fiber tasks that may hop threads.
+
+#include "core/allocator.h"
+#include "core/fibers.h"
+#include "core/frame_arena.h"
+#include "core/jobs.h"
+#include "core/types.h"
+
+#include <array>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <thread>
+
+using namespace blade;
+
+namespace
+{
+    std::atomic<u64> global_allocations { 0 };
+
+    void* counted_allocate(std::size_t size, std::size_t alignment) noexcept
+    {
+        global_allocations.fetch_add(1, std::memory_order_relaxed);
+
+        // `aligned_alloc` wants the size to be a multiple of the alignment
+        const std::size_t rounded = (std::max<std::size_t>(size, 1) + alignment - 1) & ~(alignment - 1);
+        return std::aligned_alloc(alignment, rounded);
+    }
+} // anonymous namespace
+
+void* operator new(std::size_t size) { return counted_allocate(size, alignof(std::max_align_t)); }
+void* operator new[](std::size_t size) { return counted_allocate(size, alignof(std::max_align_t)); }
+void* operator new(std::size_t size, std::align_val_t alignment) { return counted_allocate(size, static_cast<std::size_t>(alignment)); }
+void* operator new[](std::size_t size, std::align_val_t alignment) { return counted_allocate(size, static_cast<std::size_t>(alignment)); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept { return counted_allocate(size, alignof(std::max_align_t)); }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept { return counted_allocate(size, alignof(std::max_align_t)); }
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept { return counted_allocate(size, static_cast<std::size_t>(alignment)); }
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept { return counted_allocate(size, static_cast<std::size_t>(alignment)); }
+
+void operator delete(void* memory) noexcept { std::free(memory); }
+void operator delete[](void* memory) noexcept { std::free(memory); }
+void operator delete(void* memory, std::size_t) noexcept { std::free(memory); }
+void operator delete[](void* memory, std::size_t) noexcept { std::free(memory); }
+void operator delete(void* memory, std::align_val_t) noexcept { std::free(memory); }
+void operator delete[](void* memory, std::align_val_t) noexcept { std::free(memory); }
+void operator delete(void* memory, std::size_t, std::align_val_t) noexcept { std::free(memory); }
+void operator delete[](void* memory, std::size_t, std::align_val_t) noexcept { std::free(memory); }
+void operator delete(void* memory, std::align_val_t, const std::nothrow_t&) noexcept { std::free(memory); }
+void operator delete[](void* memory, std::align_val_t, const std::nothrow_t&) noexcept { std::free(memory); }
+
+namespace
+{
+    constexpr u32 warm_up_frames = 16;
+    constexpr u32 measured_frames = 256;
+    constexpr u32 tasks_per_frame = 8;
+
+    [[nodiscard]] u64 tagged_allocations() noexcept
+    {
+        u64 total = 0;
+        for (usize tag = 0; tag < static_cast<usize>(core::memory_tag::count); tag++)
+        {
+            total += core::query_memory(static_cast<core::memory_tag>(tag)).total;
+        }
+
+        return total;
+    }
+
+    /**
+     * @brief Temporaries a view builds while recording, sized differently every frame
+     *
+     * Any thread may end up running every task of a frame, so the arenas only settle if that worst case fits
+     * what warm-up gave them. Draws reserve their upper bound the way a view does, and all tasks together stay
+     * inside one default block.
+     */
+    u64 record_temporaries(u32 frame, u32 task) noexcept
+    {
+        constexpr u32 max_draws = 192;
+
+        auto clear_values = core::make_frame_vector<u64>(1);
+        for (u32 i = 0; i < 2 + (frame + task) % 3; i++)
+        {
+            clear_values.push_back(i);
+        }
+
+        auto draws = core::make_frame_vector<std::array<u32, 8>>(max_draws);
+        for (u32 i = 0; i < 64 + (frame * 7 + task) % (max_draws - 64); i++)
+        {
+            draws.push_back({ i, frame, task });
+        }
+
+        return clear_values.size() + draws.size();
+    }
+
+    /**
+     * @brief Give every worker's arena its first block
+     *
+     * A thread takes its block on its first allocation, which may come late if the scheduler happens to leave a
+     * worker idle through warm-up. Each job holds its worker until all of them have started, so no worker runs
+     * two and none is skipped.
+     */
+    void touch_worker_arenas(core::jobs& jobs) noexcept
+    {
+        const u32 workers = jobs.thread_count() - 1;
+        std::atomic<u32> arrived { 0 };
+
+        core::job_counter counter{};
+        for (u32 i = 0; i < workers; i++)
+        {
+            jobs.spawn(counter, [&arrived, workers]() {
+                (void)record_temporaries(0, 0);
+                arrived.fetch_add(1, std::memory_order_acq_rel);
+                while (arrived.load(std::memory_order_acquire) < workers)
+                {
+                    std::this_thread::yield();
+                }
+            });
+        }
+
+        // Spinning rather than `wait`, which could run one of the jobs here and leave a worker without one
+        while (arrived.load(std::memory_order_acquire) < workers)
+        {
+            std::this_thread::yield();
+        }
+        jobs.wait(counter);
+    }
+
+    void run_frame(core::fibers& fibers, u32 frame) noexcept
+    {
+        core::frame_arena::begin_frame();
+
+        std::array<u64, tasks_per_frame> recorded{};
+        core::fiber_counter counter{};
+        for (u32 task = 1; task < tasks_per_frame; task++)
+        {
+            fibers.spawn(counter, [&recorded, frame, task]() {
+                recorded[task] = record_temporaries(frame, task);
+            });
+        }
+
+        recorded[0] = record_temporaries(frame, 0);
+        fibers.wait(counter);
+    }
+} // anonymous namespace
+
+int main()
+{
+    core::fibers& fibers = core::fibers::shared();
+
+    // Arenas settle on one block and the job and fiber pools fill their caches
+    for (u32 frame = 0; frame < warm_up_frames; frame++)
+    {
+        run_frame(fibers, frame);
+    }
+    touch_worker_arenas(core::jobs::shared());
+
+    const u64 global_before = global_allocations.load();
+    const u64 tagged_before = tagged_allocations();
+
+    for (u32 frame = 0; frame < measured_frames; frame++)
+    {
+        run_frame(fibers, warm_up_frames + frame);
+    }
+
+    const u64 global = global_allocations.load() - global_before;
+    const u64 tagged = tagged_allocations() - tagged_before;
+
+    if (global != 0 || tagged != 0)
+    {
+        std::fprintf(stderr, "FAILED: %llu heap and %llu tagged allocations over %u steady-state frames\n",
+                     static_cast<unsigned long long>(global), static_cast<unsigned long long>(tagged), measured_frames);
+        return 1;
+    }
+
+    std::printf("frame_allocations passed\n");
+    return 0;
+}